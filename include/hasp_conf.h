@@ -134,6 +134,18 @@
 #define HASP_USE_CONSOLE 1
 #endif
 
+#ifndef HASP_USE_VNC
+#define HASP_USE_VNC 0 // Mirror the screen to VNC viewers, POSIX only
+#endif
+
+#ifndef HASP_VNC_ADDRESS
+#define HASP_VNC_ADDRESS "127.0.0.1" // The RFB protocol has no encryption, expose it through an SSH tunnel
+#endif
+
+#ifndef HASP_VNC_PORT
+#define HASP_VNC_PORT 5900
+#endif
+
 /* Filesystem */
 #define HASP_HAS_FILESYSTEM (ARDUINO_ARCH_ESP32 > 0 || ARDUINO_ARCH_ESP8266 > 0)
 
@@ -201,6 +213,70 @@
 #endif
 #endif
 
+#ifndef HASP_USE_LAZY_PAGES
+#define HASP_USE_LAZY_PAGES 0 // Build the objects of a page on first use instead of at boot
+#endif
+
+#ifndef HASP_LAZY_PAGES_MIN_FREE
+#define HASP_LAZY_PAGES_MIN_FREE (8 * 1024U) // Evict unused pages when less lvgl memory is free
+#endif
+
+#ifndef HASP_LAZY_PAGES_SHADOW_SIZE
+#define HASP_LAZY_PAGES_SHADOW_SIZE 32 // Number of attribute updates kept for pages that are not built
+#endif
+
+#ifndef HASP_USE_DOUBLE_VDB
+#define HASP_USE_DOUBLE_VDB 0 // Render into a second lvgl draw buffer while the first one is being flushed
+#endif
+
+#ifndef HASP_USE_SCREENSHOT_SHADOW
+#if(defined(BOARD_HAS_PSRAM) && HASP_USE_HTTP > 0) || HASP_USE_VNC > 0
+#define HASP_USE_SCREENSHOT_SHADOW 1 // Serve screenshots from a copy of the screen instead of redrawing it
+#else
+#define HASP_USE_SCREENSHOT_SHADOW 0
+#endif
+#endif
+
+#ifndef HASP_SCREENSHOT_DIRTY_AREAS
+#define HASP_SCREENSHOT_DIRTY_AREAS 32 // Flushed areas remembered for screenshot deltas
+#endif
+
+#ifndef HASP_USE_MEM_POOL
+#define HASP_USE_MEM_POOL 0 // Serve lvgl allocations from size-class pools instead of the LV_MEM_SIZE heap
+#endif
+
+#ifndef HASP_MEM_POOL_CHUNK_SIZE
+#define HASP_MEM_POOL_CHUNK_SIZE 2048 // Bytes reserved at once when a size class runs out of blocks
+#endif
+
+#ifndef HASP_USE_DISPATCH_QUEUE
+#define HASP_USE_DISPATCH_QUEUE (HASP_TARGET_PC) // Network and console threads queue commands for the GUI thread
+#endif
+
+#ifndef HASP_DISPATCH_QUEUE_SIZE
+#define HASP_DISPATCH_QUEUE_SIZE 32 // Number of queued commands, must be a power of 2
+#endif
+
+#ifndef HASP_FONT_PAGED_SIZE
+#define HASP_FONT_PAGED_SIZE (128 * 1024U) // Font files larger than this read their glyphs on use, 0 to disable
+#endif
+
+#ifndef HASP_FONT_PAGE_CACHE_SIZE
+#define HASP_FONT_PAGE_CACHE_SIZE (16 * 1024U) // Bytes of glyph bitmaps cached per paged font
+#endif
+
+#ifndef HASP_FONT_PRELOAD_MAX
+#define HASP_FONT_PRELOAD_MAX 8 // Fonts of the preload list read while the pages are built, 0 to disable
+#endif
+
+#ifndef HASP_FONT_PRELOAD
+#define HASP_FONT_PRELOAD "" // Default preload list, like "robotocondensed_24,mdi_32"
+#endif
+
+#ifndef HASP_FONT_MISSING_MAX
+#define HASP_FONT_MISSING_MAX 16 // Missing font files remembered until the next clearfont
+#endif
+
 #define HASP_OBJECT_NOTATION "p%ub%u"
 
 #ifndef HASP_ATTRIBUTE_FAST_MEM
@@ -379,6 +455,10 @@ static WiFiSpiClass WiFi;
 #include "sys/svc/hasp_slave.h"
 #endif
 
+#if HASP_USE_VNC > 0
+#include "sys/svc/hasp_vnc.h"
+#endif
+
 #if defined(WINDOWS)
 #include <Windows.h>
 #define delay Sleep
@@ -406,6 +486,7 @@ static WiFiSpiClass WiFi;
 #define strcasecmp_P strcasecmp
 #define strcmp_P strcmp
 #define strcpy_P strcpy
+#define strncpy_P strncpy
 #define strstr_P strstr
 #define halRestartMcu()
 #if USE_MONITOR
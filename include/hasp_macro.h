@@ -20,7 +20,17 @@
 #define HASP_RANDOM(x) random() % x
 #endif
 
+/* A log call is skipped, arguments included, unless the level is enabled for its tag at compile time and at runtime
+ * debug_tag_compile_level() and debugTagMask[] are declared in hasp_debug.h together with the TAG_* ids */
+#define HASP_LOG_ENABLED(tag, level)                                                                                   \
+    ((level) <= debug_tag_compile_level(tag) && !(debugTagMask[tag] & (1u << (level))))
+#define HASP_LOG_IF(tag, level, call) (HASP_LOG_ENABLED(tag, level) ? call : (void)0)
+
 #if HASP_TARGET_PC
+#ifndef HASP_LOG_LEVEL
+#define HASP_LOG_LEVEL LOG_LEVEL_DEBUG
+#endif
+
 #define LOG_OUTPUT(x, ...) printf(__VA_ARGS__)
 #else
 
@@ -31,63 +41,26 @@
 #define LOG_OUTPUT(...) Log.output(...)
 
 #if HASP_LOG_LEVEL >= LOG_LEVEL_FATAL
-#define LOG_FATAL(...)                                                                                                 \
-    Log.fatal(__VA_ARGS__);                                                                                            \
-    while(true) {                                                                                                      \
-    }
+#define LOG_FATAL(x, ...)                                                                                              \
+    do {                                                                                                               \
+        HASP_LOG_IF(x, LOG_LEVEL_FATAL, Log.fatal(x, __VA_ARGS__));                                                    \
+        while(true) {                                                                                                  \
+        }                                                                                                              \
+    } while(0)
 #else
 #define LOG_FATAL(...)                                                                                                 \
     do {                                                                                                               \
     } while(0)
 #endif
 
-#if HASP_LOG_LEVEL >= LOG_LEVEL_ALERT
-#define LOG_ALERT(...) Log.alert(__VA_ARGS__)
-#else
-#define LOG_ALERT(...)
-#endif
-
-#if HASP_LOG_LEVEL >= LOG_LEVEL_CRITICAL
-#define LOG_CRITICAL(...) Log.critical(__VA_ARGS__)
-#else
-#define LOG_CRITICAL(...)
-#endif
-
-#if HASP_LOG_LEVEL >= LOG_LEVEL_ERROR
-#define LOG_ERROR(...) Log.error(__VA_ARGS__)
-#else
-#define LOG_ERROR(...)
-#endif
-
-#if HASP_LOG_LEVEL >= LOG_LEVEL_WARNING
-#define LOG_WARNING(...) Log.warning(__VA_ARGS__)
-#else
-#define LOG_WARNING(...)
-#endif
-
-#if HASP_LOG_LEVEL >= LOG_LEVEL_INFO
-#define LOG_INFO(...) Log.notice(__VA_ARGS__)
-#else
-#define LOG_INFO(...)
-#endif
-
-#if HASP_LOG_LEVEL >= LOG_LEVEL_TRACE
-#define LOG_TRACE(...) Log.trace(__VA_ARGS__)
-#else
-#define LOG_TRACE(...)
-#endif
-
-#if HASP_LOG_LEVEL >= LOG_LEVEL_VERBOSE
-#define LOG_VERBOSE(...) Log.verbose(__VA_ARGS__)
-#else
-#define LOG_VERBOSE(...)
-#endif
-
-#if HASP_LOG_LEVEL >= LOG_LEVEL_DEBUG
-#define LOG_DEBUG(...) Log.debug(__VA_ARGS__)
-#else
-#define LOG_DEBUG(...)
-#endif
+#define LOG_ALERT(x, ...) HASP_LOG_IF(x, LOG_LEVEL_ALERT, Log.alert(x, __VA_ARGS__))
+#define LOG_CRITICAL(x, ...) HASP_LOG_IF(x, LOG_LEVEL_CRITICAL, Log.critical(x, __VA_ARGS__))
+#define LOG_ERROR(x, ...) HASP_LOG_IF(x, LOG_LEVEL_ERROR, Log.error(x, __VA_ARGS__))
+#define LOG_WARNING(x, ...) HASP_LOG_IF(x, LOG_LEVEL_WARNING, Log.warning(x, __VA_ARGS__))
+#define LOG_INFO(x, ...) HASP_LOG_IF(x, LOG_LEVEL_INFO, Log.notice(x, __VA_ARGS__))
+#define LOG_TRACE(x, ...) HASP_LOG_IF(x, LOG_LEVEL_TRACE, Log.trace(x, __VA_ARGS__))
+#define LOG_VERBOSE(x, ...) HASP_LOG_IF(x, LOG_LEVEL_VERBOSE, Log.verbose(x, __VA_ARGS__))
+#define LOG_DEBUG(x, ...) HASP_LOG_IF(x, LOG_LEVEL_DEBUG, Log.debug(x, __VA_ARGS__))
 
 #endif
 
@@ -5,6 +5,7 @@
 #define HASP_MEM_H
 
 #include <stdlib.h>
+#include <stdint.h>
 #include <stdbool.h>
 
 #ifdef __cplusplus
@@ -24,6 +25,31 @@ void* hasp_malloc(size_t size);
 void* hasp_realloc(void* ptr, size_t new_size);
 void hasp_free(void* ptr);
 
+/* Per-page arenas for object metadata, freed all at once when the page is cleared.
+ * Only the extended user data (tag, action, swipe and font references) lives in them. Button maps are still
+ * allocated with lv_mem_alloc and freed by the delete handler, and the page names stay on the heap because the
+ * page objects they belong to survive clearpage. */
+#define HASP_ARENA_NONE 0xFF
+void* hasp_arena_alloc(uint8_t arena, size_t size);
+void hasp_arena_free(void* ptr);
+void hasp_arena_release(uint8_t arena);
+size_t hasp_arena_size(uint8_t arena);
+
+#if defined(HASP_USE_MEM_POOL) && HASP_USE_MEM_POOL > 0
+/* Size-class pools, used by lvgl as LV_MEM_CUSTOM allocator */
+typedef struct
+{
+    uint32_t block_size; // 0 for the allocations that are too large for a pool
+    uint32_t used;       // blocks in use
+    uint32_t total;      // blocks reserved from the system heap
+    uint8_t free_pct;    // share of the reserved blocks that is not in use
+} hasp_pool_stats_t;
+
+void* hasp_pool_alloc(size_t size);
+void hasp_pool_free(void* ptr);
+uint8_t hasp_pool_get_stats(hasp_pool_stats_t* stats, uint8_t count);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
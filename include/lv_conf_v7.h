@@ -80,8 +80,16 @@ typedef int16_t lv_coord_t;
 #define LV_FS_SEEK(x, y) lv_fs_seek(x, y)
 #define _lv_img_decoder_t _lv_img_decoder
 
+#ifndef HASP_USE_MEM_POOL
+#define HASP_USE_MEM_POOL 0
+#endif
+
   /* 1: use custom malloc/free, 0: use the built-in `lv_mem_alloc` and `lv_mem_free` */
+#if HASP_USE_MEM_POOL > 0
+#define LV_MEM_CUSTOM      1
+#else
 #define LV_MEM_CUSTOM      0
+#endif
 #if LV_MEM_CUSTOM == 0
 /* Size of the memory used by `lv_mem_alloc` in bytes (>= 2kB)*/
 
@@ -112,6 +120,10 @@ typedef int16_t lv_coord_t;
 
  /* Automatically defrag. on free. Defrag. means joining the adjacent free cells. */
 #  define LV_MEM_AUTO_DEFRAG  1
+#elif HASP_USE_MEM_POOL > 0
+#define LV_MEM_CUSTOM_INCLUDE "hasp_mem.h"   /*Size-class pools of hasp_mem.cpp*/
+#define LV_MEM_CUSTOM_ALLOC   hasp_pool_alloc
+#define LV_MEM_CUSTOM_FREE    hasp_pool_free
 #else       /*LV_MEM_CUSTOM*/
 #define LV_MEM_CUSTOM_INCLUDE <stdlib.h>   /*Header for the dynamic memory function*/
 #define LV_MEM_CUSTOM_ALLOC   malloc       /*Wrapper to malloc*/
@@ -149,14 +149,29 @@
 //#define HASP_USE_MDNS 0                             // Disable MDNS
 //#define HASP_USE_CUSTOM 1                           // Enable compilation of custom code from /src/custom
 //#define HASP_USE_HA                                 // Enable Home Assistant auto-discovery
+//#define HASP_USE_LAZY_PAGES 1                       // Build pages on first use and evict them when lvgl memory is low
 //#define HASP_START_CONSOLE 0                        // Disable starting of serial console at boot
 //#define HASP_START_TELNET 0                         // Disable starting of telnet service at boot
 //#define HASP_START_HTTP 0                           // Disable starting of web interface at boot
 //#define HASP_START_FTP 0                            // Disable starting of ftp server at boot
 //#define LV_MEM_SIZE (64 * 1024U)                    // 64KiB of lvgl memory (default 48)
 //#define LV_VDB_SIZE (32 * 1024U)                    // 32KiB of lvgl draw buffer (default 32)
+//#define HASP_USE_DOUBLE_VDB 1                       // Allocate a second lvgl draw buffer to render while flushing
+//#define HASP_USE_SCREENSHOT_SHADOW 1                // Keep a copy of the screen for screenshots and deltas
+//#define HASP_USE_VNC 1                              // Linux only: mirror the screen to VNC viewers
+//#define HASP_VNC_ADDRESS "0.0.0.0"                  // Listen on all interfaces instead of localhost only
+//#define HASP_USE_MEM_POOL 1                         // Replace the lvgl memory heap by size-class pools
+//#define HASP_DISPATCH_QUEUE_SIZE 32                 // Commands queued by the network threads (power of 2)
+//#define HASP_FONT_PAGED_SIZE (128 * 1024U)          // Larger font files are read per glyph, 0 loads them whole
+//#define HASP_FONT_PAGE_CACHE_SIZE (16 * 1024U)      // Glyph bitmap cache of each paged font
+//#define HASP_FONT_PRELOAD_MAX 8                     // Max fonts in the preload list, 0 disables the preload
+//#define HASP_FONT_PRELOAD "robotocondensed_24"      // Fonts to read in the background at boot, comma separated
+//#define HASP_FONT_MISSING_MAX 16                    // Missing font files remembered until the next clearfont
 //#define HASP_DEBUG_OBJ_TREE                         // Output all objects to the log on page changes
+//#define HASP_DEBUG_OBJ_INDEX                        // Cross-check every object index lookup against the object tree
 //#define HASP_LOG_LEVEL LOG_LEVEL_VERBOSE            // LOG_LEVEL_* can be DEBUG, VERBOSE, TRACE, INFO, WARNING, ERROR, CRITICAL, ALERT, FATAL, SILENT
 //#define HASP_LOG_TASKS                              // Also log the Taskname and watermark of ESP32 tasks
+//#define HASP_LOG_TAG_LEVELS HASP_LOG_TAG_LEVEL(TAG_MQTT, LOG_LEVEL_WARNING) // Lower the compile-time log level of some tags
+//#define HASP_LOG_DEFERRED 0                         // PC only: format log lines on the calling thread
 
 #endif // HASP_USER_CONFIG_OVERRIDE_H
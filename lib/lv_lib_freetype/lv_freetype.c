@@ -17,9 +17,15 @@
 #include FT_OUTLINE_H
 
 #include "lv_freetype.h"
+#if defined(ARDUINO_ARCH_ESP32)
 #include "freertos/FreeRTOS.h"
 #include "freertos/queue.h"
 #include "freertos/task.h"
+#else
+#include <pthread.h>
+#endif
+#include <stdlib.h>
+#include <string.h>
 
 #if CONFIG_FREERTOS_UNICORE
 #define ARDUINO_RUNNING_CORE 0
@@ -32,28 +38,67 @@
 /*
  * FreeType requires up to 32KB of stack to run, which overflows the stack of 8KB.
  *
- * We delegate to a FreeRTOS sub-task with a bigger stack.
+ * We delegate to a sub-task with a bigger stack: a FreeRTOS task on ESP32 and a pthread elsewhere.
  *
- * Parameters are passed via a RequestQueue, and response back via ResponseQueue
+ * The glyph descriptors and bitmaps are cached in front of that task, in the lvgl thread only, so it needs no locks.
+ * Only the glyphs missing from the cache are requested, in batches: the request is passed via a RequestQueue,
+ * and the task signals the ResponseQueue when all glyphs of the batch are rendered.
  *
- * The function that uses this scheme is `get_glyph_dsc_cb()``
+ * The functions that use this scheme are `get_glyph_dsc_cb()` and `lv_ft_font_prefetch()`
  *
  */
 
-QueueHandle_t FTRequestQueue;
-QueueHandle_t FTResponseQueue;
-TaskHandle_t FTTaskHandle;
-void FT_loop_task(void* pvParameters);
+#ifndef LV_FREETYPE_GLYPH_CACHE_SIZE
+#define LV_FREETYPE_GLYPH_CACHE_SIZE 128 // Cached glyph descriptors of all fonts, power of 2
+#endif
+
+#ifndef LV_FREETYPE_GLYPH_CACHE_BYTES
+#define LV_FREETYPE_GLYPH_CACHE_BYTES (16 * 1024) // Bytes of cached glyph bitmaps of all fonts
+#endif
+
+#define FT_BATCH_MAX 32      // glyphs rendered per request
+#define FT_CACHE_NONE 0xFFFF // end of a chain or list
+
+typedef struct FT_glyph_result
+{
+    lv_font_glyph_dsc_t dsc;
+    uint8_t* bitmap; // malloc'ed copy of the rendered glyph, NULL if empty
+    bool found;
+} FT_glyph_result;
 
-typedef struct FT_glyph_dsc_request
+typedef struct FT_glyph_request
 {
     const lv_font_t* font;
-    lv_font_glyph_dsc_t* dsc_out;
-    uint32_t unicode_letter;
-    uint32_t unicode_letter_next;
-} FT_glyph_dsc_request;
+    uint16_t count;
+    uint32_t letters[FT_BATCH_MAX];
+    FT_glyph_result results[FT_BATCH_MAX];
+} FT_glyph_request;
 
-typedef bool FT_glyph_dsc_response;
+typedef struct ft_cache_entry_t
+{
+    const lv_font_fmt_ft_dsc_t* dsc; // face, size and style of the glyph, NULL if the entry is free
+    uint32_t letter;
+    uint8_t* bitmap;
+    lv_font_glyph_dsc_t glyph;
+    uint16_t chain; // next entry in the same bucket
+    uint16_t prev;  // more recently used entry
+    uint16_t next;  // less recently used entry
+    bool found;     // false if the font has no such glyph
+} ft_cache_entry_t;
+
+#if defined(ARDUINO_ARCH_ESP32)
+QueueHandle_t FTRequestQueue;
+QueueHandle_t FTResponseQueue;
+TaskHandle_t FTTaskHandle;
+void FT_loop_task(void* pvParameters);
+#else
+static pthread_t FTThread;
+static bool FTThreadStarted;
+static pthread_mutex_t FTMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t FTCond   = PTHREAD_COND_INITIALIZER;
+static FT_glyph_request* FTRequest; // pending request, NULL when the worker is done
+static void* FT_loop_thread(void* arg);
+#endif
 
 /*********************
  *      DEFINES
@@ -90,6 +135,16 @@ static bool lv_ft_font_init_nocache(lv_ft_info_t* info);
 static void lv_ft_font_destroy_nocache(lv_font_t* font);
 #endif
 
+static bool ft_worker_start(void);
+static void ft_worker_call(FT_glyph_request* request);
+static void ft_render_batch(FT_glyph_request* request);
+static uint16_t ft_cache_find(const lv_font_fmt_ft_dsc_t* dsc, uint32_t letter);
+static void ft_cache_purge(const lv_font_fmt_ft_dsc_t* dsc);
+static void ft_fetch(FT_glyph_request* request);
+static bool get_glyph_dsc_cb(const lv_font_t* font, lv_font_glyph_dsc_t* dsc_out, uint32_t unicode_letter,
+                             uint32_t unicode_letter_next);
+static const uint8_t* get_glyph_bitmap_cb(const lv_font_t* font, uint32_t unicode_letter);
+
 static const char* name_refer_save(const char* name);
 static void name_refer_del(const char* name);
 static const char* name_refer_find(const char* name);
@@ -117,6 +172,12 @@ static FT_Glyph image_glyph;
 static lv_faces_control_t face_control;
 #endif
 
+static ft_cache_entry_t* ft_cache; // LV_FREETYPE_GLYPH_CACHE_SIZE entries
+static uint16_t* ft_cache_buckets; // first entry of each hash bucket
+static uint16_t ft_cache_lru_head; // most recently used entry
+static uint16_t ft_cache_lru_tail; // least recently used entry
+static lv_ft_cache_stats_t ft_stats;
+
 /**********************
  *      MACROS
  **********************/
@@ -165,14 +226,7 @@ bool lv_freetype_init(uint16_t max_faces, uint16_t max_sizes, uint32_t max_bytes
     }
 #endif
 
-    // initialize the queues to send request and receive response
-    FTRequestQueue  = xQueueCreate(1, sizeof(FT_glyph_dsc_request));
-    FTResponseQueue = xQueueCreate(1, sizeof(FT_glyph_dsc_response));
-
-    xTaskCreatePinnedToCore(FT_loop_task, "FreeType_task", LV_USE_FT_STACK_SIZE, NULL, 1, &FTTaskHandle,
-                            ARDUINO_RUNNING_CORE);
-
-    if(FTRequestQueue && FTResponseQueue) {
+    if(ft_worker_start()) {
         return true;
     }
 Fail:
@@ -184,7 +238,7 @@ Fail:
     LV_UNUSED(max_sizes);
     LV_UNUSED(max_bytes);
     _lv_ll_init(&face_control.face_ll, sizeof(FT_Face*));
-    return true;
+    return ft_worker_start();
 #endif /* LV_FREETYPE_CACHE_SIZE */
 }
 
@@ -216,7 +270,42 @@ void lv_ft_font_destroy(lv_font_t* font)
 
 size_t lv_ft_freetype_high_watermark()
 {
+#if defined(ARDUINO_ARCH_ESP32)
     return uxTaskGetStackHighWaterMark(FTTaskHandle);
+#else
+    return 0;
+#endif
+}
+
+void lv_ft_font_prefetch(const lv_font_t* font, const char* text)
+{
+    if(font == NULL || text == NULL || font->get_glyph_dsc != get_glyph_dsc_cb || ft_cache == NULL) return;
+
+    static FT_glyph_request request;
+    request.font  = font;
+    request.count = 0;
+
+    uint32_t i = 0;
+    while(text[i] != '\0') {
+        uint32_t letter = _lv_txt_encoded_next(text, &i);
+        if(letter < 0x20 || ft_cache_find(font->dsc, letter) != FT_CACHE_NONE) continue;
+
+        uint16_t j = 0;
+        while(j < request.count && request.letters[j] != letter) j++;
+        if(j < request.count) continue; // already in this batch
+
+        request.letters[request.count++] = letter;
+        if(request.count == FT_BATCH_MAX) {
+            ft_fetch(&request);
+            request.count = 0;
+        }
+    }
+    if(request.count > 0) ft_fetch(&request);
+}
+
+void lv_ft_get_cache_stats(lv_ft_cache_stats_t* stats)
+{
+    *stats = ft_stats;
 }
 
 /**********************
@@ -396,45 +485,6 @@ static const uint8_t* get_glyph_bitmap_cb_cache(const lv_font_t* font, uint32_t
 #endif
 }
 
-static bool get_glyph_dsc_cb(const lv_font_t* font, lv_font_glyph_dsc_t* dsc_out, uint32_t unicode_letter,
-                             uint32_t unicode_letter_next)
-{
-    static FT_glyph_dsc_request request;
-    static FT_glyph_dsc_response response;
-
-    request.font                = font;
-    request.dsc_out             = dsc_out;
-    request.unicode_letter      = unicode_letter;
-    request.unicode_letter_next = unicode_letter_next;
-    xQueueSendToBack(FTRequestQueue, &request, portMAX_DELAY);
-    if(xQueueReceive(FTResponseQueue, &response, portMAX_DELAY)) {
-        return response;
-    } else {
-        return false; // should never happen
-    }
-}
-
-void FT_loop_task(void* pvParameters)
-{
-    (void)pvParameters;
-
-    while(1) {
-        FT_glyph_dsc_request request;
-        FT_glyph_dsc_response response;
-
-        if(xQueueReceive(FTRequestQueue, &request, portMAX_DELAY)) {
-#if LV_USE_FT_CACHE_MANAGER
-            response = get_glyph_dsc_cb_cache(request.font, request.dsc_out, request.unicode_letter,
-                                              request.unicode_letter_next);
-#else
-            response = get_glyph_dsc_cb_nocache(request.font, request.dsc_out, request.unicode_letter,
-                                                request.unicode_letter_next);
-#endif
-            xQueueSendToBack(FTResponseQueue, &response, portMAX_DELAY); // send back response
-        }
-    }
-}
-
 static bool lv_ft_font_init_cache(lv_ft_info_t* info)
 {
     size_t need_size          = sizeof(lv_font_fmt_ft_dsc_t) + sizeof(lv_font_t);
@@ -466,7 +516,7 @@ static bool lv_ft_font_init_cache(lv_ft_info_t* info)
     font->dsc       = dsc;
     // font->get_glyph_dsc = get_glyph_dsc_cb_cache;
     font->get_glyph_dsc    = get_glyph_dsc_cb;
-    font->get_glyph_bitmap = get_glyph_bitmap_cb_cache;
+    font->get_glyph_bitmap = get_glyph_bitmap_cb;
     font->line_height      = ((32 + face_size->face->size->metrics.height) >> 6);
     font->base_line        = ((32 - face_size->face->size->metrics.descender) >> 6);
     font->subpx            = LV_FONT_SUBPX_NONE;
@@ -503,10 +553,11 @@ void lv_ft_font_destroy_cache(lv_font_t* font)
     if(dsc) {
         LV_LOG_WARN("RemoveFaceID : %s %u", dsc->name, dsc->height);
 
+        ft_cache_purge(dsc);
         FTC_Manager_RemoveFaceID(cache_manager, (FTC_FaceID)dsc);
         name_refer_del(dsc->name);
+        font->dsc = NULL; /* the font is allocated together with dsc */
         lv_mem_free(dsc);
-        font->dsc = NULL;
     }
 }
 #else /* LV_FREETYPE_CACHE_SIZE */
@@ -675,7 +726,7 @@ static bool lv_ft_font_init_nocache(lv_ft_info_t* info)
     font->dsc       = dsc;
     // font->get_glyph_dsc = get_glyph_dsc_cb_nocache;
     font->get_glyph_dsc    = get_glyph_dsc_cb;
-    font->get_glyph_bitmap = get_glyph_bitmap_cb_nocache;
+    font->get_glyph_bitmap = get_glyph_bitmap_cb;
     font->line_height      = (face->size->metrics.height >> 6);
     font->base_line        = -(face->size->metrics.descender >> 6);
     font->subpx            = LV_FONT_SUBPX_NONE;
@@ -701,6 +752,7 @@ static void lv_ft_font_destroy_nocache(lv_font_t* font)
 
     lv_font_fmt_ft_dsc_t* dsc = (lv_font_fmt_ft_dsc_t*)(font->dsc);
     if(dsc) {
+        ft_cache_purge(dsc);
         FT_Face face = dsc->size->face;
         FT_Done_Size(dsc->size);
         FT_Done_Face(face);
@@ -711,6 +763,316 @@ static void lv_ft_font_destroy_nocache(lv_font_t* font)
 
 #endif /* LV_FREETYPE_CACHE_SIZE */
 
+/*********************************************************************************************************************/
+/* Glyph cache in front of the FreeType task, only used by the lvgl thread */
+
+static inline uint16_t ft_cache_bucket(const lv_font_fmt_ft_dsc_t* dsc, uint32_t letter)
+{
+    uint32_t hash = ((uint32_t)(uintptr_t)dsc >> 3) * 2654435761u ^ letter * 40503u;
+    return (hash ^ (hash >> 16)) & (LV_FREETYPE_GLYPH_CACHE_SIZE - 1);
+}
+
+static void ft_cache_lru_unlink(uint16_t index)
+{
+    ft_cache_entry_t* entry = &ft_cache[index];
+    if(entry->prev != FT_CACHE_NONE)
+        ft_cache[entry->prev].next = entry->next;
+    else
+        ft_cache_lru_head = entry->next;
+    if(entry->next != FT_CACHE_NONE)
+        ft_cache[entry->next].prev = entry->prev;
+    else
+        ft_cache_lru_tail = entry->prev;
+}
+
+static void ft_cache_lru_push(uint16_t index, bool front)
+{
+    ft_cache_entry_t* entry = &ft_cache[index];
+    if(front) {
+        entry->prev = FT_CACHE_NONE;
+        entry->next = ft_cache_lru_head;
+        if(ft_cache_lru_head != FT_CACHE_NONE) ft_cache[ft_cache_lru_head].prev = index;
+        ft_cache_lru_head = index;
+        if(ft_cache_lru_tail == FT_CACHE_NONE) ft_cache_lru_tail = index;
+    } else {
+        entry->next = FT_CACHE_NONE;
+        entry->prev = ft_cache_lru_tail;
+        if(ft_cache_lru_tail != FT_CACHE_NONE) ft_cache[ft_cache_lru_tail].next = index;
+        ft_cache_lru_tail = index;
+        if(ft_cache_lru_head == FT_CACHE_NONE) ft_cache_lru_head = index;
+    }
+}
+
+/* Free the glyph of an entry and move the entry to the back of the lru list */
+static void ft_cache_drop(uint16_t index)
+{
+    ft_cache_entry_t* entry = &ft_cache[index];
+    if(entry->dsc == NULL) return;
+
+    uint16_t* link = &ft_cache_buckets[ft_cache_bucket(entry->dsc, entry->letter)];
+    while(*link != index) link = &ft_cache[*link].chain;
+    *link = entry->chain;
+
+    if(entry->bitmap) {
+        ft_stats.used -= (uint32_t)entry->glyph.box_w * entry->glyph.box_h;
+        free(entry->bitmap);
+    }
+    entry->bitmap = NULL;
+    entry->dsc    = NULL;
+    ft_stats.entries--;
+
+    ft_cache_lru_unlink(index);
+    ft_cache_lru_push(index, false);
+}
+
+static bool ft_cache_init(void)
+{
+    if(ft_cache) return true;
+
+    ft_cache         = calloc(LV_FREETYPE_GLYPH_CACHE_SIZE, sizeof(ft_cache_entry_t));
+    ft_cache_buckets = malloc(LV_FREETYPE_GLYPH_CACHE_SIZE * sizeof(uint16_t));
+    if(!ft_cache || !ft_cache_buckets) {
+        free(ft_cache);
+        free(ft_cache_buckets);
+        ft_cache         = NULL;
+        ft_cache_buckets = NULL;
+        return false;
+    }
+
+    ft_cache_lru_head = FT_CACHE_NONE;
+    ft_cache_lru_tail = FT_CACHE_NONE;
+    for(uint16_t i = 0; i < LV_FREETYPE_GLYPH_CACHE_SIZE; i++) {
+        ft_cache_buckets[i] = FT_CACHE_NONE;
+        ft_cache_lru_push(i, false);
+    }
+    ft_stats.size  = LV_FREETYPE_GLYPH_CACHE_BYTES;
+    ft_stats.slots = LV_FREETYPE_GLYPH_CACHE_SIZE;
+    return true;
+}
+
+/* Find a cached glyph and mark it as most recently used */
+static uint16_t ft_cache_find(const lv_font_fmt_ft_dsc_t* dsc, uint32_t letter)
+{
+    uint16_t index = ft_cache_buckets[ft_cache_bucket(dsc, letter)];
+    while(index != FT_CACHE_NONE && (ft_cache[index].dsc != dsc || ft_cache[index].letter != letter))
+        index = ft_cache[index].chain;
+
+    if(index != FT_CACHE_NONE && index != ft_cache_lru_head) {
+        ft_cache_lru_unlink(index);
+        ft_cache_lru_push(index, true);
+    }
+    return index;
+}
+
+/* Store a rendered glyph, the least recently used glyphs make room for it */
+static uint16_t ft_cache_store(const lv_font_fmt_ft_dsc_t* dsc, uint32_t letter, FT_glyph_result* result)
+{
+    uint32_t size = result->bitmap ? (uint32_t)result->dsc.box_w * result->dsc.box_h : 0;
+
+    uint16_t index = ft_cache_lru_tail;
+    ft_cache_drop(index);
+
+    uint16_t victim = ft_cache[index].prev;
+    while(ft_stats.used + size > LV_FREETYPE_GLYPH_CACHE_BYTES && victim != FT_CACHE_NONE) {
+        uint16_t prev = ft_cache[victim].prev;
+        ft_cache_drop(victim); // moves behind the entry that is filled
+        victim = prev;
+    }
+
+    ft_cache_entry_t* entry = &ft_cache[index];
+    entry->dsc              = dsc;
+    entry->letter           = letter;
+    entry->glyph            = result->dsc;
+    entry->bitmap           = result->bitmap;
+    entry->found            = result->found;
+    result->bitmap          = NULL; // owned by the cache now
+
+    uint16_t* bucket = &ft_cache_buckets[ft_cache_bucket(dsc, letter)];
+    entry->chain     = *bucket;
+    *bucket          = index;
+
+    ft_stats.used += size;
+    ft_stats.entries++;
+    ft_cache_lru_unlink(index);
+    ft_cache_lru_push(index, true);
+    return index;
+}
+
+/* Forget the glyphs of a font that is destroyed */
+static void ft_cache_purge(const lv_font_fmt_ft_dsc_t* dsc)
+{
+    if(ft_cache == NULL) return;
+    for(uint16_t i = 0; i < LV_FREETYPE_GLYPH_CACHE_SIZE; i++) {
+        if(ft_cache[i].dsc == dsc) ft_cache_drop(i);
+    }
+}
+
+/* Render the glyphs of the request on the FreeType task and cache them */
+static void ft_fetch(FT_glyph_request* request)
+{
+    ft_worker_call(request);
+    ft_stats.requests++;
+    ft_stats.misses += request->count;
+
+    for(uint16_t i = 0; i < request->count; i++) {
+        ft_cache_store(request->font->dsc, request->letters[i], &request->results[i]);
+    }
+}
+
+static bool get_glyph_dsc_cb(const lv_font_t* font, lv_font_glyph_dsc_t* dsc_out, uint32_t unicode_letter,
+                             uint32_t unicode_letter_next)
+{
+    if(unicode_letter < 0x20) {
+        dsc_out->adv_w = 0;
+        dsc_out->box_h = 0;
+        dsc_out->box_w = 0;
+        dsc_out->ofs_x = 0;
+        dsc_out->ofs_y = 0;
+        dsc_out->bpp   = 0;
+        return true;
+    }
+
+    uint16_t index = ft_cache_find(font->dsc, unicode_letter);
+    if(index != FT_CACHE_NONE) {
+        ft_stats.hits++;
+    } else {
+        static FT_glyph_request request;
+        request.font       = font;
+        request.count      = 1;
+        request.letters[0] = unicode_letter;
+        ft_fetch(&request);
+        index = ft_cache_find(font->dsc, unicode_letter);
+    }
+
+    ft_cache_entry_t* entry = &ft_cache[index];
+    if(!entry->found) return false;
+    *dsc_out = entry->glyph;
+
+    lv_font_fmt_ft_dsc_t* dsc = (lv_font_fmt_ft_dsc_t*)(font->dsc);
+    if((dsc->style & FT_FONT_STYLE_ITALIC) && (unicode_letter_next == '\0')) {
+        dsc_out->adv_w = dsc_out->box_w + dsc_out->ofs_x;
+    }
+    return true;
+}
+
+static const uint8_t* get_glyph_bitmap_cb(const lv_font_t* font, uint32_t unicode_letter)
+{
+    uint16_t index = ft_cache_find(font->dsc, unicode_letter);
+    if(index == FT_CACHE_NONE) { // the descriptor is always requested first
+        lv_font_glyph_dsc_t dsc_out;
+        if(!get_glyph_dsc_cb(font, &dsc_out, unicode_letter, 0)) return NULL;
+        index = ft_cache_find(font->dsc, unicode_letter);
+    }
+    return ft_cache[index].bitmap;
+}
+
+/*********************************************************************************************************************/
+/* The FreeType task, only this task calls into FreeType after the fonts are created */
+
+/* Runs on the FreeType task */
+static void ft_render_batch(FT_glyph_request* request)
+{
+    for(uint16_t i = 0; i < request->count; i++) {
+        FT_glyph_result* result = &request->results[i];
+        result->bitmap          = NULL;
+
+        // render as if more letters follow, the front applies the italic adjustment of the last letter
+#if LV_FREETYPE_CACHE_SIZE >= 0
+        result->found = get_glyph_dsc_cb_cache(request->font, &result->dsc, request->letters[i], ' ');
+        const uint8_t* bitmap = result->found ? get_glyph_bitmap_cb_cache(request->font, request->letters[i]) : NULL;
+#else
+        result->found = get_glyph_dsc_cb_nocache(request->font, &result->dsc, request->letters[i], ' ');
+        const uint8_t* bitmap = result->found ? get_glyph_bitmap_cb_nocache(request->font, request->letters[i]) : NULL;
+#endif
+
+        size_t size = (size_t)result->dsc.box_w * result->dsc.box_h;
+        if(bitmap && size > 0) {
+            result->bitmap = malloc(size); // lv_mem is not thread safe
+            if(result->bitmap)
+                memcpy(result->bitmap, bitmap, size);
+            else
+                result->found = false;
+        }
+    }
+}
+
+#if defined(ARDUINO_ARCH_ESP32)
+void FT_loop_task(void* pvParameters)
+{
+    (void)pvParameters;
+
+    while(1) {
+        FT_glyph_request* request;
+        bool done = true;
+
+        if(xQueueReceive(FTRequestQueue, &request, portMAX_DELAY)) {
+            ft_render_batch(request);
+            xQueueSendToBack(FTResponseQueue, &done, portMAX_DELAY); // send back response
+        }
+    }
+}
+
+static bool ft_worker_start(void)
+{
+    if(!ft_cache_init()) return false;
+
+    // initialize the queues to send request and receive response
+    FTRequestQueue  = xQueueCreate(1, sizeof(FT_glyph_request*));
+    FTResponseQueue = xQueueCreate(1, sizeof(bool));
+    if(!FTRequestQueue || !FTResponseQueue) return false;
+
+    return xTaskCreatePinnedToCore(FT_loop_task, "FreeType_task", LV_USE_FT_STACK_SIZE, NULL, 1, &FTTaskHandle,
+                                   ARDUINO_RUNNING_CORE) == pdPASS;
+}
+
+static void ft_worker_call(FT_glyph_request* request)
+{
+    bool done;
+    xQueueSendToBack(FTRequestQueue, &request, portMAX_DELAY);
+    xQueueReceive(FTResponseQueue, &done, portMAX_DELAY);
+}
+#else
+static void* FT_loop_thread(void* arg)
+{
+    (void)arg;
+
+    pthread_mutex_lock(&FTMutex);
+    while(1) {
+        while(FTRequest == NULL) pthread_cond_wait(&FTCond, &FTMutex);
+        pthread_mutex_unlock(&FTMutex);
+
+        ft_render_batch(FTRequest);
+
+        pthread_mutex_lock(&FTMutex);
+        FTRequest = NULL;
+        pthread_cond_broadcast(&FTCond);
+    }
+    return NULL;
+}
+
+static bool ft_worker_start(void)
+{
+    if(!ft_cache_init()) return false;
+    if(FTThreadStarted) return true;
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, LV_USE_FT_STACK_SIZE * 4); // more headroom than the FreeRTOS task
+    FTThreadStarted = pthread_create(&FTThread, &attr, FT_loop_thread, NULL) == 0;
+    pthread_attr_destroy(&attr);
+    return FTThreadStarted;
+}
+
+static void ft_worker_call(FT_glyph_request* request)
+{
+    pthread_mutex_lock(&FTMutex);
+    FTRequest = request;
+    pthread_cond_broadcast(&FTCond);
+    while(FTRequest != NULL) pthread_cond_wait(&FTCond, &FTMutex);
+    pthread_mutex_unlock(&FTMutex);
+}
+#endif
+
 /**
  * find name string in names list.name string cnt += 1 if find.
  * @param name name string
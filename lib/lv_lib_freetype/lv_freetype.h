@@ -47,6 +47,17 @@ typedef struct
     uint16_t height;
 } lv_font_fmt_ft_dsc_t;
 
+typedef struct
+{
+    uint32_t hits;     /* glyphs found in the cache */
+    uint32_t misses;   /* glyphs rendered by the FreeType task */
+    uint32_t requests; /* round-trips to the FreeType task */
+    uint32_t used;     /* bytes of cached bitmaps */
+    uint32_t size;     /* bytes of bitmaps that can be cached */
+    uint16_t entries;  /* cached glyphs */
+    uint16_t slots;    /* glyphs that can be cached */
+} lv_ft_cache_stats_t;
+
 /**********************
  * GLOBAL PROTOTYPES
  **********************/
@@ -83,6 +94,20 @@ void lv_ft_font_destroy(lv_font_t* font);
 // Unsed Task memory
 size_t lv_ft_freetype_high_watermark();
 
+/**
+ * Render the glyphs of a text that are not cached yet in one request to the FreeType task.
+ * Fonts that are not FreeType fonts are ignored.
+ * @param font pointer to font.
+ * @param text UTF-8 text that will be drawn with the font.
+ */
+void lv_ft_font_prefetch(const lv_font_t* font, const char* text);
+
+/**
+ * Get the statistics of the glyph cache.
+ * @param stats the statistics are copied here
+ */
+void lv_ft_get_cache_stats(lv_ft_cache_stats_t* stats);
+
 /**********************
  *      MACROS
  **********************/
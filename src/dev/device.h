@@ -158,6 +158,7 @@ class BaseDevice {
 #elif defined(POSIX)
 // #warning Building for Posix Devices
 #include "posix/hasp_posix.h"
+#include "posix/hasp_posix_events.h"
 
 #else
 #warning Building for Generic Devices
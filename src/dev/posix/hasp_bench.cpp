@@ -0,0 +1,263 @@
+/* MIT License - Copyright (c) 2019-2024 Francis Van Roie
+   For full license information read the LICENSE file in the project folder */
+
+/* ===========================================================================
+
+  Deterministic frame benchmark on the headless display driver
+
+  lvgl time only advances in steps of BENCH_TICK_PERIOD, so every run renders the
+  same frames. Only the wall clock time spent on the work is measured.
+
+  Trace file, one step per line:
+    # comment
+    wait <ms>               advance the virtual time, lvgl refreshes and reads input
+    touch <x> <y>           press or drag the pointer at x,y
+    release                 release the pointer
+    repeat <n> <command>    run a command n times without advancing the time
+    <command>               any command, like p1b2.text=Hello or page 2
+
+  lvgl_heap_peak is the highest lvgl heap use seen after each step, memory that is
+  allocated and freed again within one step is not counted. It is left out when
+  LV_MEM_CUSTOM is set, because lvgl then has no heap of its own to monitor.
+
+=========================================================================== */
+
+#if USE_HEADLESS && HASP_TARGET_PC
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include "hasplib.h"
+
+#include "hasp_debug.h"
+#include "hasp_gui.h"
+#include "hasp_bench.h"
+#include "drv/tft/tft_driver.h"
+#include "dev/device.h"
+
+#define BENCH_TICK_PERIOD 5    // ms of virtual time per lvgl loop
+#define BENCH_SETTLE_TIME 1000 // ms to render the pages after loading them
+
+typedef std::chrono::steady_clock bench_clock;
+
+struct bench_stats_t
+{
+    std::vector<uint32_t> frame_us; // wall time of each loop that flushed pixels
+    uint64_t virtual_ms;
+    uint64_t idle_us; // wall time of loops without a refresh
+    uint32_t commands;
+    uint32_t attributes;
+    uint64_t attribute_us;
+    uint64_t command_us;
+    size_t heap_peak;
+};
+static bench_stats_t bench;
+
+static inline uint64_t bench_elapsed_us(bench_clock::time_point start)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(bench_clock::now() - start).count();
+}
+
+static void bench_sample_heap()
+{
+#if LV_MEM_CUSTOM == 0
+    lv_mem_monitor_t mem_mon;
+    lv_mem_monitor(&mem_mon);
+    size_t used = mem_mon.total_size - mem_mon.free_size;
+    if(used > bench.heap_peak) bench.heap_peak = used;
+#endif
+}
+
+/* Count an object and all its descendants */
+static uint32_t bench_count_objects(lv_obj_t* parent)
+{
+    uint32_t count  = 1;
+    lv_obj_t* child = NULL;
+    while((child = lv_obj_get_child(parent, child))) count += bench_count_objects(child);
+    return count;
+}
+
+static uint32_t bench_count_page_objects()
+{
+    uint32_t count = 0;
+    for(uint8_t pageid = 0; pageid <= HASP_NUM_PAGES; pageid++) {
+        lv_obj_t* page = haspPages.get_obj(pageid);
+        if(page) count += bench_count_objects(page) - 1; // without the page itself
+    }
+    return count;
+}
+
+/* Advance the virtual time and let lvgl do its work every tick */
+static void bench_wait(uint32_t ms)
+{
+    for(uint32_t t = 0; t < ms; t += BENCH_TICK_PERIOD) {
+        haspTft.tick(BENCH_TICK_PERIOD);
+        bench.virtual_ms += BENCH_TICK_PERIOD;
+
+        uint32_t flushes = haspTft.flushes;
+        auto start       = bench_clock::now();
+        guiLoop();
+        uint64_t us = bench_elapsed_us(start);
+
+        if(haspTft.flushes != flushes)
+            bench.frame_us.push_back(us);
+        else
+            bench.idle_us += us;
+        bench_sample_heap();
+    }
+}
+
+static void bench_command(const char* cmnd)
+{
+    /* pXbY.attribute=value */
+    bool attribute = cmnd[0] == 'p' && isdigit(cmnd[1]) && strchr(cmnd, '.') != NULL;
+
+    auto start = bench_clock::now();
+    dispatch_text_line(cmnd, TAG_MAIN);
+    uint64_t us = bench_elapsed_us(start);
+
+    bench.commands++;
+    bench.command_us += us;
+    if(attribute) {
+        bench.attributes++;
+        bench.attribute_us += us;
+    }
+    bench_sample_heap();
+}
+
+static bool bench_replay(const char* tracefile)
+{
+    std::ifstream trace(tracefile);
+    if(!trace) {
+        LOG_ERROR(TAG_MAIN, F(D_FILE_LOAD_FAILED), tracefile);
+        return false;
+    }
+
+    std::string line;
+    while(std::getline(trace, line)) {
+        line.erase(0, line.find_first_not_of(" \t"));
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+        if(line.empty() || line[0] == '#') continue;
+
+        std::istringstream step(line);
+        std::string action;
+        step >> action;
+
+        if(action == "wait") {
+            uint32_t ms = 0;
+            step >> ms;
+            bench_wait(ms);
+        } else if(action == "touch") {
+            int x = 0, y = 0;
+            step >> x >> y;
+            haspTft.set_touch(x, y, true);
+        } else if(action == "release") {
+            haspTft.set_touch(0, 0, false);
+        } else if(action == "repeat") {
+            uint32_t count = 0;
+            step >> count >> std::ws;
+            std::string cmnd;
+            std::getline(step, cmnd);
+            for(uint32_t i = 0; i < count; i++) bench_command(cmnd.c_str());
+        } else {
+            bench_command(line.c_str());
+        }
+    }
+    return true;
+}
+
+static inline double bench_per_sec(uint64_t count, uint64_t us)
+{
+    return us ? count * 1000000.0 / us : 0;
+}
+
+int benchRun(const char* pagesfile, const char* tracefile, const char* outfile)
+{
+    bench = bench_stats_t();
+
+    /* Load the pages */
+    std::ifstream file(pagesfile, std::ios::binary);
+    if(!file) {
+        LOG_ERROR(TAG_MAIN, F(D_FILE_LOAD_FAILED), pagesfile);
+        return 1;
+    }
+    std::string jsonl((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    bench_wait(BENCH_SETTLE_TIME); // let the boot screens finish
+    dispatch_text_line("clearpage all", TAG_MAIN);
+    bench_wait(BENCH_TICK_PERIOD);
+    uint32_t objects_before = bench_count_page_objects();
+    uint64_t flush_before   = haspTft.flush_bytes;
+    bench = bench_stats_t(); // only measure from here
+
+    uint8_t pageid = haspPages.get();
+    auto start     = bench_clock::now();
+    dispatch_parse_jsonl(&jsonl[0], jsonl.size(), pageid);
+    uint64_t load_us = bench_elapsed_us(start);
+    uint32_t objects = bench_count_page_objects() - objects_before;
+    bench_sample_heap();
+
+    bench_wait(BENCH_SETTLE_TIME);
+    if(tracefile && !bench_replay(tracefile)) return 1;
+
+    /* Frame time statistics */
+    std::vector<uint32_t> frames = bench.frame_us;
+    std::sort(frames.begin(), frames.end());
+    uint64_t frame_total = 0;
+    for(uint32_t us : frames) frame_total += us;
+
+    DynamicJsonDocument doc(1024);
+    doc["version"] = haspDevice.get_version();
+    doc["driver"]  = haspTft.get_tft_model();
+    doc["width"]   = haspTft.width();
+    doc["height"]  = haspTft.height();
+    doc["pages"]   = pagesfile;
+    doc["trace"]   = tracefile ? tracefile : "";
+
+    JsonObject load         = doc.createNestedObject("load");
+    load["objects"]         = objects;
+    load["time_us"]         = load_us;
+    load["objects_per_sec"] = bench_per_sec(objects, load_us);
+
+    JsonObject render     = doc.createNestedObject("frames");
+    render["count"]       = frames.size();
+    render["virtual_ms"]  = bench.virtual_ms;
+    render["total_us"]    = frame_total;
+    render["avg_us"]      = frames.empty() ? 0 : frame_total / frames.size();
+    render["min_us"]      = frames.empty() ? 0 : frames.front();
+    render["p50_us"]      = frames.empty() ? 0 : frames[frames.size() / 2];
+    render["p95_us"]      = frames.empty() ? 0 : frames[frames.size() * 95 / 100];
+    render["max_us"]      = frames.empty() ? 0 : frames.back();
+    render["idle_us"]     = bench.idle_us;
+    render["flush_bytes"] = haspTft.flush_bytes - flush_before;
+
+    JsonObject commands               = doc.createNestedObject("commands");
+    commands["count"]                 = bench.commands;
+    commands["time_us"]               = bench.command_us;
+    commands["attributes"]            = bench.attributes;
+    commands["attribute_ops_per_sec"] = bench_per_sec(bench.attributes, bench.attribute_us);
+
+#if LV_MEM_CUSTOM == 0
+    doc["lvgl_heap_peak"] = bench.heap_peak;
+#endif
+
+    if(outfile) {
+        std::ofstream out(outfile);
+        if(!out) {
+            LOG_ERROR(TAG_MAIN, F("Failed to write %s"), outfile);
+            return 1;
+        }
+        serializeJsonPretty(doc, out);
+        out << std::endl;
+    } else {
+        serializeJsonPretty(doc, std::cout);
+        std::cout << std::endl;
+    }
+    return 0;
+}
+
+#endif // USE_HEADLESS && HASP_TARGET_PC
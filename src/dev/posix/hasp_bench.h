@@ -0,0 +1,19 @@
+/* MIT License - Copyright (c) 2019-2024 Francis Van Roie
+   For full license information read the LICENSE file in the project folder */
+
+#ifndef HASP_BENCH_H
+#define HASP_BENCH_H
+
+#if USE_HEADLESS && HASP_TARGET_PC
+
+/**
+ * Load a pages file, replay a trace on the headless display with a virtual tick and write the results as json
+ * @param pagesfile jsonl file with the objects to create
+ * @param tracefile script of commands, touches and waits, can be NULL
+ * @param outfile file to write the json results to, stdout if NULL
+ * @return 0 on success, a non-zero exit code otherwise
+ */
+int benchRun(const char* pagesfile, const char* tracefile, const char* outfile);
+
+#endif
+#endif
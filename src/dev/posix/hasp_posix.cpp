@@ -62,6 +62,9 @@ void PosixDevice::set_config(const JsonObject& settings)
     if(settings["fbdev"].is<std::string>()) {
         haspTft.fbdev_path = "/dev/" + settings["fbdev"].as<std::string>();
     }
+    if(settings["fbmode"].is<std::string>()) {
+        haspTft.fbdev_mode = settings["fbmode"].as<std::string>();
+    }
 #if USE_EVDEV
     if(settings["evdev"].is<std::string>()) {
         haspTft.evdev_names.push_back(settings["evdev"].as<std::string>());
@@ -0,0 +1,140 @@
+/* MIT License - Copyright (c) 2019-2024 Francis Van Roie
+   For full license information read the LICENSE file in the project folder */
+
+#if defined(POSIX)
+
+#include "hasp_posix_events.h"
+
+#include <cstdio>
+#include <unistd.h>
+#include <algorithm>
+
+#if defined(__linux__)
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif
+
+namespace dev {
+
+bool PosixEvents::begin()
+{
+#if defined(__linux__)
+    if(_epoll_fd != -1) return true;
+
+    _epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    _wake_fd  = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if(_epoll_fd == -1 || _wake_fd == -1) {
+        perror("Couldn't create event loop");
+        return false;
+    }
+
+    struct epoll_event ev = {};
+    ev.events             = EPOLLIN;
+    ev.data.ptr           = NULL; // the wakeup eventfd has no callback
+    epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, _wake_fd, &ev);
+    return true;
+#else
+    return false;
+#endif
+}
+
+/* Call cb on the waiting thread whenever fd is readable */
+bool PosixEvents::add(int fd, callback_t cb, void* arg)
+{
+#if defined(__linux__)
+    if(!begin()) return false;
+
+    watch_t* watch        = new watch_t{fd, cb, arg, false};
+    struct epoll_event ev = {};
+    ev.events             = EPOLLIN;
+    ev.data.ptr           = watch;
+    if(epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, fd, &ev) == -1) {
+        perror("Couldn't watch file descriptor");
+        delete watch;
+        return false;
+    }
+    _watches.push_back(watch);
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * Stop watching fd, i.e. when it reached end-of-file
+ * @note can be called from a callback, pending events of fd in the same batch are then skipped
+ */
+void PosixEvents::remove(int fd)
+{
+#if defined(__linux__)
+    auto it = std::find_if(_watches.begin(), _watches.end(), [fd](watch_t* watch) { return watch->fd == fd; });
+    if(it == _watches.end()) return;
+
+    epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+    if(_dispatching) {
+        (*it)->removed = true;
+        _removed.push_back(*it);
+    } else {
+        delete *it;
+    }
+    _watches.erase(it);
+#endif
+}
+
+/* Also call the callback of fd while it is writable, i.e. while there is output that didn't fit in the socket */
+void PosixEvents::watch_write(int fd, bool enable)
+{
+#if defined(__linux__)
+    auto it = std::find_if(_watches.begin(), _watches.end(), [fd](watch_t* watch) { return watch->fd == fd; });
+    if(it == _watches.end()) return;
+
+    struct epoll_event ev = {};
+    ev.events             = enable ? EPOLLIN | EPOLLOUT : EPOLLIN;
+    ev.data.ptr           = *it;
+    epoll_ctl(_epoll_fd, EPOLL_CTL_MOD, fd, &ev);
+#endif
+}
+
+/**
+ * Wait for events and run the callbacks of the ready file descriptors
+ * @param timeout maximum time to wait in ms
+ */
+void PosixEvents::wait(uint32_t timeout)
+{
+#if defined(__linux__)
+    if(!begin()) return;
+
+    struct epoll_event events[8];
+    int count = epoll_wait(_epoll_fd, events, 8, timeout > INT32_MAX ? -1 : (int)timeout);
+
+    _dispatching = true;
+    for(int i = 0; i < count; i++) {
+        watch_t* watch = (watch_t*)events[i].data.ptr;
+        if(watch) {
+            if(!watch->removed) watch->cb(watch->fd, watch->arg);
+        } else {
+            uint64_t wakeups;
+            if(read(_wake_fd, &wakeups, sizeof(wakeups)) < 0) continue; // reset the eventfd
+        }
+    }
+    _dispatching = false;
+
+    for(watch_t* watch : _removed) delete watch;
+    _removed.clear();
+#endif
+}
+
+/* Interrupt wait() from any thread */
+void PosixEvents::wake()
+{
+#if defined(__linux__)
+    uint64_t one = 1;
+    if(_wake_fd != -1 && write(_wake_fd, &one, sizeof(one)) < 0) return; // already signaled
+#endif
+}
+
+} // namespace dev
+
+dev::PosixEvents haspEvents;
+
+#endif // POSIX
@@ -0,0 +1,56 @@
+/* MIT License - Copyright (c) 2019-2024 Francis Van Roie
+   For full license information read the LICENSE file in the project folder */
+
+#ifndef HASP_POSIX_EVENTS_H
+#define HASP_POSIX_EVENTS_H
+
+#if defined(POSIX)
+
+#include <cstdint>
+#include <vector>
+
+#if defined(__linux__)
+#define HASP_USE_EVENT_LOOP 1 // the main loop blocks in haspEvents.wait() instead of polling
+#endif
+
+namespace dev {
+
+/**
+ * Blocks a thread until a file descriptor is readable, a timeout expires or another thread wakes it
+ * Uses epoll and an eventfd on Linux, on other systems wait() returns immediately.
+ */
+class PosixEvents {
+  public:
+    typedef void (*callback_t)(int fd, void* arg);
+
+    bool begin();
+    bool add(int fd, callback_t cb, void* arg);
+    void remove(int fd);
+    void watch_write(int fd, bool enable);
+    void wait(uint32_t timeout);
+    void wake();
+
+  private:
+    struct watch_t
+    {
+        int fd;
+        callback_t cb;
+        void* arg;
+        bool removed; // still referenced by the events that wait() is dispatching
+    };
+
+    int _epoll_fd     = -1;
+    int _wake_fd      = -1;
+    bool _dispatching = false;
+    std::vector<watch_t*> _watches;
+    std::vector<watch_t*> _removed; // freed when wait() has dispatched all events
+};
+
+} // namespace dev
+
+using dev::PosixEvents;
+extern dev::PosixEvents haspEvents;
+
+#endif // POSIX
+
+#endif // HASP_POSIX_EVENTS_H
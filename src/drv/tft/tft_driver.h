@@ -86,6 +86,9 @@ class BaseTft {
 #elif USE_FBDEV && HASP_TARGET_PC
 // #warning Building for POSIX fbdev
 #include "tft_driver_posix_fbdev.h"
+#elif USE_HEADLESS && HASP_TARGET_PC
+// #warning Building for Headless
+#include "tft_driver_headless.h"
 #else
 // #warning Building for Generic Tfts
 using dev::BaseTft;
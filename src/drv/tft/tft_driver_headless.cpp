@@ -0,0 +1,150 @@
+/* MIT License - Copyright (c) 2019-2024 Francis Van Roie
+   For full license information read the LICENSE file in the project folder */
+
+#if USE_HEADLESS && HASP_TARGET_PC
+
+#include "hasplib.h"
+#include "lvgl.h"
+
+#include "drv/tft/tft_driver.h"
+#include "tft_driver_headless.h"
+
+#include "dev/device.h"
+#include "hasp_debug.h"
+#include "hasp_gui.h"
+
+#include <pthread.h>
+#include <unistd.h>
+
+extern uint16_t tft_width;
+extern uint16_t tft_height;
+
+namespace dev {
+
+/**
+ * A task to measure the elapsed time for LittlevGL
+ * @param data unused
+ * @return never return
+ */
+static void* tick_thread(void* data)
+{
+    (void)data;
+
+    while(1) {
+        usleep(5000);   /*Sleep for 5 millisecond*/
+        lv_tick_inc(5); /*Tell LittelvGL that 5 milliseconds were elapsed*/
+    }
+
+    return 0;
+}
+
+int32_t TftHeadlessDrv::width()
+{
+    return _width;
+}
+int32_t TftHeadlessDrv::height()
+{
+    return _height;
+}
+
+void TftHeadlessDrv::init(int32_t w, int h)
+{
+    _width  = w;
+    _height = h;
+    _fb.assign((size_t)w * h, LV_COLOR_BLACK);
+
+    tft_width  = _width;
+    tft_height = _height;
+
+    /* A pointer device that replays the touches set by set_touch() */
+    static lv_indev_drv_t indev_drv;
+    lv_indev_drv_init(&indev_drv);
+    indev_drv.type      = LV_INDEV_TYPE_POINTER;
+    indev_drv.read_cb   = touch_read;
+    indev_drv.user_data = this;
+    lv_indev_drv_register(&indev_drv);
+
+    if(!virtual_tick) {
+#if HASP_USE_LVGL_TASK
+        // create an LVGL GUI task thread
+        pthread_t gui_pthread;
+        pthread_create(&gui_pthread, 0, (void* (*)(void*))gui_task, NULL);
+#endif
+        // create an LVGL tick thread
+        pthread_t tick_pthread;
+        pthread_create(&tick_pthread, 0, tick_thread, NULL);
+    }
+}
+void TftHeadlessDrv::show_info()
+{
+    LOG_VERBOSE(TAG_TFT, F("Driver     : %s"), get_tft_model());
+    LOG_VERBOSE(TAG_TFT, F("Tick       : %s"), virtual_tick ? "virtual" : "realtime");
+}
+
+void TftHeadlessDrv::set_rotation(uint8_t rotation)
+{
+    _rotation = rotation;
+}
+void TftHeadlessDrv::set_invert(bool invert)
+{}
+
+/* Advance the lvgl time, only needed with a virtual tick */
+void TftHeadlessDrv::tick(uint32_t ms)
+{
+    lv_tick_inc(ms);
+}
+
+void TftHeadlessDrv::set_touch(lv_coord_t x, lv_coord_t y, bool pressed)
+{
+    _touch_x       = x;
+    _touch_y       = y;
+    _touch_pressed = pressed;
+}
+
+/* The rendered screen, in rows of width() pixels */
+const lv_color_t* TftHeadlessDrv::get_framebuffer()
+{
+    return _fb.data();
+}
+
+bool TftHeadlessDrv::touch_read(lv_indev_drv_t* indev_driver, lv_indev_data_t* data)
+{
+    TftHeadlessDrv* tft = (TftHeadlessDrv*)indev_driver->user_data;
+    data->point.x       = tft->_touch_x;
+    data->point.y       = tft->_touch_y;
+    data->state         = tft->_touch_pressed ? LV_INDEV_STATE_PR : LV_INDEV_STATE_REL;
+    return false;
+}
+
+void TftHeadlessDrv::flush_pixels(lv_disp_drv_t* disp, const lv_area_t* area, lv_color_t* color_p)
+{
+    int32_t w  = lv_area_get_width(area);
+    int32_t x1 = LV_MATH_MAX(area->x1, 0);
+    int32_t x2 = LV_MATH_MIN(area->x2, _width - 1);
+    int32_t y1 = LV_MATH_MAX(area->y1, 0);
+    int32_t y2 = LV_MATH_MIN(area->y2, _height - 1);
+
+    if(x1 <= x2 && y1 <= y2) {
+        size_t len            = (x2 - x1 + 1) * sizeof(lv_color_t);
+        const lv_color_t* src = color_p + (y1 - area->y1) * w + (x1 - area->x1);
+        for(int32_t y = y1; y <= y2; y++, src += w) memcpy(&_fb[(size_t)y * _width + x1], src, len);
+        flush_bytes += len * (y2 - y1 + 1);
+    }
+
+    flushes++;
+    lv_disp_flush_ready(disp);
+}
+bool TftHeadlessDrv::is_driver_pin(uint8_t pin)
+{
+    return false;
+}
+const char* TftHeadlessDrv::get_tft_model()
+{
+    return "Headless";
+}
+
+} // namespace dev
+
+dev::TftHeadlessDrv haspTft;
+
+#endif // USE_HEADLESS && HASP_TARGET_PC
@@ -0,0 +1,63 @@
+/* MIT License - Copyright (c) 2019-2024 Francis Van Roie
+ For full license information read the LICENSE file in the project folder */
+
+#ifndef HASP_HEADLESS_DRIVER_H
+#define HASP_HEADLESS_DRIVER_H
+
+#include "tft_driver.h"
+
+#if USE_HEADLESS && HASP_TARGET_PC
+// #warning Building H driver Headless
+
+#include "lvgl.h"
+
+#include <vector>
+
+namespace dev {
+
+/* Renders into memory without a display or input devices, for benchmarks and remote viewing */
+class TftHeadlessDrv : BaseTft {
+  public:
+    void init(int w, int h);
+    void show_info();
+
+    void set_rotation(uint8_t rotation);
+    void set_invert(bool invert);
+
+    void flush_pixels(lv_disp_drv_t* disp, const lv_area_t* area, lv_color_t* color_p);
+    bool is_driver_pin(uint8_t pin);
+
+    const char* get_tft_model();
+
+    int32_t width();
+    int32_t height();
+
+    void tick(uint32_t ms);
+    void set_touch(lv_coord_t x, lv_coord_t y, bool pressed);
+    const lv_color_t* get_framebuffer();
+
+  public:
+    bool virtual_tick    = false; // lvgl time only advances by calls to tick()
+    uint32_t flushes     = 0;     // number of flushed areas
+    uint64_t flush_bytes = 0;     // number of pixel bytes flushed
+
+  private:
+    int32_t _width, _height;
+    uint8_t _rotation = 0;
+    std::vector<lv_color_t> _fb;
+
+    lv_coord_t _touch_x = 0;
+    lv_coord_t _touch_y = 0;
+    bool _touch_pressed = false;
+
+    static bool touch_read(lv_indev_drv_t* indev_driver, lv_indev_data_t* data);
+};
+
+} // namespace dev
+
+using dev::TftHeadlessDrv;
+extern dev::TftHeadlessDrv haspTft;
+
+#endif // HASP_TARGET_PC
+
+#endif // HASP_HEADLESS_DRIVER_H
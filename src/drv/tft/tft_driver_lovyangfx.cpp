@@ -1166,6 +1166,13 @@ void IRAM_ATTR LovyanGfx::flush_pixels(lv_disp_drv_t* disp, const lv_area_t* are
     uint32_t h   = (area->y2 - area->y1 + 1);
     uint32_t len = w * h;
 
+#ifdef USE_DMA_TO_TFT
+    dma_wait();                                                 /* The previous transfer must be done */
+    tft.startWrite();                                           /* Start new TFT transaction */
+    tft.setAddrWindow(area->x1, area->y1, w, h);                /* set the working window */
+    tft.writePixelsDMA((lgfx::rgb565_t*)&color_p->full, w * h); /* Start the transfer, flush_wait() ends it */
+    dma_pending = true;
+#else
     tft.startWrite();                                        /* Start new TFT transaction */
     tft.setAddrWindow(area->x1, area->y1, w, h);             /* set the working window */
     tft.writePixels((lgfx::rgb565_t*)&color_p->full, w * h); /* Write words at once */
@@ -1173,8 +1180,29 @@ void IRAM_ATTR LovyanGfx::flush_pixels(lv_disp_drv_t* disp, const lv_area_t* are
 
     /* Tell lvgl that flushing is done */
     lv_disp_flush_ready(disp);
+#endif
+}
+
+#ifdef USE_DMA_TO_TFT
+/* Wait for the pending DMA transfer to complete and release the bus */
+bool IRAM_ATTR LovyanGfx::dma_wait()
+{
+    if(!dma_pending) return false;
+
+    tft.waitDMA();
+    tft.endWrite(); /* terminate TFT transaction */
+    dma_pending = false;
+    return true;
 }
 
+/* Called by lvgl while it waits for the buffer that is being flushed */
+void IRAM_ATTR LovyanGfx::flush_wait(lv_disp_drv_t* disp)
+{
+    /* Tell lvgl that flushing is done */
+    if(dma_wait()) lv_disp_flush_ready(disp);
+}
+#endif
+
 bool LovyanGfx::is_driver_pin(uint8_t pin)
 {
     auto panel = tft.getPanel();
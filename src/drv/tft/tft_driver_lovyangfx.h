@@ -21,6 +21,10 @@
 #include "custom/bootlogo_template.h" // Sketch tab header for xbm images
 #endif
 
+#ifdef USE_DMA_TO_TFT
+#define HASP_TFT_ASYNC_FLUSH 1 // flush_pixels() starts a DMA transfer that flush_wait() completes
+#endif
+
 namespace dev {
 class LGFX : public lgfx::LGFX_Device {
   public:
@@ -41,6 +45,9 @@ class LovyanGfx : BaseTft {
     void set_invert(bool invert);
 
     void flush_pixels(lv_disp_drv_t* disp, const lv_area_t* area, lv_color_t* color_p);
+#ifdef USE_DMA_TO_TFT
+    void flush_wait(lv_disp_drv_t* disp);
+#endif
     bool is_driver_pin(uint8_t pin);
 
     const char* get_tft_model();
@@ -56,6 +63,11 @@ class LovyanGfx : BaseTft {
 
   private:
     uint32_t tft_driver;
+#ifdef USE_DMA_TO_TFT
+    bool dma_pending = false;
+
+    bool dma_wait();
+#endif
 
     uint32_t get_tft_driver();
     uint32_t get_touch_driver();
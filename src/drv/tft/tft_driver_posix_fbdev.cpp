@@ -31,6 +31,9 @@
 #include <algorithm>
 #include <fstream>
 #include <linux/vt.h>
+#include <linux/fb.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
 
 #if USE_BSD_EVDEV
 #include <dev/evdev/input.h>
@@ -60,6 +63,55 @@ static void* tick_thread(void* data)
     return 0;
 }
 
+enum fb_mode_t : uint8_t {
+    FB_MODE_LV_DRIVERS = 0, // lv_drivers copies the draw buffer into the framebuffer
+    FB_MODE_CONVERT,        // the draw buffer is converted into the framebuffer format on flush
+    FB_MODE_DIRECT,         // lvgl renders straight into the visible framebuffer
+    FB_MODE_FLIP,           // lvgl renders into the hidden page and the display is panned to it
+};
+
+/* Expand an rgb565 pixel to 8 bits per channel at the channel offsets of the framebuffer */
+static inline uint32_t fb_pixel_565(uint16_t c, uint8_t red, uint8_t green, uint8_t blue, uint32_t alpha)
+{
+    uint32_t r = (c >> 11) & 0x1f;
+    uint32_t g = (c >> 5) & 0x3f;
+    uint32_t b = c & 0x1f;
+    return (((r << 3) | (r >> 2)) << red) | (((g << 2) | (g >> 4)) << green) | (((b << 3) | (b >> 2)) << blue) |
+           alpha;
+}
+
+/* Move the channels of an rgb565 pixel to the channel offsets of a 16 bit framebuffer, like bgr565 */
+static inline uint16_t fb_pixel_reorder_565(uint16_t c, uint8_t red, uint8_t green, uint8_t blue)
+{
+    return (((c >> 11) & 0x1f) << red) | (((c >> 5) & 0x3f) << green) | ((c & 0x1f) << blue);
+}
+
+/* Convert a run of rgb565 pixels to 32 bit pixels, 8 pixels at a time using vector extensions */
+static void fb_convert_565(uint32_t* __restrict__ dst, const uint16_t* __restrict__ src, uint32_t len, uint8_t red,
+                           uint8_t green, uint8_t blue, uint32_t alpha)
+{
+    uint32_t i = 0;
+
+#if defined(__GNUC__) && (defined(__clang__) || __GNUC__ >= 9)
+    typedef uint16_t u16x8 __attribute__((vector_size(16)));
+    typedef uint32_t u32x8 __attribute__((vector_size(32)));
+
+    for(; i + 8 <= len; i += 8) {
+        u16x8 c;
+        memcpy(&c, src + i, sizeof(c)); // unaligned load
+        u32x8 p = __builtin_convertvector(c, u32x8);
+        u32x8 r = (p >> 11) & 0x1f;
+        u32x8 g = (p >> 5) & 0x3f;
+        u32x8 b = p & 0x1f;
+        p       = (((r << 3) | (r >> 2)) << red) | (((g << 2) | (g >> 4)) << green) | (((b << 3) | (b >> 2)) << blue) |
+            alpha;
+        memcpy(dst + i, &p, sizeof(p)); // unaligned store
+    }
+#endif
+
+    for(; i < len; i++) dst[i] = fb_pixel_565(src[i], red, green, blue, alpha);
+}
+
 int32_t TftFbdevDrv::width()
 {
     return _width;
@@ -115,6 +167,7 @@ void TftFbdevDrv::init(int32_t w, int h)
      * The following input devices are handled: mouse, keyboard, mousewheel */
     fbdev_init(fbdev_path.empty() ? NULL : fbdev_path.c_str());
     fbdev_get_sizes((uint32_t*)&_width, (uint32_t*)&_height);
+    if(!fbdev_mode.empty()) fb_map();
 
     // show the splashscreen early
     splashscreen();
@@ -205,6 +258,12 @@ void TftFbdevDrv::init(int32_t w, int h)
             LOG_VERBOSE(TAG_TFT, F("Resolution : X=%d (%d..%d), Y=%d (%d..%d)"), user_data->x_max,
                         user_data->x_absinfo.minimum, user_data->x_absinfo.maximum, user_data->y_max,
                         user_data->y_absinfo.minimum, user_data->y_absinfo.maximum);
+
+#if HASP_USE_LVGL_TASK && defined(HASP_USE_EVENT_LOOP)
+            // a second handle on the device wakes the lvgl task on input
+            int watch_fd = open(dev_path, O_RDONLY | O_NOCTTY | O_NONBLOCK);
+            if(watch_fd != -1) gui_watch_input(watch_fd);
+#endif
         }
         closedir(dir);
     }
@@ -228,11 +287,246 @@ void TftFbdevDrv::splashscreen()
     fbdev_splashscreen(logoImage, logoWidth, logoHeight, fgColor, bgColor);
 }
 void TftFbdevDrv::set_rotation(uint8_t rotation)
-{}
+{
+    _rotation = rotation;
+
+    /* lvgl renders unrotated into the framebuffer in direct and flip mode, a rotated display is converted on flush.
+     * This runs before the draw buffers are handed to lvgl. */
+    if(_rotation != 0 && (_fb_mode == FB_MODE_DIRECT || _fb_mode == FB_MODE_FLIP)) {
+        if(_fb_page != 0) fb_pan(0);
+        _fb_mode = FB_MODE_CONVERT;
+        LOG_VERBOSE(TAG_TFT, F("Framebuffer: convert, the display is rotated"));
+    }
+}
 void TftFbdevDrv::set_invert(bool invert)
 {}
+
+/**
+ * Map the framebuffer so lvgl can draw into it without the lv_drivers copy
+ * Direct and flip mode need a framebuffer in the lvgl color format, other formats are converted on flush.
+ * @return true if the framebuffer was mapped
+ */
+bool TftFbdevDrv::fb_map()
+{
+    const char* path = fbdev_path.empty() ? FBDEV_PATH : fbdev_path.c_str();
+    _fb_fd           = open(path, O_RDWR);
+    if(_fb_fd == -1) {
+        perror("Couldn't open framebuffer device");
+        return false;
+    }
+
+    struct fb_var_screeninfo vinfo;
+    struct fb_fix_screeninfo finfo;
+    if(ioctl(_fb_fd, FBIOGET_VSCREENINFO, &vinfo) == -1) {
+        perror("Couldn't read framebuffer info");
+        close(_fb_fd);
+        _fb_fd = -1;
+        return false;
+    }
+
+    /* Page flipping needs a virtual screen of twice the height */
+    bool flip = fbdev_mode == "flip";
+    if(flip && vinfo.yres_virtual < vinfo.yres * 2) {
+        vinfo.yres_virtual = vinfo.yres * 2;
+        vinfo.yoffset      = 0;
+        if(ioctl(_fb_fd, FBIOPUT_VSCREENINFO, &vinfo) == -1) perror("Couldn't resize virtual framebuffer");
+        ioctl(_fb_fd, FBIOGET_VSCREENINFO, &vinfo);
+        flip = vinfo.yres_virtual >= vinfo.yres * 2;
+    }
+
+    if(ioctl(_fb_fd, FBIOGET_FSCREENINFO, &finfo) == -1 ||
+       (vinfo.bits_per_pixel != 16 && vinfo.bits_per_pixel != 24 && vinfo.bits_per_pixel != 32)) {
+        LOG_WARNING(TAG_TFT, F("Framebuffer: %u bpp not supported"), vinfo.bits_per_pixel);
+        close(_fb_fd);
+        _fb_fd = -1;
+        return false;
+    }
+
+    _fb_bpp    = vinfo.bits_per_pixel;
+    _fb_stride = finfo.line_length;
+    _fb_format = {(uint8_t)vinfo.red.offset, (uint8_t)vinfo.green.offset, (uint8_t)vinfo.blue.offset,
+                  vinfo.transp.length ? ((1U << vinfo.transp.length) - 1) << vinfo.transp.offset : 0};
+
+    _fb_len = (size_t)_fb_stride * vinfo.yres * (flip ? 2 : 1);
+    if(_fb_len > finfo.smem_len) _fb_len = finfo.smem_len;
+    _fb = (uint8_t*)mmap(NULL, _fb_len, PROT_READ | PROT_WRITE, MAP_SHARED, _fb_fd, 0);
+    if(_fb == MAP_FAILED) {
+        perror("Couldn't map framebuffer");
+        _fb = nullptr;
+        close(_fb_fd);
+        _fb_fd = -1;
+        return false;
+    }
+
+    /* lvgl can only render into a framebuffer that matches its own buffer layout, set_rotation() checks the rotation */
+    bool native = _fb_bpp == LV_COLOR_DEPTH && _fb_stride == _width * sizeof(lv_color_t) && _fb_format.red == 11 &&
+                  _fb_format.green == 5 && _fb_format.blue == 0;
+    if(!native) {
+        _fb_mode = FB_MODE_CONVERT;
+    } else if(flip) {
+        _fb_mode = FB_MODE_FLIP;
+        fb_pan(0);
+    } else {
+        _fb_mode = FB_MODE_DIRECT;
+    }
+
+    const char* mode[] = {"", "convert", "direct", "flip"};
+    LOG_VERBOSE(TAG_TFT, F("Framebuffer: %ux%u %u bpp %s"), vinfo.xres, vinfo.yres, _fb_bpp, mode[_fb_mode]);
+    return true;
+}
+
+/* Show a framebuffer page, waits for the vertical sync if the driver supports it */
+void TftFbdevDrv::fb_pan(uint8_t page)
+{
+    struct fb_var_screeninfo vinfo;
+    if(ioctl(_fb_fd, FBIOGET_VSCREENINFO, &vinfo) == -1) return;
+
+    int crtc = 0;
+    ioctl(_fb_fd, FBIO_WAITFORVSYNC, &crtc); // optional
+
+    vinfo.yoffset = page * vinfo.yres;
+    if(ioctl(_fb_fd, FBIOPAN_DISPLAY, &vinfo) == -1) perror("Couldn't pan framebuffer");
+    _fb_page = page;
+}
+
+/* Copy an area of the draw buffer into the framebuffer, converting the pixel format */
+void TftFbdevDrv::fb_write(const lv_area_t* area, const lv_color_t* color_p)
+{
+    int32_t w  = lv_area_get_width(area);
+    int32_t x1 = LV_MATH_MAX(area->x1, 0);
+    int32_t x2 = LV_MATH_MIN(area->x2, _width - 1);
+    int32_t y1 = LV_MATH_MAX(area->y1, 0);
+    int32_t y2 = LV_MATH_MIN(area->y2, _height - 1);
+    if(x1 > x2 || y1 > y2) return;
+
+    uint32_t len        = x2 - x1 + 1;
+    uint32_t bytes      = _fb_bpp / 8;
+    const uint16_t* src = (const uint16_t*)color_p + (y1 - area->y1) * w + (x1 - area->x1);
+    uint8_t* dst        = _fb + y1 * _fb_stride + x1 * bytes;
+    bool rgb565         = _fb_format.red == 11 && _fb_format.green == 5 && _fb_format.blue == 0;
+
+    for(int32_t y = y1; y <= y2; y++, src += w, dst += _fb_stride) {
+        switch(_fb_bpp) {
+            case 16:
+                if(rgb565) {
+                    memcpy(dst, src, len * sizeof(uint16_t)); // only the stride differs
+                } else {
+                    uint16_t* p = (uint16_t*)dst;
+                    for(uint32_t i = 0; i < len; i++)
+                        p[i] = fb_pixel_reorder_565(src[i], _fb_format.red, _fb_format.green, _fb_format.blue);
+                }
+                break;
+            case 32:
+                fb_convert_565((uint32_t*)dst, src, len, _fb_format.red, _fb_format.green, _fb_format.blue,
+                               _fb_format.alpha);
+                break;
+            case 24: {
+                uint32_t pixels[64]; // convert in chunks and drop the fourth byte
+                for(uint32_t i = 0; i < len; i += 64) {
+                    uint32_t n = LV_MATH_MIN(len - i, 64U);
+                    fb_convert_565(pixels, src + i, n, _fb_format.red, _fb_format.green, _fb_format.blue, 0);
+                    uint8_t* p = dst + i * 3;
+                    for(uint32_t j = 0; j < n; j++, p += 3) {
+                        p[0] = pixels[j];
+                        p[1] = pixels[j] >> 8;
+                        p[2] = pixels[j] >> 16;
+                    }
+                }
+                break;
+            }
+        }
+    }
+}
+
+/**
+ * Copy an area that lvgl rendered in rotated coordinates into the framebuffer, converting the pixel format
+ * Without sw_rotate lvgl leaves the rotation to the driver, this maps the coordinates like lvgl's sw_rotate does.
+ */
+void TftFbdevDrv::fb_write_rotated(lv_disp_rot_t rotation, const lv_area_t* area, const lv_color_t* color_p)
+{
+    int32_t w           = lv_area_get_width(area);
+    uint32_t bytes      = _fb_bpp / 8;
+    const uint16_t* src = (const uint16_t*)color_p;
+    bool rgb565         = _fb_format.red == 11 && _fb_format.green == 5 && _fb_format.blue == 0;
+    uint32_t pixels[64];
+
+    for(int32_t y = area->y1; y <= area->y2; y++, src += w) {
+        for(int32_t i = 0; i < w; i += 64) {
+            int32_t n = LV_MATH_MIN(w - i, 64);
+            if(_fb_bpp != 16)
+                fb_convert_565(pixels, src + i, n, _fb_format.red, _fb_format.green, _fb_format.blue,
+                               _fb_bpp == 32 ? _fb_format.alpha : 0);
+
+            for(int32_t j = 0; j < n; j++) {
+                int32_t x = area->x1 + i + j;
+                int32_t px, py;
+                switch(rotation) {
+                    case LV_DISP_ROT_90:
+                        px = y;
+                        py = _height - 1 - x;
+                        break;
+                    case LV_DISP_ROT_180:
+                        px = _width - 1 - x;
+                        py = _height - 1 - y;
+                        break;
+                    default: // LV_DISP_ROT_270
+                        px = _width - 1 - y;
+                        py = x;
+                        break;
+                }
+                if(px < 0 || py < 0 || px >= _width || py >= _height) continue;
+
+                uint8_t* dst = _fb + py * _fb_stride + px * bytes;
+                switch(_fb_bpp) {
+                    case 16:
+                        *(uint16_t*)dst = rgb565 ? src[i + j]
+                                                 : fb_pixel_reorder_565(src[i + j], _fb_format.red, _fb_format.green,
+                                                                        _fb_format.blue);
+                        break;
+                    case 32:
+                        *(uint32_t*)dst = pixels[j];
+                        break;
+                    default:
+                        dst[0] = pixels[j];
+                        dst[1] = pixels[j] >> 8;
+                        dst[2] = pixels[j] >> 16;
+                        break;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Hand the mapped framebuffer to lvgl in direct and flip mode
+ * lvgl only renders at screen coordinates with two screen sized buffers. In direct mode both buffers
+ * are the visible framebuffer, so the copy lvgl makes to keep its buffers in sync is a no-op.
+ */
+bool TftFbdevDrv::get_draw_buffers(lv_color_t** buf1, lv_color_t** buf2, uint32_t* size)
+{
+    if(_fb_mode != FB_MODE_DIRECT && _fb_mode != FB_MODE_FLIP) return false;
+
+    *buf1 = (lv_color_t*)_fb;
+    *buf2 = _fb_mode == FB_MODE_FLIP ? (lv_color_t*)(_fb + _fb_stride * _height) : *buf1;
+    *size = _width * _height;
+    return true;
+}
+
 void TftFbdevDrv::flush_pixels(lv_disp_drv_t* disp, const lv_area_t* area, lv_color_t* color_p)
 {
+    switch(_fb_mode) {
+        case FB_MODE_CONVERT:
+            if(!disp->sw_rotate && disp->rotated != LV_DISP_ROT_NONE)
+                fb_write_rotated((lv_disp_rot_t)disp->rotated, area, color_p);
+            else
+                fb_write(area, color_p);
+            break;
+        case FB_MODE_FLIP:
+            if(lv_disp_flush_is_last(disp)) fb_pan((uint8_t*)color_p == _fb ? 0 : 1);
+            break;
+        default: // the pixels are already in place
+            break;
+    }
     lv_disp_flush_ready(disp);
 }
 bool TftFbdevDrv::is_driver_pin(uint8_t pin)
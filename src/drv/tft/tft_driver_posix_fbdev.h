@@ -25,6 +25,7 @@ class TftFbdevDrv : BaseTft {
     void set_invert(bool invert);
 
     void flush_pixels(lv_disp_drv_t* disp, const lv_area_t* area, lv_color_t* color_p);
+    bool get_draw_buffers(lv_color_t** buf1, lv_color_t** buf2, uint32_t* size);
     bool is_driver_pin(uint8_t pin);
 
     const char* get_tft_model();
@@ -34,10 +35,32 @@ class TftFbdevDrv : BaseTft {
 
   public:
     std::string fbdev_path;
+    std::string fbdev_mode; // "direct" or "flip" to let lvgl render into the framebuffer
     std::vector<std::string> evdev_names;
 
   private:
     int32_t _width, _height;
+    uint8_t _rotation = 0;
+
+    /* Framebuffer mapped by the driver itself */
+    struct fb_format_t
+    {
+        uint8_t red, green, blue; // bit offset of each channel
+        uint32_t alpha;           // opaque alpha bits
+    };
+    int _fb_fd       = -1;
+    uint8_t* _fb     = nullptr;
+    size_t _fb_len   = 0;
+    uint32_t _fb_stride;
+    uint8_t _fb_bpp;
+    uint8_t _fb_mode = 0;
+    uint8_t _fb_page = 0;
+    fb_format_t _fb_format;
+
+    bool fb_map();
+    void fb_pan(uint8_t page);
+    void fb_write(const lv_area_t* area, const lv_color_t* color_p);
+    void fb_write_rotated(lv_disp_rot_t rotation, const lv_area_t* area, const lv_color_t* color_p);
 };
 
 } // namespace dev
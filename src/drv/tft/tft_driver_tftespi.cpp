@@ -136,21 +136,42 @@ void IRAM_ATTR TftEspi::flush_pixels(lv_disp_drv_t* disp, const lv_area_t* area,
     uint32_t len = w * h;
 
 #ifdef USE_DMA_TO_TFT
+    dma_wait();                                  /* The previous transfer must be done */
     tft.startWrite();                            /* Start new TFT transaction */
     tft.setAddrWindow(area->x1, area->y1, w, h); /* set the working window */
-    tft.pushPixelsDMA((uint16_t*)color_p, len);  /* Write words at once */
-    tft.endWrite();                              /* terminate TFT transaction */
+    tft.pushPixelsDMA((uint16_t*)color_p, len);  /* Start the transfer, flush_wait() ends it */
+    dma_pending = true;
 #else
     tft.startWrite();                            /* Start new TFT transaction */
     tft.setAddrWindow(area->x1, area->y1, w, h); /* set the working window */
     tft.pushPixels((uint16_t*)color_p, len);     /* Write words at once */
     tft.endWrite();                              /* terminate TFT transaction */
-#endif
 
     /* Tell lvgl that flushing is done */
     lv_disp_flush_ready(disp);
+#endif
 }
 
+#ifdef USE_DMA_TO_TFT
+/* Wait for the pending DMA transfer to complete and release the bus */
+bool IRAM_ATTR TftEspi::dma_wait()
+{
+    if(!dma_pending) return false;
+
+    tft.dmaWait();
+    tft.endWrite(); /* terminate TFT transaction */
+    dma_pending = false;
+    return true;
+}
+
+/* Called by lvgl while it waits for the buffer that is being flushed */
+void IRAM_ATTR TftEspi::flush_wait(lv_disp_drv_t* disp)
+{
+    /* Tell lvgl that flushing is done */
+    if(dma_wait()) lv_disp_flush_ready(disp);
+}
+#endif
+
 bool TftEspi::is_driver_pin(uint8_t pin)
 {
     if(false // start condition is always needed
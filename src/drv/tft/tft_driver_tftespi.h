@@ -21,6 +21,10 @@
 #include "custom/bootlogo_template.h" // Sketch tab header for xbm images
 #endif
 
+#ifdef USE_DMA_TO_TFT
+#define HASP_TFT_ASYNC_FLUSH 1 // flush_pixels() starts a DMA transfer that flush_wait() completes
+#endif
+
 namespace dev {
 
 class TftEspi : BaseTft {
@@ -36,6 +40,9 @@ class TftEspi : BaseTft {
     void set_invert(bool invert);
 
     void flush_pixels(lv_disp_drv_t* disp, const lv_area_t* area, lv_color_t* color_p);
+#ifdef USE_DMA_TO_TFT
+    void flush_wait(lv_disp_drv_t* disp);
+#endif
     bool is_driver_pin(uint8_t pin);
 
     const char* get_tft_model();
@@ -48,6 +55,12 @@ class TftEspi : BaseTft {
     }
 
   private:
+#ifdef USE_DMA_TO_TFT
+    bool dma_pending = false;
+
+    bool dma_wait();
+#endif
+
     void tftOffsetInfo(uint8_t pin, uint8_t x_offset, uint8_t y_offset)
     {
         if(x_offset != 0) {
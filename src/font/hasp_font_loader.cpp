@@ -23,11 +23,58 @@
  **********************/
 typedef struct
 {
-    lv_fs_file_t* fp;
-    int8_t bit_pos;
-    uint8_t byte_value;
+    const uint8_t* data;
+    uint32_t bit_pos; // position of the next bit from the start of data
 } bit_iterator_t;
 
+#define FONT_PAGE_NONE 0xFFFF  // no slot
+#define FONT_PAGE_WINDOW 4096  // bytes read at once while loading the glyph headers of a paged font
+
+typedef struct
+{
+    uint32_t gid;   // glyph in the slot, 0 if the slot holds nothing
+    uint16_t chain; // next slot in the same hash bucket
+    uint16_t prev;  // more recently used slot
+    uint16_t next;  // less recently used slot
+} font_page_slot_t;
+
+/* A paged font keeps its file open and reads the glyph bitmaps on use into a fixed number of slots */
+typedef struct
+{
+    lv_fs_file_t file;
+    uint32_t file_size;
+    uint32_t glyph_start; // offset of the glyf table in the file
+    uint32_t glyph_length;
+    const uint8_t* loca; // glyph offsets in the glyf table
+    uint32_t loca_count;
+    uint8_t loca_format;
+    uint16_t header_bits; // size of the glyph header in front of each bitmap
+
+    uint8_t* bitmaps; // slot_count bitmaps of slot_size bytes
+    uint32_t slot_size;
+    uint16_t slot_count;
+    uint16_t slot_used;
+    font_page_slot_t* slots;
+    uint16_t* buckets; // first slot of each hash chain
+    uint32_t bucket_mask;
+    uint16_t lru_head; // most recently used slot
+    uint16_t lru_tail; // least recently used slot
+
+    uint8_t* window; // file contents at window_pos, only while loading
+    uint32_t window_pos;
+    uint32_t window_len;
+} font_pages_t;
+
+/* The font data is parsed from memory, tables and bitmaps are referenced in place where possible */
+typedef struct
+{
+    lv_font_t font;
+    const uint8_t* data; // font file contents, or only the head, cmap and loca tables of a paged font
+    uint32_t size;
+    uint8_t* buffer;     // data if it was read from a file and is owned by the font
+    font_pages_t* pages; // glyph bitmap cache of a paged font
+} font_bin_t;
+
 typedef struct font_header_bin
 {
     uint32_t version;
@@ -70,12 +117,19 @@ typedef struct cmap_table_bin
 /**********************
  *  STATIC PROTOTYPES
  **********************/
-static bit_iterator_t init_bit_iterator(lv_fs_file_t* fp);
-static bool lvgl_load_font(lv_fs_file_t* fp, lv_font_t* font);
-int32_t load_kern(lv_fs_file_t* fp, lv_font_fmt_txt_dsc_t* font_dsc, uint8_t format, uint32_t start);
+static bit_iterator_t init_bit_iterator(const uint8_t* data);
+static bool lvgl_load_font(font_bin_t* bin);
+static lv_font_t* font_load_paged(lv_fs_file_t* file, uint32_t size, const char* font_name);
+static void font_pages_free(font_pages_t* pages);
+static const uint8_t* font_get_bitmap_paged(const lv_font_t* font, uint32_t unicode_letter);
 
-static int read_bits_signed(bit_iterator_t* it, int n_bits, lv_fs_res_t* res);
-static unsigned int read_bits(bit_iterator_t* it, int n_bits, lv_fs_res_t* res);
+static int read_bits_signed(bit_iterator_t* it, int n_bits);
+static unsigned int read_bits(bit_iterator_t* it, int n_bits);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static hasp_font_cache_stats_t font_cache_stats;
 
 /**********************
  *      MACROS
@@ -87,37 +141,108 @@ static unsigned int read_bits(bit_iterator_t* it, int n_bits, lv_fs_res_t* res);
 
 /**
  * Loads a `lv_font_t` object from a binary font file
+ * The file is read in one pass, the glyph bitmaps stay in the file buffer.
+ * Files larger than HASP_FONT_PAGED_SIZE are paged instead: the file stays open and only the glyph
+ * bitmaps in use are kept, in a cache of HASP_FONT_PAGE_CACHE_SIZE bytes.
  * @param font_name filename where the font file is located
  * @return a pointer to the font or NULL in case of error
  */
 lv_font_t* hasp_font_load(const char* font_name)
 {
-    bool success = false;
+    lv_fs_file_t file;
+    if(lv_fs_open(&file, font_name, LV_FS_MODE_RD) != LV_FS_RES_OK) return NULL;
 
-    lv_font_t* font = (lv_font_t*)malloc(sizeof(lv_font_t));
-    memset(font, 0, sizeof(lv_font_t));
+    uint32_t size   = 0;
+    uint32_t read   = 0;
+    uint8_t* buffer = NULL;
+    if(lv_fs_size(&file, &size) != LV_FS_RES_OK) size = 0;
 
-    lv_fs_file_t file;
-    lv_fs_res_t res = lv_fs_open(&file, font_name, LV_FS_MODE_RD);
+#if HASP_FONT_PAGED_SIZE > 0
+    if(size > HASP_FONT_PAGED_SIZE) return font_load_paged(&file, size, font_name);
+#endif
 
-    if(res == LV_FS_RES_OK) {
-        success = lvgl_load_font(&file, font);
+    if(size > 0) buffer = (uint8_t*)hasp_malloc(size);
+    if(buffer && (lv_fs_read(&file, buffer, size, &read) != LV_FS_RES_OK || read != size)) {
+        hasp_free(buffer);
+        buffer = NULL;
     }
-
     lv_fs_close(&file);
 
-    if(!success) {
-        // LOG_WARNING(TAG_FONT, "Error loading font %s", font_name);
+    if(!buffer) {
+        LOG_WARNING(TAG_FONT, F(D_FILE_LOAD_FAILED), font_name);
+        return NULL;
+    }
+
+    return hasp_font_load_buffer(buffer, size);
+}
+
+/**
+ * Loads a `lv_font_t` object from the contents of a binary font file that were already read
+ * The font takes ownership of the buffer, it is freed with the font or when loading fails.
+ * @param buffer contents of a binary font file, allocated with hasp_malloc
+ * @param size size of the buffer in bytes
+ * @return a pointer to the font or NULL in case of error
+ */
+lv_font_t* hasp_font_load_buffer(uint8_t* buffer, uint32_t size)
+{
+    font_bin_t* bin = (font_bin_t*)calloc(1, sizeof(font_bin_t));
+    if(!bin) {
+        hasp_free(buffer);
+        return NULL;
+    }
+    bin->data   = buffer;
+    bin->size   = size;
+    bin->buffer = buffer;
+
+    if(!lvgl_load_font(bin)) {
         /*
          * When `lvgl_load_font` fails it can leak some pointers.
          * All non-null pointers can be assumed as allocated and
          * `lv_font_free` should free them correctly.
          */
-        hasp_font_free(font);
-        font = NULL;
+        hasp_font_free(&bin->font);
+        return NULL;
     }
 
-    return font;
+    return &bin->font;
+}
+
+/**
+ * Loads a `lv_font_t` object from binary font data in memory, like a font file mapped from flash
+ * The data is not copied, it must stay valid until the font is freed.
+ * @param data contents of a binary font file
+ * @param size size of the data in bytes
+ * @return a pointer to the font or NULL in case of error
+ */
+lv_font_t* hasp_font_load_data(const uint8_t* data, uint32_t size)
+{
+    font_bin_t* bin = (font_bin_t*)calloc(1, sizeof(font_bin_t));
+    if(!bin) return NULL;
+    bin->data = data;
+    bin->size = size;
+
+    if(!lvgl_load_font(bin)) {
+        hasp_font_free(&bin->font);
+        return NULL;
+    }
+
+    return &bin->font;
+}
+
+/**
+ * Get the glyph bitmap cache statistics of all paged fonts
+ * @param stats the statistics are copied here
+ */
+void hasp_font_get_cache_stats(hasp_font_cache_stats_t* stats)
+{
+    *stats = font_cache_stats;
+}
+
+/* Only tables that were copied out of the font data are freed */
+static inline void font_free_table(font_bin_t* bin, const void* table)
+{
+    const uint8_t* p = (const uint8_t*)table;
+    if(p && (p < bin->data || p >= bin->data + bin->size)) free((void*)table);
 }
 
 /**
@@ -127,30 +252,31 @@ lv_font_t* hasp_font_load(const char* font_name)
 void hasp_font_free(lv_font_t* font)
 {
     if(NULL != font) {
+        font_bin_t* bin            = (font_bin_t*)font;
         lv_font_fmt_txt_dsc_t* dsc = (lv_font_fmt_txt_dsc_t*)font->dsc;
 
+        if(NULL != bin->pages) {
+            if(NULL != dsc) dsc->glyph_bitmap = NULL; // points into the cache
+            font_pages_free(bin->pages);
+        }
+
         if(NULL != dsc) {
 
             if(dsc->kern_classes == 0) {
                 lv_font_fmt_txt_kern_pair_t* kern_dsc = (lv_font_fmt_txt_kern_pair_t*)dsc->kern_dsc;
 
                 if(NULL != kern_dsc) {
-                    if(kern_dsc->glyph_ids) free((void*)kern_dsc->glyph_ids);
-
-                    if(kern_dsc->values) free((void*)kern_dsc->values);
-
+                    font_free_table(bin, kern_dsc->glyph_ids);
+                    font_free_table(bin, kern_dsc->values);
                     free((void*)kern_dsc);
                 }
             } else {
                 lv_font_fmt_txt_kern_classes_t* kern_dsc = (lv_font_fmt_txt_kern_classes_t*)dsc->kern_dsc;
 
                 if(NULL != kern_dsc) {
-                    if(kern_dsc->class_pair_values) free((void*)kern_dsc->class_pair_values);
-
-                    if(kern_dsc->left_class_mapping) free((void*)kern_dsc->left_class_mapping);
-
-                    if(kern_dsc->right_class_mapping) free((void*)kern_dsc->right_class_mapping);
-
+                    font_free_table(bin, kern_dsc->class_pair_values);
+                    font_free_table(bin, kern_dsc->left_class_mapping);
+                    font_free_table(bin, kern_dsc->right_class_mapping);
                     free((void*)kern_dsc);
                 }
             }
@@ -159,21 +285,22 @@ void hasp_font_free(lv_font_t* font)
 
             if(NULL != cmaps) {
                 for(int i = 0; i < dsc->cmap_num; ++i) {
-                    if(NULL != cmaps[i].glyph_id_ofs_list) free((void*)cmaps[i].glyph_id_ofs_list);
-                    if(NULL != cmaps[i].unicode_list) free((void*)cmaps[i].unicode_list);
+                    font_free_table(bin, cmaps[i].glyph_id_ofs_list);
+                    font_free_table(bin, cmaps[i].unicode_list);
                 }
                 free(cmaps);
             }
 
             if(NULL != dsc->glyph_bitmap) {
-                free((void*)dsc->glyph_bitmap);
+                font_free_table(bin, dsc->glyph_bitmap);
             }
             if(NULL != dsc->glyph_dsc) {
                 free((void*)dsc->glyph_dsc);
             }
             free(dsc);
         }
-        free(font);
+        if(bin->buffer) hasp_free(bin->buffer);
+        free(bin);
     }
 }
 
@@ -181,55 +308,98 @@ void hasp_font_free(lv_font_t* font)
  *   STATIC FUNCTIONS
  **********************/
 
-static bit_iterator_t init_bit_iterator(lv_fs_file_t* fp)
+static bit_iterator_t init_bit_iterator(const uint8_t* data)
 {
     bit_iterator_t it;
-    it.fp         = fp;
-    it.bit_pos    = -1;
-    it.byte_value = 0;
+    it.data    = data;
+    it.bit_pos = 0;
     return it;
 }
 
-static unsigned int read_bits(bit_iterator_t* it, int n_bits, lv_fs_res_t* res)
+/* Read n_bits (max 32) msb first, a byte at a time */
+static unsigned int read_bits(bit_iterator_t* it, int n_bits)
 {
     unsigned int value = 0;
-    while(n_bits--) {
-        it->byte_value = it->byte_value << 1;
-        it->bit_pos--;
-
-        if(it->bit_pos < 0) {
-            it->bit_pos = 7;
-            *res        = lv_fs_read(it->fp, &(it->byte_value), 1, NULL);
-            if(*res != LV_FS_RES_OK) {
-                return 0;
-            }
-        }
-        int8_t bit = (it->byte_value & 0x80) ? 1 : 0;
-
-        value |= (bit << n_bits);
+    while(n_bits > 0) {
+        uint8_t byte  = it->data[it->bit_pos >> 3];
+        int available = 8 - (it->bit_pos & 7);
+        int take      = n_bits < available ? n_bits : available;
+
+        value = (value << take) | ((byte >> (available - take)) & ((1u << take) - 1));
+        it->bit_pos += take;
+        n_bits -= take;
     }
-    *res = LV_FS_RES_OK;
     return value;
 }
 
-static int read_bits_signed(bit_iterator_t* it, int n_bits, lv_fs_res_t* res)
+static int read_bits_signed(bit_iterator_t* it, int n_bits)
 {
-    unsigned int value = read_bits(it, n_bits, res);
-    if(value & (1 << (n_bits - 1))) {
+    unsigned int value = read_bits(it, n_bits);
+    if(n_bits > 0 && value & (1 << (n_bits - 1))) {
         value |= ~0u << n_bits;
     }
     return value;
 }
 
-static int read_label(lv_fs_file_t* fp, int start, const char* label)
+/* Unaligned little endian reads, the font data can be anywhere */
+static inline uint32_t read_u32(const uint8_t* p)
+{
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static inline uint16_t read_u16(const uint8_t* p)
+{
+    uint16_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+/* Size of the whole font, a paged font only has part of it in memory */
+static inline uint32_t font_size(font_bin_t* bin)
 {
-    LV_FS_SEEK(fp, start);
+    return bin->pages ? bin->pages->file_size : bin->size;
+}
 
-    uint32_t length;
-    char buf[4];
+/**
+ * Get len bytes at pos in the font, a paged font reads what isn't in memory through a small window
+ * @return pointer to the bytes, valid until the next call, or NULL if they are out of bounds or can't be read
+ */
+static const uint8_t* font_read(font_bin_t* bin, uint32_t pos, uint32_t len)
+{
+    if(pos <= bin->size && len <= bin->size - pos) return bin->data + pos;
+
+    font_pages_t* pages = bin->pages;
+    if(!pages || !pages->window || pos > pages->file_size || len > pages->file_size - pos ||
+       len > FONT_PAGE_WINDOW) {
+        return NULL;
+    }
+
+    if(pos < pages->window_pos || pos + len > pages->window_pos + pages->window_len) {
+        uint32_t count = LV_MATH_MIN(FONT_PAGE_WINDOW, pages->file_size - pos);
+        uint32_t read  = 0;
+        pages->window_len = 0;
+        if(LV_FS_SEEK(&pages->file, pos) != LV_FS_RES_OK ||
+           lv_fs_read(&pages->file, pages->window, count, &read) != LV_FS_RES_OK || read != count) {
+            return NULL;
+        }
+        pages->window_pos = pos;
+        pages->window_len = count;
+    }
+    return pages->window + (pos - pages->window_pos);
+}
 
-    if(lv_fs_read(fp, &length, 4, NULL) != LV_FS_RES_OK || lv_fs_read(fp, buf, 4, NULL) != LV_FS_RES_OK ||
-       memcmp(label, buf, 4) != 0) {
+static int32_t read_label(font_bin_t* bin, uint32_t start, const char* label)
+{
+    const uint8_t* p = font_read(bin, start, 8);
+    if(!p || memcmp(label, p + 4, 4) != 0) {
+        LOG_WARNING(TAG_FONT, "Error reading '%s' label.", label);
+        return -1;
+    }
+
+    uint32_t length = read_u32(p);
+    if(length < 8 || length > font_size(bin) - start) {
         LOG_WARNING(TAG_FONT, "Error reading '%s' label.", label);
         return -1;
     }
@@ -237,34 +407,46 @@ static int read_label(lv_fs_file_t* fp, int start, const char* label)
     return length;
 }
 
-static bool load_cmaps_tables(lv_fs_file_t* fp, lv_font_fmt_txt_dsc_t* font_dsc, uint32_t cmaps_start,
-                              cmap_table_bin_t* cmap_table)
+/**
+ * Reference a table in the font data, or a copy if the data isn't aligned for its type
+ * @return pointer to the table or NULL if it is out of bounds or out of memory
+ */
+static const void* font_get_table(font_bin_t* bin, uint32_t offset, uint32_t size, uint8_t align)
+{
+    if(offset > bin->size || size > bin->size - offset) return NULL;
+
+    const uint8_t* table = bin->data + offset;
+    if(((uintptr_t)table & (align - 1)) == 0) return table;
+
+    void* copy = malloc(size ? size : 1);
+    if(copy) memcpy(copy, table, size);
+    return copy;
+}
+
+static bool load_cmaps_tables(font_bin_t* bin, lv_font_fmt_txt_dsc_t* font_dsc, uint32_t cmaps_start)
 {
-    if(lv_fs_read(fp, cmap_table, font_dsc->cmap_num * sizeof(cmap_table_bin_t), NULL) != LV_FS_RES_OK) {
+    uint32_t tables_start = cmaps_start + 12;
+    if(tables_start + font_dsc->cmap_num * sizeof(cmap_table_bin_t) > bin->size) {
         return false;
     }
 
     for(unsigned int i = 0; i < font_dsc->cmap_num; ++i) {
-        lv_fs_res_t res = LV_FS_SEEK(fp, cmaps_start + cmap_table[i].data_offset);
-        if(res != LV_FS_RES_OK) {
-            return false;
-        }
+        cmap_table_bin_t cmap_table;
+        memcpy(&cmap_table, bin->data + tables_start + i * sizeof(cmap_table_bin_t), sizeof(cmap_table_bin_t));
+        uint32_t data_start = cmaps_start + cmap_table.data_offset;
 
         lv_font_fmt_txt_cmap_t* cmap = (lv_font_fmt_txt_cmap_t*)&(font_dsc->cmaps[i]);
 
-        cmap->range_start    = cmap_table[i].range_start;
-        cmap->range_length   = cmap_table[i].range_length;
-        cmap->glyph_id_start = cmap_table[i].glyph_id_start;
-        cmap->type           = cmap_table[i].format_type;
+        cmap->range_start    = cmap_table.range_start;
+        cmap->range_length   = cmap_table.range_length;
+        cmap->glyph_id_start = cmap_table.glyph_id_start;
+        cmap->type           = cmap_table.format_type;
 
-        switch(cmap_table[i].format_type) {
+        switch(cmap_table.format_type) {
             case LV_FONT_FMT_TXT_CMAP_FORMAT0_FULL: {
-                uint8_t ids_size           = sizeof(uint8_t) * cmap_table[i].data_entries_count;
-                uint8_t* glyph_id_ofs_list = (uint8_t*)malloc(ids_size);
-
-                cmap->glyph_id_ofs_list = glyph_id_ofs_list;
-
-                if(lv_fs_read(fp, glyph_id_ofs_list, ids_size, NULL) != LV_FS_RES_OK) {
+                uint32_t ids_size       = sizeof(uint8_t) * cmap_table.data_entries_count;
+                cmap->glyph_id_ofs_list = font_get_table(bin, data_start, ids_size, 1);
+                if(!cmap->glyph_id_ofs_list) {
                     return false;
                 }
 
@@ -275,127 +457,375 @@ static bool load_cmaps_tables(lv_fs_file_t* fp, lv_font_fmt_txt_dsc_t* font_dsc,
                 break;
             case LV_FONT_FMT_TXT_CMAP_SPARSE_FULL:
             case LV_FONT_FMT_TXT_CMAP_SPARSE_TINY: {
-                uint32_t list_size     = sizeof(uint16_t) * cmap_table[i].data_entries_count;
-                uint16_t* unicode_list = (uint16_t*)malloc(list_size);
-
-                cmap->unicode_list = unicode_list;
-                cmap->list_length  = cmap_table[i].data_entries_count;
+                uint32_t list_size = sizeof(uint16_t) * cmap_table.data_entries_count;
 
-                if(lv_fs_read(fp, unicode_list, list_size, NULL) != LV_FS_RES_OK) {
+                cmap->list_length  = cmap_table.data_entries_count;
+                cmap->unicode_list = (const uint16_t*)font_get_table(bin, data_start, list_size, sizeof(uint16_t));
+                if(!cmap->unicode_list) {
                     return false;
                 }
 
-                if(cmap_table[i].format_type == LV_FONT_FMT_TXT_CMAP_SPARSE_FULL) {
-                    uint16_t* buf = (uint16_t*)malloc(sizeof(uint16_t) * cmap->list_length);
-
-                    cmap->glyph_id_ofs_list = buf;
-
-                    if(lv_fs_read(fp, buf, sizeof(uint16_t) * cmap->list_length, NULL) != LV_FS_RES_OK) {
+                if(cmap_table.format_type == LV_FONT_FMT_TXT_CMAP_SPARSE_FULL) {
+                    cmap->glyph_id_ofs_list = font_get_table(bin, data_start + list_size,
+                                                             sizeof(uint16_t) * cmap->list_length, sizeof(uint16_t));
+                    if(!cmap->glyph_id_ofs_list) {
                         return false;
                     }
                 }
                 break;
             }
             default:
-                LOG_WARNING(TAG_FONT, "Unknown cmaps format type %d.", cmap_table[i].format_type);
+                LOG_WARNING(TAG_FONT, "Unknown cmaps format type %d.", cmap_table.format_type);
                 return false;
         }
     }
     return true;
 }
 
-static int32_t load_cmaps(lv_fs_file_t* fp, lv_font_fmt_txt_dsc_t* font_dsc, uint32_t cmaps_start)
+static int32_t load_cmaps(font_bin_t* bin, lv_font_fmt_txt_dsc_t* font_dsc, uint32_t cmaps_start)
 {
-    int32_t cmaps_length = read_label(fp, cmaps_start, "cmap");
-    if(cmaps_length < 0) {
+    int32_t cmaps_length = read_label(bin, cmaps_start, "cmap");
+    if(cmaps_length < 12) {
         return -1;
     }
 
-    uint32_t cmaps_subtables_count;
-    if(lv_fs_read(fp, &cmaps_subtables_count, sizeof(uint32_t), NULL) != LV_FS_RES_OK) {
+    uint32_t cmaps_subtables_count = read_u32(bin->data + cmaps_start + 8);
+
+    uint32_t cmaps_size           = cmaps_subtables_count ? cmaps_subtables_count : 1;
+    lv_font_fmt_txt_cmap_t* cmaps = (lv_font_fmt_txt_cmap_t*)calloc(cmaps_size, sizeof(lv_font_fmt_txt_cmap_t));
+    if(!cmaps) {
         return -1;
     }
 
-    lv_font_fmt_txt_cmap_t* cmaps =
-        (lv_font_fmt_txt_cmap_t*)malloc(cmaps_subtables_count * sizeof(lv_font_fmt_txt_cmap_t));
-
-    memset(cmaps, 0, cmaps_subtables_count * sizeof(lv_font_fmt_txt_cmap_t));
-
     font_dsc->cmaps    = cmaps;
     font_dsc->cmap_num = cmaps_subtables_count;
 
-    cmap_table_bin_t* cmaps_tables = (cmap_table_bin_t*)malloc(sizeof(cmap_table_bin_t) * font_dsc->cmap_num);
+    return load_cmaps_tables(bin, font_dsc, cmaps_start) ? cmaps_length : -1;
+}
+
+/* Offset of a glyph in the glyf table */
+static inline uint32_t loca_get(const uint8_t* loca, uint8_t format, uint32_t index)
+{
+    return format == 0 ? read_u16(loca + index * sizeof(uint16_t)) : read_u32(loca + index * sizeof(uint32_t));
+}
+
+/* Allocate the bitmap cache of a paged font, every slot fits the largest glyph bitmap */
+static bool font_pages_init(font_pages_t* pages, uint32_t max_bmp_size)
+{
+    uint32_t slot_count = max_bmp_size ? HASP_FONT_PAGE_CACHE_SIZE / max_bmp_size : 0;
+    if(max_bmp_size && slot_count == 0) slot_count = 1; // lvgl draws one glyph at a time
+    if(slot_count > FONT_PAGE_NONE - 1) slot_count = FONT_PAGE_NONE - 1;
+    if(slot_count == 0) return true; // no bitmaps
+
+    uint32_t bucket_count = 1;
+    while(bucket_count < slot_count) bucket_count <<= 1;
+
+    pages->bitmaps = (uint8_t*)hasp_malloc(slot_count * max_bmp_size);
+    pages->slots   = (font_page_slot_t*)calloc(slot_count, sizeof(font_page_slot_t));
+    pages->buckets = (uint16_t*)malloc(bucket_count * sizeof(uint16_t));
+    if(!pages->bitmaps || !pages->slots || !pages->buckets) return false;
+
+    for(uint32_t i = 0; i < bucket_count; i++) pages->buckets[i] = FONT_PAGE_NONE;
+    pages->slot_size   = max_bmp_size;
+    pages->slot_count  = slot_count;
+    pages->bucket_mask = bucket_count - 1;
+    pages->lru_head    = FONT_PAGE_NONE;
+    pages->lru_tail    = FONT_PAGE_NONE;
+
+    font_cache_stats.size += slot_count * max_bmp_size;
+    font_cache_stats.fonts++;
+    return true;
+}
+
+static void font_pages_free(font_pages_t* pages)
+{
+    if(pages->bitmaps) {
+        font_cache_stats.size -= pages->slot_count * pages->slot_size;
+        font_cache_stats.used -= pages->slot_used * pages->slot_size;
+        font_cache_stats.fonts--;
+        hasp_free(pages->bitmaps);
+    }
+    free(pages->slots);
+    free(pages->buckets);
+    if(pages->window) hasp_free(pages->window);
+    lv_fs_close(&pages->file);
+    free(pages);
+}
+
+static void font_page_lru_unlink(font_pages_t* pages, uint16_t slot)
+{
+    font_page_slot_t* s = &pages->slots[slot];
+    if(s->prev != FONT_PAGE_NONE)
+        pages->slots[s->prev].next = s->next;
+    else
+        pages->lru_head = s->next;
+    if(s->next != FONT_PAGE_NONE)
+        pages->slots[s->next].prev = s->prev;
+    else
+        pages->lru_tail = s->prev;
+}
+
+static void font_page_lru_push(font_pages_t* pages, uint16_t slot, bool front)
+{
+    font_page_slot_t* s = &pages->slots[slot];
+    if(front) {
+        s->prev = FONT_PAGE_NONE;
+        s->next = pages->lru_head;
+        if(pages->lru_head != FONT_PAGE_NONE) pages->slots[pages->lru_head].prev = slot;
+        pages->lru_head = slot;
+        if(pages->lru_tail == FONT_PAGE_NONE) pages->lru_tail = slot;
+    } else {
+        s->next = FONT_PAGE_NONE;
+        s->prev = pages->lru_tail;
+        if(pages->lru_tail != FONT_PAGE_NONE) pages->slots[pages->lru_tail].next = slot;
+        pages->lru_tail = slot;
+        if(pages->lru_head == FONT_PAGE_NONE) pages->lru_head = slot;
+    }
+}
+
+static void font_page_hash_remove(font_pages_t* pages, uint16_t slot)
+{
+    uint16_t* link = &pages->buckets[pages->slots[slot].gid & pages->bucket_mask];
+    while(*link != FONT_PAGE_NONE) {
+        if(*link == slot) {
+            *link = pages->slots[slot].chain;
+            return;
+        }
+        link = &pages->slots[*link].chain;
+    }
+}
 
-    bool success = load_cmaps_tables(fp, font_dsc, cmaps_start, cmaps_tables);
+/* Read a glyph bitmap from the file, shifted to a byte boundary if the glyph header is not */
+static bool font_page_read(font_pages_t* pages, uint32_t gid, uint8_t* dst)
+{
+    uint32_t offset      = loca_get(pages->loca, pages->loca_format, gid);
+    uint32_t next_offset = gid < pages->loca_count - 1 ? loca_get(pages->loca, pages->loca_format, gid + 1)
+                                                       : pages->glyph_length;
+    uint32_t bmp_size    = next_offset - offset - pages->header_bits / 8; // checked when the font was loaded
+    if(bmp_size > pages->slot_size) return false;
+
+    uint32_t read = 0;
+    if(LV_FS_SEEK(&pages->file, pages->glyph_start + offset + pages->header_bits / 8) != LV_FS_RES_OK ||
+       lv_fs_read(&pages->file, dst, bmp_size, &read) != LV_FS_RES_OK || read != bmp_size) {
+        return false;
+    }
 
-    free(cmaps_tables);
+    uint8_t shift = pages->header_bits % 8;
+    if(shift && bmp_size > 0) {
+        for(uint32_t k = 0; k + 1 < bmp_size; ++k) {
+            dst[k] = (dst[k] << shift) | (dst[k + 1] >> (8 - shift));
+        }
+        dst[bmp_size - 1] <<= shift;
+    }
+    return true;
+}
 
-    return success ? cmaps_length : -1;
+/**
+ * Get the bitmap of a glyph from the cache, or read it into the least recently used slot
+ * @return pointer to the bitmap, valid until the next call, or NULL if it can't be read
+ */
+static const uint8_t* font_page_get(font_pages_t* pages, uint32_t gid)
+{
+    if(pages->slot_count == 0) return NULL;
+
+    uint16_t* bucket = &pages->buckets[gid & pages->bucket_mask];
+    for(uint16_t slot = *bucket; slot != FONT_PAGE_NONE; slot = pages->slots[slot].chain) {
+        if(pages->slots[slot].gid != gid) continue;
+
+        font_cache_stats.hits++;
+        if(pages->lru_head != slot) {
+            font_page_lru_unlink(pages, slot);
+            font_page_lru_push(pages, slot, true);
+        }
+        return pages->bitmaps + slot * pages->slot_size;
+    }
+
+    font_cache_stats.misses++;
+    uint16_t slot;
+    if(pages->slot_used < pages->slot_count) {
+        slot = pages->slot_used++;
+        font_cache_stats.used += pages->slot_size;
+    } else {
+        slot = pages->lru_tail;
+        if(pages->slots[slot].gid) font_page_hash_remove(pages, slot);
+        font_page_lru_unlink(pages, slot);
+    }
+
+    uint8_t* bitmap = pages->bitmaps + slot * pages->slot_size;
+    if(!font_page_read(pages, gid, bitmap)) {
+        pages->slots[slot].gid = 0;
+        font_page_lru_push(pages, slot, false); // reuse it first
+        return NULL;
+    }
+
+    pages->slots[slot].gid   = gid;
+    pages->slots[slot].chain = *bucket;
+    *bucket                  = slot;
+    font_page_lru_push(pages, slot, true);
+    return bitmap;
 }
 
-static int32_t load_glyph(lv_fs_file_t* fp, lv_font_fmt_txt_dsc_t* font_dsc, uint32_t start, uint32_t* glyph_offset,
+/* Find the glyph id of a letter, the same way lvgl does for the glyph descriptor */
+static uint32_t font_get_glyph_id(const lv_font_fmt_txt_dsc_t* dsc, uint32_t letter)
+{
+    for(uint16_t i = 0; i < dsc->cmap_num; i++) {
+        const lv_font_fmt_txt_cmap_t* cmap = &dsc->cmaps[i];
+        uint32_t rcp                       = letter - cmap->range_start;
+        if(rcp >= cmap->range_length) continue;
+
+        switch(cmap->type) {
+            case LV_FONT_FMT_TXT_CMAP_FORMAT0_TINY:
+                return cmap->glyph_id_start + rcp;
+            case LV_FONT_FMT_TXT_CMAP_FORMAT0_FULL:
+                return cmap->glyph_id_start + ((const uint8_t*)cmap->glyph_id_ofs_list)[rcp];
+            case LV_FONT_FMT_TXT_CMAP_SPARSE_TINY:
+            case LV_FONT_FMT_TXT_CMAP_SPARSE_FULL: {
+                uint32_t low  = 0;
+                uint32_t high = cmap->list_length;
+                while(low < high) {
+                    uint32_t mid = (low + high) / 2;
+                    if(cmap->unicode_list[mid] < rcp)
+                        low = mid + 1;
+                    else
+                        high = mid;
+                }
+                if(low == cmap->list_length || cmap->unicode_list[low] != rcp) return 0;
+                if(cmap->type == LV_FONT_FMT_TXT_CMAP_SPARSE_TINY) return cmap->glyph_id_start + low;
+                return cmap->glyph_id_start + ((const uint16_t*)cmap->glyph_id_ofs_list)[low];
+            }
+            default:
+                return 0;
+        }
+    }
+    return 0;
+}
+
+/* Point lvgl at the cached bitmap and let it decompress the glyph if needed */
+static const uint8_t* font_get_bitmap_paged(const lv_font_t* font, uint32_t unicode_letter)
+{
+    font_bin_t* bin            = (font_bin_t*)font;
+    lv_font_fmt_txt_dsc_t* dsc = (lv_font_fmt_txt_dsc_t*)font->dsc;
+
+    uint32_t gid = font_get_glyph_id(dsc, unicode_letter == '\t' ? ' ' : unicode_letter);
+    if(gid == 0 || gid >= bin->pages->loca_count) return NULL;
+
+    const uint8_t* bitmap = font_page_get(bin->pages, gid);
+    if(!bitmap) return NULL;
+
+    dsc->glyph_bitmap = bitmap;
+    return lv_font_get_bitmap_fmt_txt(font, unicode_letter);
+}
+
+/* Load the head, cmap and loca tables of a font file into memory and page in the glyph bitmaps on use */
+static lv_font_t* font_load_paged(lv_fs_file_t* file, uint32_t size, const char* font_name)
+{
+    font_bin_t* bin     = (font_bin_t*)calloc(1, sizeof(font_bin_t));
+    font_pages_t* pages = bin ? (font_pages_t*)calloc(1, sizeof(font_pages_t)) : NULL;
+    if(!pages) {
+        free(bin);
+        lv_fs_close(file);
+        return NULL;
+    }
+    pages->file      = *file;
+    pages->file_size = size;
+    pages->window    = (uint8_t*)hasp_malloc(FONT_PAGE_WINDOW);
+    bin->pages       = pages;
+
+    /* The glyf table follows the head, cmap and loca tables */
+    uint32_t resident = 0;
+    for(uint8_t i = 0; i < 3; i++) {
+        const uint8_t* label = font_read(bin, resident, 8);
+        uint32_t length      = label ? read_u32(label) : 0;
+        if(length < 8 || length > size - resident) {
+            resident = 0;
+            break;
+        }
+        resident += length;
+    }
+
+    uint32_t read   = 0;
+    uint8_t* buffer = resident ? (uint8_t*)hasp_malloc(resident) : NULL;
+    if(buffer && (LV_FS_SEEK(&pages->file, 0) != LV_FS_RES_OK ||
+                  lv_fs_read(&pages->file, buffer, resident, &read) != LV_FS_RES_OK || read != resident)) {
+        hasp_free(buffer);
+        buffer = NULL;
+    }
+    if(!buffer) {
+        LOG_WARNING(TAG_FONT, F(D_FILE_LOAD_FAILED), font_name);
+        hasp_font_free(&bin->font);
+        return NULL;
+    }
+    bin->data   = buffer;
+    bin->size   = resident;
+    bin->buffer = buffer;
+
+    if(!lvgl_load_font(bin)) {
+        hasp_font_free(&bin->font);
+        return NULL;
+    }
+
+    hasp_free(pages->window);
+    pages->window = NULL;
+    return &bin->font;
+}
+
+static int32_t load_glyph(font_bin_t* bin, lv_font_fmt_txt_dsc_t* font_dsc, uint32_t start, const uint8_t* loca,
                           uint32_t loca_count, font_header_bin_t* header)
 {
-    int32_t glyph_length = read_label(fp, start, "glyf");
+    int32_t glyph_length = read_label(bin, start, "glyf");
     if(glyph_length < 0) {
         return -1;
     }
 
     lv_font_fmt_txt_glyph_dsc_t* glyph_dsc =
-        (lv_font_fmt_txt_glyph_dsc_t*)malloc(loca_count * sizeof(lv_font_fmt_txt_glyph_dsc_t));
-
-    memset(glyph_dsc, 0, loca_count * sizeof(lv_font_fmt_txt_glyph_dsc_t));
+        (lv_font_fmt_txt_glyph_dsc_t*)calloc(loca_count ? loca_count : 1, sizeof(lv_font_fmt_txt_glyph_dsc_t));
+    if(!glyph_dsc) {
+        return -1;
+    }
 
     font_dsc->glyph_dsc = glyph_dsc;
 
-    int cur_bmp_size = 0;
+    int nbits             = header->advance_width_bits + 2 * header->xy_bits + 2 * header->wh_bits;
+    uint32_t cur_bmp_size = 0;
+    uint32_t max_bmp_size = 0;
+
+    /* The bitmaps follow the glyph headers on a byte boundary, they can then be used in place */
+    bool in_place = nbits % 8 == 0;
 
     for(unsigned int i = 0; i < loca_count; ++i) {
         lv_font_fmt_txt_glyph_dsc_t* gdsc = &glyph_dsc[i];
 
-        lv_fs_res_t res = LV_FS_SEEK(fp, start + glyph_offset[i]);
-        if(res != LV_FS_RES_OK) {
+        uint32_t offset      = loca_get(loca, header->index_to_loc_format, i);
+        uint32_t next_offset = (i < loca_count - 1) ? loca_get(loca, header->index_to_loc_format, i + 1)
+                                                    : (uint32_t)glyph_length;
+        if(next_offset > (uint32_t)glyph_length || offset + (nbits + 7) / 8 > next_offset) {
+            if(i > 0) return -1; // glyph 0 is ignored
+            continue;
+        }
+
+        const uint8_t* glyph_header = font_read(bin, start + offset, (nbits + 7) / 8);
+        if(!glyph_header) {
             return -1;
         }
 
-        bit_iterator_t bit_it = init_bit_iterator(fp);
+        bit_iterator_t bit_it = init_bit_iterator(glyph_header);
 
         if(header->advance_width_bits == 0) {
             gdsc->adv_w = header->default_advance_width;
         } else {
-            gdsc->adv_w = read_bits(&bit_it, header->advance_width_bits, &res);
-            if(res != LV_FS_RES_OK) {
-                return -1;
-            }
+            gdsc->adv_w = read_bits(&bit_it, header->advance_width_bits);
         }
 
         if(header->advance_width_format == 0) {
             gdsc->adv_w *= 16;
         }
 
-        gdsc->ofs_x = read_bits_signed(&bit_it, header->xy_bits, &res);
-        if(res != LV_FS_RES_OK) {
-            return -1;
-        }
+        gdsc->ofs_x = read_bits_signed(&bit_it, header->xy_bits);
+        gdsc->ofs_y = read_bits_signed(&bit_it, header->xy_bits);
+        gdsc->box_w = read_bits(&bit_it, header->wh_bits);
+        gdsc->box_h = read_bits(&bit_it, header->wh_bits);
 
-        gdsc->ofs_y = read_bits_signed(&bit_it, header->xy_bits, &res);
-        if(res != LV_FS_RES_OK) {
-            return -1;
-        }
-
-        gdsc->box_w = read_bits(&bit_it, header->wh_bits, &res);
-        if(res != LV_FS_RES_OK) {
-            return -1;
-        }
-
-        gdsc->box_h = read_bits(&bit_it, header->wh_bits, &res);
-        if(res != LV_FS_RES_OK) {
-            return -1;
-        }
-
-        int nbits       = header->advance_width_bits + 2 * header->xy_bits + 2 * header->wh_bits;
-        int next_offset = (i < loca_count - 1) ? glyph_offset[i + 1] : (uint32_t)glyph_length;
-        int bmp_size    = next_offset - glyph_offset[i] - nbits / 8;
+        uint32_t bmp_size = next_offset - offset - nbits / 8;
 
         if(i == 0) {
             gdsc->adv_w = 0;
@@ -405,64 +835,70 @@ static int32_t load_glyph(lv_fs_file_t* fp, lv_font_fmt_txt_dsc_t* font_dsc, uin
             gdsc->ofs_y = 0;
         }
 
-        gdsc->bitmap_index = cur_bmp_size;
+        /* The bitmap of a paged font is always at the start of its cache slot */
+        uint32_t bitmap_index = bin->pages ? 0 : in_place ? offset + nbits / 8 : cur_bmp_size;
+        gdsc->bitmap_index    = bitmap_index;
+        if(gdsc->bitmap_index != bitmap_index) {
+            LOG_WARNING(TAG_FONT, "Glyph bitmaps too large");
+            return -1;
+        }
         if(gdsc->box_w * gdsc->box_h != 0) {
             cur_bmp_size += bmp_size;
+            if(bmp_size > max_bmp_size) max_bmp_size = bmp_size;
         }
     }
 
-    uint8_t* glyph_bmp;
-    glyph_bmp = (uint8_t*)hasp_malloc(sizeof(uint8_t) * cur_bmp_size);
+    if(bin->pages) {
+        font_pages_t* pages = bin->pages;
+        pages->glyph_start  = start;
+        pages->glyph_length = glyph_length;
+        pages->loca         = loca;
+        pages->loca_count   = loca_count;
+        pages->loca_format  = header->index_to_loc_format;
+        pages->header_bits  = nbits;
+        return font_pages_init(pages, max_bmp_size) ? glyph_length : -1;
+    }
 
-    font_dsc->glyph_bitmap = glyph_bmp;
+    const uint8_t* glyf = bin->data + start;
+    if(in_place) {
+        font_dsc->glyph_bitmap = glyf;
+        return glyph_length;
+    }
 
-    cur_bmp_size = 0;
+    /* Shift the bitmaps to byte boundaries, in the file buffer itself if the font owns it.
+     * Every bitmap moves to a lower address than where it is read from, so nothing is overwritten before use. */
+    uint8_t* glyph_bmp = bin->buffer ? (uint8_t*)glyf : (uint8_t*)hasp_malloc(cur_bmp_size ? cur_bmp_size : 1);
+    if(!glyph_bmp) {
+        return -1;
+    }
+    font_dsc->glyph_bitmap = glyph_bmp;
 
     for(unsigned int i = 1; i < loca_count; ++i) {
-        lv_fs_res_t res = LV_FS_SEEK(fp, start + glyph_offset[i]);
-        if(res != LV_FS_RES_OK) {
-            return -1;
-        }
-        bit_iterator_t bit_it = init_bit_iterator(fp);
-
-        int nbits = header->advance_width_bits + 2 * header->xy_bits + 2 * header->wh_bits;
-
-        read_bits(&bit_it, nbits, &res);
-        if(res != LV_FS_RES_OK) {
-            return -1;
-        }
-
         if(glyph_dsc[i].box_w * glyph_dsc[i].box_h == 0) {
             continue;
         }
 
-        int next_offset = (i < loca_count - 1) ? glyph_offset[i + 1] : (uint32_t)glyph_length;
-        int bmp_size    = next_offset - glyph_offset[i] - nbits / 8;
+        uint32_t offset      = loca_get(loca, header->index_to_loc_format, i);
+        uint32_t next_offset = (i < loca_count - 1) ? loca_get(loca, header->index_to_loc_format, i + 1)
+                                                    : (uint32_t)glyph_length;
+        uint32_t bmp_size    = next_offset - offset - nbits / 8;
+        uint8_t* dst         = &glyph_bmp[glyph_dsc[i].bitmap_index];
 
-        if(nbits % 8 == 0) { /* Fast path */
-            if(lv_fs_read(fp, &glyph_bmp[cur_bmp_size], bmp_size, NULL) != LV_FS_RES_OK) {
-                return -1;
-            }
-        } else {
-            for(int k = 0; k < bmp_size - 1; ++k) {
-                glyph_bmp[cur_bmp_size + k] = read_bits(&bit_it, 8, &res);
-                if(res != LV_FS_RES_OK) {
-                    return -1;
-                }
-            }
-            glyph_bmp[cur_bmp_size + bmp_size - 1] = read_bits(&bit_it, 8 - nbits % 8, &res);
-            if(res != LV_FS_RES_OK) {
-                return -1;
-            }
-        }
+        bit_iterator_t bit_it = init_bit_iterator(glyf + offset);
+        bit_it.bit_pos        = nbits;
 
-        cur_bmp_size += bmp_size;
+        for(uint32_t k = 0; k + 1 < bmp_size; ++k) {
+            dst[k] = read_bits(&bit_it, 8);
+        }
+        if(bmp_size > 0) {
+            dst[bmp_size - 1] = read_bits(&bit_it, 8 - nbits % 8) << (nbits % 8);
+        }
     }
     return glyph_length;
 }
 
 /*
- * Loads a `lv_font_t` from a binary file, given a `lv_fs_file_t`.
+ * Loads a `lv_font_t` from binary font data in memory.
  *
  * Memory allocations on `lvgl_load_font` should be immediately zeroed and
  * the pointer should be set on the `lv_font_t` data before any possible return.
@@ -470,32 +906,32 @@ static int32_t load_glyph(lv_fs_file_t* fp, lv_font_fmt_txt_dsc_t* font_dsc, uin
  * When something fails, it returns `false` and the memory on the `lv_font_t`
  * still needs to be freed using `lv_font_free`.
  *
- * `lv_font_free` will assume that all non-null pointers are allocated and
- * should be freed.
+ * `lv_font_free` will assume that all non-null pointers outside of the font
+ * data are allocated and should be freed.
  */
-static bool lvgl_load_font(lv_fs_file_t* fp, lv_font_t* font)
+static bool lvgl_load_font(font_bin_t* bin)
 {
-    lv_font_fmt_txt_dsc_t* font_dsc = (lv_font_fmt_txt_dsc_t*)malloc(sizeof(lv_font_fmt_txt_dsc_t));
-
-    memset(font_dsc, 0, sizeof(lv_font_fmt_txt_dsc_t));
+    lv_font_t* font                 = &bin->font;
+    lv_font_fmt_txt_dsc_t* font_dsc = (lv_font_fmt_txt_dsc_t*)calloc(1, sizeof(lv_font_fmt_txt_dsc_t));
+    if(!font_dsc) {
+        return false;
+    }
 
     font->dsc = font_dsc;
 
     /* header */
-    int32_t header_length = read_label(fp, 0, "head");
-    if(header_length < 0) {
+    int32_t header_length = read_label(bin, 0, "head");
+    if(header_length < (int32_t)(8 + sizeof(font_header_bin_t))) {
         return false;
     }
 
     font_header_bin_t font_header;
-    if(lv_fs_read(fp, &font_header, sizeof(font_header_bin_t), NULL) != LV_FS_RES_OK) {
-        return false;
-    }
+    memcpy(&font_header, bin->data + 8, sizeof(font_header_bin_t));
 
     font->base_line           = -font_header.descent;
     font->line_height         = font_header.ascent - font_header.descent;
     font->get_glyph_dsc       = lv_font_get_glyph_dsc_fmt_txt;
-    font->get_glyph_bitmap    = lv_font_get_bitmap_fmt_txt;
+    font->get_glyph_bitmap    = bin->pages ? font_get_bitmap_paged : lv_font_get_bitmap_fmt_txt;
     font->subpx               = font_header.subpixels_mode;
     font->underline_position  = font_header.underline_position;
     font->underline_thickness = font_header.underline_thickness;
@@ -506,56 +942,33 @@ static bool lvgl_load_font(lv_fs_file_t* fp, lv_font_t* font)
 
     /* cmaps */
     uint32_t cmaps_start = header_length;
-    int32_t cmaps_length = load_cmaps(fp, font_dsc, cmaps_start);
+    int32_t cmaps_length = load_cmaps(bin, font_dsc, cmaps_start);
     if(cmaps_length < 0) {
         return false;
     }
 
     /* loca */
     uint32_t loca_start = cmaps_start + cmaps_length;
-    int32_t loca_length = read_label(fp, loca_start, "loca");
-    if(loca_length < 0) {
+    int32_t loca_length = read_label(bin, loca_start, "loca");
+    if(loca_length < 12) {
         return false;
     }
 
-    uint32_t loca_count;
-    if(lv_fs_read(fp, &loca_count, sizeof(uint32_t), NULL) != LV_FS_RES_OK) {
-        return false;
-    }
+    uint32_t loca_count = read_u32(bin->data + loca_start + 8);
 
-    bool failed            = false;
-    uint32_t* glyph_offset = (uint32_t*)malloc(sizeof(uint32_t) * (loca_count + 1));
-
-    /*TODO check NULL*/
-
-    if(font_header.index_to_loc_format == 0) {
-        for(unsigned int i = 0; i < loca_count; ++i) {
-            uint16_t offset;
-            if(lv_fs_read(fp, &offset, sizeof(uint16_t), NULL) != LV_FS_RES_OK) {
-                failed = true;
-                break;
-            }
-            glyph_offset[i] = offset;
-        }
-    } else if(font_header.index_to_loc_format == 1) {
-        if(lv_fs_read(fp, glyph_offset, loca_count * sizeof(uint32_t), NULL) != LV_FS_RES_OK) {
-            failed = true;
-        }
-    } else {
+    if(font_header.index_to_loc_format > 1) {
         LOG_WARNING(TAG_FONT, "Unknown index_to_loc_format: %d.", font_header.index_to_loc_format);
-        failed = true;
+        return false;
     }
-
-    if(failed) {
-        free(glyph_offset);
+    uint32_t loca_size = font_header.index_to_loc_format == 0 ? sizeof(uint16_t) : sizeof(uint32_t);
+    if(loca_count > (uint32_t)(loca_length - 12) / loca_size) {
         return false;
     }
 
     /* glyph */
     uint32_t glyph_start = loca_start + loca_length;
-    int32_t glyph_length = load_glyph(fp, font_dsc, glyph_start, glyph_offset, loca_count, &font_header);
-
-    free(glyph_offset);
+    int32_t glyph_length =
+        load_glyph(bin, font_dsc, glyph_start, bin->data + loca_start + 12, loca_count, &font_header);
 
     if(glyph_length < 0) {
         return false;
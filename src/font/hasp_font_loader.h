@@ -22,6 +22,15 @@ extern "C" {
  *      TYPEDEFS
  **********************/
 
+typedef struct
+{
+    uint32_t hits;   // glyph bitmaps found in the cache
+    uint32_t misses; // glyph bitmaps read from a file
+    uint32_t used;   // bytes of cache slots holding a glyph
+    uint32_t size;   // bytes of cache slots
+    uint16_t fonts;  // number of paged fonts
+} hasp_font_cache_stats_t;
+
 /**********************
  * GLOBAL PROTOTYPES
  **********************/
@@ -29,7 +38,10 @@ extern "C" {
 #if LV_USE_FILESYSTEM
 
 lv_font_t * hasp_font_load(const char * fontName);
+lv_font_t * hasp_font_load_data(const uint8_t * data, uint32_t size);
+lv_font_t * hasp_font_load_buffer(uint8_t * buffer, uint32_t size);
 void hasp_font_free(lv_font_t * font);
+void hasp_font_get_cache_stats(hasp_font_cache_stats_t * stats);
 
 #endif
 
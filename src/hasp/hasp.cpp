@@ -84,7 +84,8 @@ uint16_t haspThemeHue      = 200;
 lv_color_t color_primary   = lv_color_hsv_to_rgb(200, 100, 100);
 lv_color_t color_secondary = lv_color_hsv_to_rgb(200, 100, 100);
 
-char haspPagesPath[32] = "/pages.jsonl";
+char haspPagesPath[32]    = "/pages.jsonl";
+char haspPreloadFonts[64] = HASP_FONT_PRELOAD; // fonts read in the background while the pages are loaded
 char haspZiFontPath[32];
 
 lv_style_t style_mbox_bg; /*Black bg. style with opacity*/
@@ -347,6 +348,9 @@ void haspEverySecond()
 {
     hasp_update_sleep_state();
     dispatchEverySecond();
+#if HASP_LAZY_PAGES
+    haspPages.evict();
+#endif
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -598,7 +602,9 @@ void haspSetup(void)
 #endif
 
     hasp_init();
+    font_preload(haspPreloadFonts);
     hasp_load_json();
+    font_preload_finish();
     haspPages.set(haspStartPage, LV_SCR_LOAD_ANIM_NONE, 0, 0);
 
     // lv_obj_t* obj        = lv_datetime_create(haspPages.get_obj(haspPages.get()), NULL);
@@ -692,7 +698,9 @@ void haspClearPage(uint16_t pageid)
         LOG_WARNING(TAG_HASP, F(D_HASP_INVALID_LAYER));
     } else {
         LOG_TRACE(TAG_HASP, F(D_HASP_CLEAR_PAGE), pageid);
+        object_group_clear(pageid);
         lv_obj_clean(page);
+        object_index_clear(pageid);
     }
 }
 
@@ -750,6 +758,28 @@ void hasp_get_info(JsonDocument& doc)
     info[F("Idle")]        = size_buf;
     info[F("Active Page")] = haspPages.get();
 
+    uint32_t events_sent;
+    uint32_t events_coalesced;
+    event_get_counters(events_sent, events_coalesced);
+    info[F("Events Sent")]      = events_sent;
+    info[F("Events Coalesced")] = events_coalesced;
+
+    uint32_t frame_time;
+    uint32_t flush_wait;
+    gui_get_stats(frame_time, flush_wait);
+    info[F("Frame Time")] = std::to_string(frame_time) + " ms";
+    info[F("Flush Wait")] = std::to_string(flush_wait) + " ms";
+
+#if HASP_USE_DISPATCH_QUEUE > 0
+    uint32_t queue_depth;
+    uint32_t queue_latency;
+    uint32_t queue_dropped;
+    dispatch_queue_get_stats(queue_depth, queue_latency, queue_dropped);
+    info[F("Queue Depth")]   = std::to_string(queue_depth) + "/" + std::to_string(HASP_DISPATCH_QUEUE_SIZE);
+    info[F("Queue Latency")] = std::to_string(queue_latency) + " ms";
+    info[F("Queue Dropped")] = queue_dropped;
+#endif
+
     info = doc.createNestedObject(F(D_INFO_DEVICE_MEMORY));
     Parser::format_bytes(haspDevice.get_free_heap(), size_buf, sizeof(size_buf));
     info[F(D_INFO_FREE_HEAP)] = size_buf;
@@ -775,6 +805,56 @@ void hasp_get_info(JsonDocument& doc)
     Parser::format_bytes(mem_mon.free_size, size_buf, sizeof(size_buf));
     info[F(D_INFO_FREE_MEMORY)]   = size_buf;
     info[F(D_INFO_FRAGMENTATION)] = std::to_string(mem_mon.frag_pct) + "%";
+#elif HASP_USE_MEM_POOL > 0
+    info = doc.createNestedObject(F(D_INFO_LVGL_MEMORY));
+    hasp_pool_stats_t stats[8];
+    uint8_t count = hasp_pool_get_stats(stats, sizeof(stats) / sizeof(stats[0]));
+    for(uint8_t i = 0; i < count; i++) {
+        if(stats[i].block_size == 0) {
+            info[F("Pool Large")] = std::to_string(stats[i].used) + " blocks";
+            continue;
+        }
+        buffer       = "Pool " + std::to_string(stats[i].block_size);
+        info[buffer] = std::to_string(stats[i].used) + "/" + std::to_string(stats[i].total) + " blocks, " +
+                       std::to_string(stats[i].free_pct) + "% free";
+    }
+
+    size_t arena_size = 0;
+    for(uint8_t pageid = 0; pageid <= HASP_NUM_PAGES; pageid++) arena_size += hasp_arena_size(pageid);
+    Parser::format_bytes(arena_size, size_buf, sizeof(size_buf));
+    info[F("Page Metadata")] = size_buf;
+#endif
+
+#if LV_USE_FILESYSTEM > 0
+    hasp_font_cache_stats_t font_stats;
+    hasp_font_get_cache_stats(&font_stats);
+    if(font_stats.fonts > 0) {
+        info = doc.createNestedObject(F("Font Cache"));
+        Parser::format_bytes(font_stats.used, size_buf, sizeof(size_buf));
+        buffer = size_buf;
+        Parser::format_bytes(font_stats.size, size_buf, sizeof(size_buf));
+        uint32_t lookups       = font_stats.hits + font_stats.misses;
+        info[F("Glyph Cache")] = buffer + " / " + size_buf;
+        info[F("Hit Rate")]    = std::to_string(lookups ? (uint64_t)font_stats.hits * 100 / lookups : 0) + "%";
+        info[F("Misses")]      = font_stats.misses;
+        info[F("Paged Fonts")] = font_stats.fonts;
+    }
+#endif
+
+#if HASP_USE_FREETYPE > 0
+    lv_ft_cache_stats_t ft_stats;
+    lv_ft_get_cache_stats(&ft_stats);
+    if(ft_stats.slots > 0) {
+        info = doc.createNestedObject(F("FreeType Cache"));
+        Parser::format_bytes(ft_stats.used, size_buf, sizeof(size_buf));
+        buffer = size_buf;
+        Parser::format_bytes(ft_stats.size, size_buf, sizeof(size_buf));
+        uint32_t lookups         = ft_stats.hits + ft_stats.misses;
+        info[F("Glyph Bitmaps")] = buffer + " / " + size_buf;
+        info[F("Glyphs")]        = std::to_string(ft_stats.entries) + " / " + std::to_string(ft_stats.slots);
+        info[F("Hit Rate")]      = std::to_string(lookups ? (uint64_t)ft_stats.hits * 100 / lookups : 0) + "%";
+        info[F("Requests")]      = ft_stats.requests;
+    }
 #endif
 }
 
@@ -813,6 +893,9 @@ bool haspGetConfig(const JsonObject& settings)
     if(strcmp(haspPagesPath, settings[FPSTR(FP_CONFIG_PAGES)].as<String>().c_str()) != 0) changed = true;
     settings[FPSTR(FP_CONFIG_PAGES)] = haspPagesPath;
 
+    if(strcmp(haspPreloadFonts, settings[FPSTR(FP_CONFIG_PRELOAD)].as<String>().c_str()) != 0) changed = true;
+    settings[FPSTR(FP_CONFIG_PRELOAD)] = haspPreloadFonts;
+
     if(changed) configOutput(settings, TAG_HASP);
     return changed;
 }
@@ -861,6 +944,11 @@ bool haspSetConfig(const JsonObject& settings)
         strncpy(haspPagesPath, settings[FPSTR(FP_CONFIG_PAGES)], sizeof(haspPagesPath));
     }
 
+    if(!settings[FPSTR(FP_CONFIG_PRELOAD)].isNull()) {
+        changed |= strcmp(haspPreloadFonts, settings[FPSTR(FP_CONFIG_PRELOAD)]) != 0;
+        strncpy(haspPreloadFonts, settings[FPSTR(FP_CONFIG_PRELOAD)], sizeof(haspPreloadFonts) - 1);
+    }
+
     if(!settings[FPSTR(FP_CONFIG_ZIFONT)].isNull()) {
         changed |= strcmp(haspZiFontPath, settings[FPSTR(FP_CONFIG_ZIFONT)]) != 0;
         strncpy(haspZiFontPath, settings[FPSTR(FP_CONFIG_ZIFONT)], sizeof(haspZiFontPath));
@@ -22,6 +22,16 @@ extern const char* msgbox_default_map[];   // memory pointer to lvgl default btn
 extern const uint8_t rootca_crt_bundle_start[] asm("_binary_data_cert_x509_crt_bundle_bin_start");
 extern const uint8_t rootca_crt_bundle_end[] asm("_binary_data_cert_x509_crt_bundle_bin_end");
 
+// A square colorpicker is drawn as a disc, otherwise as a rectangle
+static void my_cpicker_update_type(lv_obj_t* obj)
+{
+    if(!obj_check_type(obj, LV_HASP_CPICKER)) return;
+#if LVGL_VERSION_MAJOR == 7
+    lv_cpicker_set_type(obj, lv_obj_get_width(obj) == lv_obj_get_height(obj) ? LV_CPICKER_TYPE_DISC
+                                                                             : LV_CPICKER_TYPE_RECT);
+#endif
+}
+
 void my_image_release_resources(lv_obj_t* obj)
 {
     if(!obj) return;
@@ -90,6 +100,7 @@ void my_msgbox_map_clear(lv_obj_t* obj)
 }
 
 // Create new btnmatrix button map from json array
+// The map is not in the page arena, the delete handler frees it with my_btnmatrix_map_clear()
 const char** my_map_create(const char* payload)
 {
     // Reserve memory for JsonDocument
@@ -321,13 +332,11 @@ static hasp_attribute_type_t hasp_process_cpicker_mode(lv_obj_t* obj, const char
     return HASP_ATTR_TYPE_NOT_FOUND;
 }
 
+// Returns the position of the trailing digits, or the string length if there are none
 size_t hasp_attribute_split_payload(const char* payload)
 {
-    size_t pos = 0;
-    while(*(payload + pos) != '\0') {
-        if(Parser::is_only_digits(payload + pos)) return pos;
-        pos++;
-    }
+    size_t pos = strlen(payload);
+    while(pos > 0 && isdigit(payload[pos - 1])) pos--;
     return pos;
 }
 
@@ -715,7 +724,8 @@ static hasp_attribute_type_t hasp_local_style_attr(lv_obj_t* obj, const char* at
     // test_prop(attr_hash);
 
     hasp_attribute_get_part_state(obj, attr_p, attr, part, state);
-    attr_hash = Parser::get_sdbm(attr); // attribute name without the index number
+    // attr_hash is still valid for the name without the index number, get_sdbm skips digits
+    if(attr[0] == '\0') return HASP_ATTR_TYPE_NOT_FOUND;
 
     /* ***** WARNING ****************************************************
      * when using hasp_out use attr_p for the original attribute name
@@ -879,14 +889,14 @@ static hasp_attribute_type_t hasp_local_style_attr(lv_obj_t* obj, const char* at
                 LOG_DEBUG(TAG_ATTR, "%s %d %x", __FILE__, __LINE__, font);
                 uint8_t count = 3;
                 if(obj_check_type(obj, LV_HASP_ROLLER)) count = my_roller_get_visible_row_count(obj);
-                lv_obj_set_style_local_text_font(obj, part, state, font);
+                my_obj_set_style_font(obj, part, state, LV_STYLE_TEXT_FONT, font);
                 if(obj_check_type(obj, LV_HASP_ROLLER)) lv_roller_set_visible_row_count(obj, count);
-                lv_obj_set_style_local_text_font(obj, part, state, font); // again, for roller
+                my_obj_set_style_font(obj, part, state, LV_STYLE_TEXT_FONT, font); // again, for roller
 
                 if(obj_check_type(obj, LV_HASP_DROPDOWN)) { // issue #43
-                    lv_obj_set_style_local_text_font(obj, LV_DROPDOWN_PART_MAIN, state, font);
-                    lv_obj_set_style_local_text_font(obj, LV_DROPDOWN_PART_LIST, state, font);
-                    lv_obj_set_style_local_text_font(obj, LV_DROPDOWN_PART_SELECTED, state, font);
+                    my_obj_set_style_font(obj, LV_DROPDOWN_PART_MAIN, state, LV_STYLE_TEXT_FONT, font);
+                    my_obj_set_style_font(obj, LV_DROPDOWN_PART_LIST, state, LV_STYLE_TEXT_FONT, font);
+                    my_obj_set_style_font(obj, LV_DROPDOWN_PART_SELECTED, state, LV_STYLE_TEXT_FONT, font);
                 };
 
             } else {
@@ -1019,7 +1029,7 @@ static hasp_attribute_type_t hasp_local_style_attr(lv_obj_t* obj, const char* at
         case ATTR_VALUE_FONT: {
             lv_font_t* font = haspPayloadToFont(payload);
             if(font) {
-                lv_obj_set_style_local_value_font(obj, part, state, font);
+                my_obj_set_style_font(obj, part, state, LV_STYLE_VALUE_FONT, font);
             } else {
                 LOG_WARNING(TAG_ATTR, F("Unknown Font ID %s"), attr_p);
             }
@@ -1757,10 +1767,12 @@ static hasp_attribute_type_t attribute_common_text(lv_obj_t* obj, uint16_t attr_
 
     for(int i = 0; i < sizeof(list) / sizeof(list[0]); i++) {
         if(obj_type == list[i].obj_type && attr_hash == list[i].hash) {
-            if(update)
+            if(update) {
+                font_prefetch_text(lv_obj_get_style_text_font(obj, LV_OBJ_PART_MAIN), payload);
                 list[i].set(obj, payload);
-            else
+            } else {
                 *text = (char*)list[i].get(obj);
+            }
 
             return HASP_ATTR_TYPE_STR;
         }
@@ -2356,17 +2368,31 @@ static hasp_attribute_type_t attribute_common_int(lv_obj_t* obj, uint16_t attr_h
 {
     switch(attr_hash) {
         case ATTR_ID:
-            if(update)
+            if(update) {
+                uint8_t pageid;
+                object_index_remove(obj);
                 obj->user_data.id = (uint8_t)val;
-            else
+                if(haspPages.get_id(obj, &pageid)) object_index_add(pageid, obj);
+            } else {
                 val = obj->user_data.id;
+            }
             break; // attribute_found
 
         case ATTR_GROUPID:
-            if(update)
+            if(update) {
+                object_group_remove(obj);
                 obj->user_data.groupid = (uint8_t)val;
-            else
+                object_group_add(obj);
+            } else {
                 val = obj->user_data.groupid;
+            }
+            break; // attribute_found
+
+        case ATTR_EVENT_RATE:
+            if(update)
+                my_obj_set_event_rate(obj, val);
+            else
+                val = my_obj_get_event_rate(obj);
             break; // attribute_found
 
         // case ATTR_TRANSITION:
@@ -2398,12 +2424,7 @@ static hasp_attribute_type_t attribute_common_int(lv_obj_t* obj, uint16_t attr_h
         case ATTR_W:
             if(update) {
                 lv_obj_set_width(obj, val);
-                if(obj_check_type(obj, LV_HASP_CPICKER)) {
-#if LVGL_VERSION_MAJOR == 7
-                    lv_cpicker_set_type(obj, lv_obj_get_width(obj) == lv_obj_get_height(obj) ? LV_CPICKER_TYPE_DISC
-                                                                                             : LV_CPICKER_TYPE_RECT);
-#endif
-                }
+                my_cpicker_update_type(obj);
             } else {
                 val = lv_obj_get_width(obj);
             }
@@ -2412,12 +2433,7 @@ static hasp_attribute_type_t attribute_common_int(lv_obj_t* obj, uint16_t attr_h
         case ATTR_H:
             if(update) {
                 lv_obj_set_height(obj, val);
-                if(obj_check_type(obj, LV_HASP_CPICKER)) {
-#if LVGL_VERSION_MAJOR == 7
-                    lv_cpicker_set_type(obj, lv_obj_get_width(obj) == lv_obj_get_height(obj) ? LV_CPICKER_TYPE_DISC
-                                                                                             : LV_CPICKER_TYPE_RECT);
-#endif
-                }
+                my_cpicker_update_type(obj);
             } else {
                 val = lv_obj_get_height(obj);
             }
@@ -2545,27 +2561,15 @@ void attr_out(lv_obj_t* obj, const char* attribute, const char* data, bool is_js
 
     if(!attribute || !hasp_find_id_from_obj(obj, &pageid, &objid)) return;
 
-    size_t len = 10;
-    if(data) {
-        len = strlen(data); // crashes if NULL
-    }
-
-    const size_t size = 32 + strlen(attribute) + len;
-    char payload[size];
-
-    {
-        StaticJsonDocument<64> doc; // Total (recommended) size for const char*
-        if(data)
-            if(is_json)
-                doc[attribute].set(serialized(data));
-            else
-                doc[attribute].set(data);
-        else
-            doc[attribute].set(nullptr);
-        serializeJson(doc, payload, size);
-    }
+    size_t len = is_json && data ? strlen(data) : JsonWriter::escaped_length(data);
+    JsonBuffer payload(8 + strlen(attribute) + len);
 
-    object_dispatch_state(pageid, objid, payload);
+    JsonWriter json(payload.data(), payload.size());
+    if(is_json)
+        json.add_json(attribute, data);
+    else
+        json.add(attribute, data);
+    if(const char* state = json.c_str()) object_dispatch_state(pageid, objid, state);
 }
 
 void attr_out_str(lv_obj_t* obj, const char* attribute, const char* data)
@@ -2580,9 +2584,15 @@ void attr_out_json(lv_obj_t* obj, const char* attribute, const char* data)
 
 void attr_out_int(lv_obj_t* obj, const char* attribute, int32_t val)
 {
-    char data[16];
-    itoa(val, data, DEC);
-    attr_out(obj, attribute, data, true);
+    uint8_t pageid;
+    uint8_t objid;
+
+    if(!attribute || !hasp_find_id_from_obj(obj, &pageid, &objid)) return;
+
+    JsonBuffer payload(20 + strlen(attribute));
+    JsonWriter json(payload.data(), payload.size());
+    json.add(attribute, val);
+    if(const char* state = json.c_str()) object_dispatch_state(pageid, objid, state);
 }
 
 void attr_out_bool(lv_obj_t* obj, const char* attribute, bool val)
@@ -2597,23 +2607,16 @@ void attr_out_color(lv_obj_t* obj, const char* attribute, lv_color_t color)
 
     if(!attribute || !hasp_find_id_from_obj(obj, &pageid, &objid)) return;
 
-    const size_t size = 64 + strlen(attribute);
-    char payload[size];
-    {
-        StaticJsonDocument<128> doc; // Total (recommended) size for const char*
-        char buffer[16];
-        lv_color32_t c32;
-
-        c32.full = lv_color_to32(color);
-        snprintf_P(buffer, sizeof(buffer), PSTR("#%02x%02x%02x"), c32.ch.red, c32.ch.green, c32.ch.blue);
-
-        doc[attribute].set(buffer);
-        doc["r"].set(c32.ch.red);
-        doc["g"].set(c32.ch.green);
-        doc["b"].set(c32.ch.blue);
-        serializeJson(doc, payload, size);
-    }
-    object_dispatch_state(pageid, objid, payload);
+    lv_color32_t c32;
+    c32.full = lv_color_to32(color);
+
+    JsonBuffer payload(48 + strlen(attribute));
+    JsonWriter json(payload.data(), payload.size());
+    json.add_color(attribute, c32);
+    json.add("r", c32.ch.red);
+    json.add("g", c32.ch.green);
+    json.add("b", c32.ch.blue);
+    if(const char* state = json.c_str()) object_dispatch_state(pageid, objid, state);
 }
 
 /**
@@ -2625,6 +2628,20 @@ void attr_out_color(lv_obj_t* obj, const char* attribute, lv_color_t color)
  * @note setting a value won't return anything, getting will dispatch the value
  */
 void hasp_process_obj_attribute(lv_obj_t* obj, const char* attribute, const char* payload, bool update)
+{
+    hasp_process_obj_attribute(obj, attribute, Parser::get_sdbm(attribute), payload, update);
+}
+
+/**
+ * Change or Retrieve the value of the attribute of an object
+ * @param obj lv_obj_t*: the object to get/set the attribute
+ * @param attribute char*: the attribute name (with or without leading ".")
+ * @param attr_hash uint16_t: the precomputed sdbm hash of the attribute name, e.g. from pages.bin
+ * @param payload char*: the new value of the attribute
+ * @param update  bool: change/set the value if true, dispatch/get value if false
+ */
+void hasp_process_obj_attribute(lv_obj_t* obj, const char* attribute, uint16_t attr_hash, const char* payload,
+                                bool update)
 {
     // unsigned long start = millis();
     if(!obj) return;
@@ -2634,7 +2651,6 @@ void hasp_process_obj_attribute(lv_obj_t* obj, const char* attribute, const char
     char temp_buffer[128]     = "";                       // buffer to hold return strings
     char* text                = &temp_buffer[0];          // pointer to temp_buffer
     hasp_attribute_type_t ret = HASP_ATTR_TYPE_NOT_FOUND; // the return code determines the attribute return value type
-    uint16_t attr_hash        = Parser::get_sdbm(attribute);
 
     switch(attr_hash) {
         case ATTR_GROUPID:
@@ -2648,6 +2664,7 @@ void hasp_process_obj_attribute(lv_obj_t* obj, const char* attribute, const char
         case ATTR_OPACITY:
         case ATTR_EXT_CLICK_H:
         case ATTR_EXT_CLICK_V:
+        case ATTR_EVENT_RATE:
             val = strtol(payload, nullptr, DEC);
             ret = attribute_common_int(obj, attr_hash, val, update);
             break;
@@ -21,6 +21,9 @@ void my_obj_set_swipe(lv_obj_t* obj, const char* tag);
 const char* my_obj_get_tag(lv_obj_t* obj);
 const char* my_obj_get_action(lv_obj_t* obj);
 const char* my_obj_get_swipe(lv_obj_t* obj);
+void my_obj_set_event_rate(lv_obj_t* obj, int32_t rate);
+uint16_t my_obj_get_event_rate(lv_obj_t* obj);
+void my_obj_release_fonts(lv_obj_t* obj);
 void my_btnmatrix_map_clear(lv_obj_t* obj);
 void my_msgbox_map_clear(lv_obj_t* obj);
 void my_line_clear_points(lv_obj_t* obj);
@@ -28,6 +31,8 @@ void my_image_release_resources(lv_obj_t* obj);
 void my_obj_del_task(const lv_obj_t* obj);
 
 void hasp_process_obj_attribute(lv_obj_t* obj, const char* attr_p, const char* payload, bool update);
+void hasp_process_obj_attribute(lv_obj_t* obj, const char* attr_p, uint16_t attr_hash, const char* payload,
+                                bool update);
 
 bool attribute_set_normalized_value(lv_obj_t* obj, hasp_update_value_t& value);
 
@@ -497,6 +502,7 @@ _HASP_ATTRIBUTE(SCALE_END_LINE_WIDTH, scale_end_line_width, lv_style_int_t)
 
 /* hasp user data */
 #define ATTR_ACTION 42102
+#define ATTR_EVENT_RATE 5861
 #define ATTR_TRANSITION 10933
 #define ATTR_GROUPID 48986
 #define ATTR_OBJID 41010
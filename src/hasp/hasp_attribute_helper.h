@@ -84,14 +84,22 @@ void my_obj_set_template(lv_obj_t* obj, const char* text)
         LOG_WARNING(TAG_ATTR, "Failed to allocate memory!");
 }
 
+// extended user_data lives in the arena of its page, the page object itself outlives clearpage
+static void* my_ext_alloc(lv_obj_t* obj, size_t size)
+{
+    uint8_t pageid;
+    if(!lv_obj_get_parent(obj) || !haspPages.get_id(obj, &pageid)) pageid = HASP_ARENA_NONE;
+    return hasp_arena_alloc(pageid, size);
+}
+
 // free the extended user_data when all properties are NULL
 static void my_prune_ext_tags(lv_obj_t* obj)
 {
     if(!obj || !obj->user_data.ext) return;
 
     hasp_ext_user_data_t* ext = (hasp_ext_user_data_t*)obj->user_data.ext;
-    if(!ext->action && !ext->swipe && !ext->tag) {
-        hasp_free(ext);
+    if(!ext->action && !ext->swipe && !ext->tag && !ext->fonts && !ext->event_rate && !ext->event_task) {
+        hasp_arena_free(ext);
         obj->user_data.ext = NULL;
     }
 }
@@ -99,7 +107,7 @@ static void my_prune_ext_tags(lv_obj_t* obj)
 // create extended user_data properties object
 static hasp_ext_user_data_t* my_create_ext_tags(lv_obj_t* obj)
 {
-    void* ext          = hasp_calloc(1, sizeof(hasp_ext_user_data_t));
+    void* ext          = my_ext_alloc(obj, sizeof(hasp_ext_user_data_t));
     obj->user_data.ext = ext;
     return (hasp_ext_user_data_t*)ext;
 }
@@ -110,7 +118,7 @@ void my_obj_set_tag(lv_obj_t* obj, const char* payload)
 
     // extended tag exists, free old tag
     if(ext && ext->tag) {
-        hasp_free(ext->tag);
+        hasp_arena_free(ext->tag);
         ext->tag = NULL;
     }
 
@@ -130,7 +138,7 @@ void my_obj_set_tag(lv_obj_t* obj, const char* payload)
         if(res != DeserializationError::Ok) doc.set(payload); // use tag as-is
 
         const size_t size = measureJson(doc) + 1;
-        if(char* str = (char*)hasp_malloc(size)) {
+        if(char* str = (char*)my_ext_alloc(obj, size)) {
             len      = serializeJson(doc, str, size); // tidy-up the json object
             ext->tag = str;
             LOG_VERBOSE(TAG_ATTR, "new json: %s", str);
@@ -160,7 +168,7 @@ void my_obj_set_action(lv_obj_t* obj, const char* payload)
 
     // extended tag exists, free old tag
     if(ext && ext->action) {
-        hasp_free(ext->action);
+        hasp_arena_free(ext->action);
         ext->action = NULL;
     }
 
@@ -210,7 +218,7 @@ void my_obj_set_action(lv_obj_t* obj, const char* payload)
         }
 
         const size_t size = measureJson(doc) + 1;
-        if(char* str = (char*)hasp_malloc(size)) {
+        if(char* str = (char*)my_ext_alloc(obj, size)) {
             size_t len  = serializeJson(doc, str, size); // tidy-up the json object
             ext->action = str;
             LOG_VERBOSE(TAG_ATTR, "new json: %s", str);
@@ -241,7 +249,7 @@ void my_obj_set_swipe(lv_obj_t* obj, const char* payload)
 
     // extended tag exists, free old tag if it's not the const _swipejson
     if(ext) {
-        if(ext->swipe != _swipejson) hasp_free((void*)ext->swipe);
+        if(ext->swipe != _swipejson) hasp_arena_free((void*)ext->swipe);
         ext->swipe = NULL;
     }
 
@@ -279,7 +287,7 @@ void my_obj_set_swipe(lv_obj_t* obj, const char* payload)
         }
 
         const size_t size = measureJson(doc) + 1;
-        if(char* str = (char*)hasp_malloc(size)) {
+        if(char* str = (char*)my_ext_alloc(obj, size)) {
             size_t len = serializeJson(doc, str, size); // tidy-up the json object
             ext->swipe = str;
             LOG_VERBOSE(TAG_ATTR, "new json: %s", str);
@@ -302,6 +310,93 @@ const char* my_obj_get_swipe(lv_obj_t* obj)
     return ext ? ext->swipe : NULL;
 }
 
+// the event rate is the coalescing window of changed events in ms
+void my_obj_set_event_rate(lv_obj_t* obj, int32_t rate)
+{
+    hasp_ext_user_data_t* ext = (hasp_ext_user_data_t*)obj->user_data.ext;
+    if(rate < 0) rate = 0;
+    if(rate > UINT16_MAX) rate = UINT16_MAX;
+
+    if(ext) {
+        ext->event_rate = rate;
+        if(!rate) my_prune_ext_tags(obj); // delete extended data if all extended properties are NULL
+    } else if(rate) {
+        ext = my_create_ext_tags(obj);
+        if(ext)
+            ext->event_rate = rate;
+        else
+            LOG_WARNING(TAG_ATTR, D_ERROR_OUT_OF_MEMORY);
+    }
+}
+
+uint16_t my_obj_get_event_rate(lv_obj_t* obj)
+{
+    if(!obj) return 0;
+    hasp_ext_user_data_t* ext = (hasp_ext_user_data_t*)obj->user_data.ext;
+    return ext ? ext->event_rate : 0;
+}
+
+// set a local text or value font, the object holds a reference on a loaded font for as long as it uses it
+static void my_obj_set_style_font(lv_obj_t* obj, uint8_t part, lv_state_t state, lv_style_property_t prop,
+                                  const lv_font_t* font)
+{
+    if(prop == LV_STYLE_VALUE_FONT)
+        lv_obj_set_style_local_value_font(obj, part, state, font);
+    else
+        lv_obj_set_style_local_text_font(obj, part, state, font);
+
+    hasp_ext_user_data_t* ext = (hasp_ext_user_data_t*)obj->user_data.ext;
+    hasp_font_ref_t** link    = ext ? &ext->fonts : NULL;
+    while(link && *link) {
+        hasp_font_ref_t* ref = *link;
+        if(ref->prop == prop && ref->part == part && ref->state == state) {
+            if(ref->font == font) return; // set again, for roller
+
+            font_release(ref->font);
+            if(font_retain(font)) {
+                ref->font = font;
+                return;
+            }
+            *link = ref->next; // a built-in font needs no reference
+            hasp_arena_free(ref);
+            my_prune_ext_tags(obj);
+            return;
+        }
+        link = &ref->next;
+    }
+
+    if(!font_retain(font)) return; // a built-in font needs no reference
+
+    if(!ext) ext = my_create_ext_tags(obj);
+    hasp_font_ref_t* ref = ext ? (hasp_font_ref_t*)my_ext_alloc(obj, sizeof(hasp_font_ref_t)) : NULL;
+    if(!ref) {
+        font_release(font);
+        LOG_WARNING(TAG_ATTR, D_ERROR_OUT_OF_MEMORY);
+        my_prune_ext_tags(obj);
+        return;
+    }
+    ref->font  = font;
+    ref->prop  = prop;
+    ref->part  = part;
+    ref->state = state;
+    ref->next  = ext->fonts;
+    ext->fonts = ref;
+}
+
+// drop the references on the fonts the object uses, so clearfont can unload them
+void my_obj_release_fonts(lv_obj_t* obj)
+{
+    hasp_ext_user_data_t* ext = (hasp_ext_user_data_t*)obj->user_data.ext;
+    if(!ext) return;
+
+    while(hasp_font_ref_t* ref = ext->fonts) {
+        ext->fonts = ref->next;
+        font_release(ref->font);
+        hasp_arena_free(ref);
+    }
+    my_prune_ext_tags(obj);
+}
+
 lv_label_align_t my_textarea_get_text_align(lv_obj_t* ta)
 {
     lv_textarea_ext_t* ext = (lv_textarea_ext_t*)lv_obj_get_ext_attr(ta);
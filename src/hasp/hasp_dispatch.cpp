@@ -42,8 +42,11 @@ dispatch_conf_t dispatch_setings = {.teleperiod = 300};
 uint16_t dispatchSecondsToNextTeleperiod = 0;
 uint16_t dispatchSecondsToNextSensordata = 0;
 uint16_t dispatchSecondsToNextDiscovery  = 0;
-uint8_t nCommands                        = 0;
-haspCommand_t commands[28];
+
+/* Commands are kept in an open addressing hash table, indexed by Parser::get_sdbm of the command name */
+static haspCommand_t* commands = NULL;
+static uint16_t nCommands      = 0;
+static uint16_t nCommandSlots  = 0; // power of 2
 
 moodlight_t moodlight    = {.brightness = 255};
 uint8_t saved_jsonl_page = 0;
@@ -305,6 +308,19 @@ static void dispatch_output(const char* topic, const char* payload)
 //     }
 // }
 
+// Find a command by name, commands are NOT case-sensitive
+static haspCommand_t* dispatch_find_command(const char* topic)
+{
+    if(!commands) return NULL;
+
+    uint16_t hash = Parser::get_sdbm(topic);
+    uint16_t mask = nCommandSlots - 1;
+    for(uint16_t i = hash & mask; commands[i].func; i = (i + 1) & mask) {
+        if(commands[i].hash == hash && !strcasecmp_P(topic, commands[i].p_cmdstr)) return &commands[i];
+    }
+    return NULL;
+}
+
 // objectattribute=value
 static void dispatch_command(const char* topic, const char* payload, bool update, uint8_t source)
 {
@@ -312,13 +328,10 @@ static void dispatch_command(const char* topic, const char* payload, bool update
 
     if(dispatch_parse_button_attribute(topic, payload, update)) return; // matched pxby.attr, first for speed
 
-    // check and execute commands from commands array
-    for(int i = 0; i < nCommands; i++) {
-        if(!strcasecmp_P(topic, commands[i].p_cmdstr)) {
-            // LOG_DEBUG(TAG_MSGR, F("Command %d found in array !!!"), i);
-            commands[i].func(topic, payload, source); /* execute command */
-            return;
-        }
+    // check and execute commands from the commands table
+    if(haspCommand_t* command = dispatch_find_command(topic)) {
+        command->func(topic, payload, source); /* execute command */
+        return;
     }
 
     /* =============================== Not standard payload commands ===================================== */
@@ -332,29 +345,6 @@ static void dispatch_command(const char* topic, const char* payload, bool update
         // } else if(strcasecmp_P(topic, PSTR("screenshot")) == 0) {
         //     guiTakeScreenshot("/screenshot.bmp"); // Literal String
 
-#if HASP_USE_CONFIG > 0
-
-#if HASP_USE_WIFI > 0
-    } else if(!strcmp_P(topic, FP_CONFIG_SSID) || !strcmp_P(topic, FP_CONFIG_PASS)) {
-        StaticJsonDocument<64> settings;
-        settings[topic] = payload;
-        wifiSetConfig(settings.as<JsonObject>());
-#endif // HASP_USE_WIFI
-
-#if HASP_USE_MQTT > 0
-    } else if(!strcmp_P(topic, PSTR("mqtthost")) || !strcmp_P(topic, PSTR("mqttport")) ||
-              !strcmp_P(topic, PSTR("mqttuser")) || !strcmp_P(topic, PSTR("mqttpass")) ||
-              !strcmp_P(topic, PSTR("hostname"))) {
-        // char item[5];
-        // memset(item, 0, sizeof(item));
-        // strncpy(item, topic + 4, 4);
-
-        StaticJsonDocument<64> settings;
-        settings[topic + 4] = payload;
-        mqttSetConfig(settings.as<JsonObject>());
-#endif // HASP_USE_MQTT
-
-#endif // HASP_USE_CONFIG
     } else {
         if(strlen(payload) == 0) {
             //    dispatch_simple_text_command(topic); // Could cause an infinite loop!
@@ -387,34 +377,19 @@ static void dispatch_simple_text_command(const char* cmnd, uint8_t source)
             //     break;
 
         default: {
-            size_t pos1 = std::string(cmnd).find("=");
-            size_t pos2 = std::string(cmnd).find(" ");
-            size_t pos  = 0;
-            bool update = false;
-
             // Find what comes first, ' ' or '='
-            if(pos1 != std::string::npos) {     // '=' found
-                if(pos2 != std::string::npos) { // ' ' found
-                    pos = (pos1 < pos2 ? pos1 : pos2);
-                } else {
-                    pos = pos1;
-                }
-                update = pos == pos1; // equal sign wins
-
-            } else {
-                pos = (pos2 != std::string::npos) ? pos2 : 0;
-            }
+            size_t pos  = strcspn(cmnd, "= ");
+            bool update = cmnd[pos] == '='; // equal sign wins
+            if(cmnd[pos] == '\0') pos = 0;  // no ' ' or '=' found
 
             if(pos > 0) { // ' ' or '=' found
                 char topic[64];
-                memset(topic, 0, sizeof(topic));
-                if(pos < sizeof(topic))
-                    memcpy(topic, cmnd, pos);
-                else
-                    memcpy(topic, cmnd, sizeof(topic) - 1);
+                size_t len = pos < sizeof(topic) ? pos : sizeof(topic) - 1;
+                memcpy(topic, cmnd, len);
+                topic[len] = '\0';
 
                 // topic is before '=', payload is after '=' position
-                update |= strlen(cmnd + pos + 1) > 0; // equal sign OR space with payload
+                update |= cmnd[pos + 1] != '\0'; // equal sign OR space with payload
                 LOG_TRACE(TAG_MSGR, update ? F("%s=%s") : F("%s%s"), topic, cmnd + pos + 1);
                 dispatch_topic_payload(topic, cmnd + pos + 1, update, source);
             } else {
@@ -727,6 +702,151 @@ void dispatch_parse_json(const char*, const char* payload, uint8_t source)
     }
 }
 
+/* ===== JSONL loader ===== */
+
+#ifndef JSONL_BUFFER_SIZE
+#define JSONL_BUFFER_SIZE (2 * MQTT_MAX_PACKET_SIZE) // also the maximum length of a single json object
+#endif
+
+typedef struct
+{
+    uint16_t line;
+    uint8_t pageid;   // page currently being built
+    uint16_t objects; // objects created on that page
+    uint32_t time;    // milliseconds spent on that page
+} jsonl_stats_t;
+
+static void jsonl_stats_log(jsonl_stats_t& stats)
+{
+    if(stats.objects == 0) return;
+    LOG_VERBOSE(TAG_MSGR, F("Page %u: %u objects in %u ms"), stats.pageid, stats.objects, stats.time);
+}
+
+static void jsonl_stats_add(jsonl_stats_t& stats, uint8_t pageid, uint32_t time)
+{
+    if(pageid != stats.pageid) {
+        jsonl_stats_log(stats);
+        stats.pageid  = pageid;
+        stats.objects = 0;
+        stats.time    = 0;
+    }
+    stats.objects++;
+    stats.time += time;
+}
+
+// Returns the length of the json object at the start of the buffer, or 0 if it is not complete yet
+static size_t jsonl_object_length(const char* buffer, size_t len)
+{
+    bool in_string = false;
+    bool escaped   = false;
+    int depth      = 0;
+
+    for(size_t i = 0; i < len; i++) {
+        char c = buffer[i];
+        if(in_string) {
+            if(escaped)
+                escaped = false;
+            else if(c == '\\')
+                escaped = true;
+            else if(c == '"')
+                in_string = false;
+        } else if(c == '"') {
+            in_string = true;
+        } else if(c == '{' || c == '[') {
+            depth++;
+        } else if(c == '}' || c == ']') {
+            if(--depth <= 0) return i + 1;
+        } else if(c == '\n' && depth == 0) {
+            return i + 1; // not an object, let the parser report the error
+        }
+    }
+    return 0;
+}
+
+// Parses all complete json objects in place and returns the number of bytes consumed
+// Strings are not copied into the document, so it only holds the nodes of a single object
+static size_t jsonl_parse_buffer(JsonDocument& jsonl, char* buffer, size_t len, bool eof, uint8_t& saved_page_id,
+                                 jsonl_stats_t& stats, DeserializationError& error)
+{
+    size_t pos = 0;
+
+    while(pos < len && !error) {
+        if(isspace(buffer[pos])) {
+            if(buffer[pos] == '\n') stats.line++;
+            pos++;
+            continue;
+        }
+
+        size_t size = jsonl_object_length(buffer + pos, len - pos);
+        if(size == 0) {
+            if(!eof) break; // wait for more data
+            size = len - pos;
+        }
+
+        uint16_t lines = 0; // count before parsing, the parser modifies the buffer
+        for(size_t i = pos; i < pos + size; i++)
+            if(buffer[i] == '\n') lines++;
+
+        uint32_t start = millis();
+        error          = deserializeJson(jsonl, buffer + pos, size); // resets the document
+        if(error) break; // stats.line still points to the start of the failed object
+
+        hasp_new_object(jsonl.as<JsonObject>(), saved_page_id);
+        jsonl_stats_add(stats, saved_page_id, millis() - start);
+        stats.line += lines;
+        pos += size;
+    }
+
+    return pos;
+}
+
+#ifdef ARDUINO
+static size_t jsonl_read(Stream& stream, char* buffer, size_t len)
+{
+    size_t count = 0;
+    while(count < len) {
+        int available = stream.available(); // don't wait for the stream timeout at the end of the file
+        if(available <= 0) break;
+
+        size_t bytes = stream.readBytes(buffer + count, min(len - count, (size_t)available));
+        if(bytes == 0) break;
+        count += bytes;
+    }
+    return count;
+}
+#else
+static size_t jsonl_read(std::istream& stream, char* buffer, size_t len)
+{
+    stream.read(buffer, len);
+    return stream.gcount();
+}
+#endif
+
+static void jsonl_parse_end(jsonl_stats_t& stats, DeserializationError& error, uint8_t& saved_page_id)
+{
+    jsonl_stats_log(stats);
+
+    if(!error) {
+        LOG_DEBUG(TAG_MSGR, F(D_JSONL_SUCCEEDED));
+    } else {
+        LOG_ERROR(TAG_MSGR, F(D_JSONL_FAILED ": %s"), stats.line, error.c_str());
+    }
+
+    saved_jsonl_page = saved_page_id;
+}
+
+// Parses a writable buffer containing jsonl in place, e.g. a memory mapped pages file
+void dispatch_parse_jsonl(char* buffer, size_t len, uint8_t& saved_page_id)
+{
+    DynamicJsonDocument jsonl(MQTT_MAX_PACKET_SIZE / 2 + 128);
+    DeserializationError error = DeserializationError::Ok;
+    jsonl_stats_t stats        = {.line = 1, .pageid = saved_page_id, .objects = 0, .time = 0};
+
+    jsonl_parse_buffer(jsonl, buffer, len, true, saved_page_id, stats, error);
+    jsonl_parse_end(stats, error, saved_page_id);
+}
+
+// Reads the stream in blocks and parses every json object in place in the block buffer
 #ifdef ARDUINO
 void dispatch_parse_jsonl(Stream& stream, uint8_t& saved_page_id)
 #else
@@ -737,36 +857,35 @@ void dispatch_parse_jsonl(std::istream& stream, uint8_t& saved_page_id)
     stream.setTimeout(25);
 #endif
 
-    // StaticJsonDocument<1024> jsonl;
-    DynamicJsonDocument jsonl(MQTT_MAX_PACKET_SIZE / 2 + 128);
-    DeserializationError jsonError; // = deserializeJson(jsonl, stream);
-    uint16_t line = 1;
-
-    // while(jsonError == DeserializationError::Ok) {
-    //     hasp_new_object(jsonl.as<JsonObject>(), saved_page_id);
-    //     jsonError = deserializeJson(jsonl, stream);
-    //     line++;
-    // }
+    char* buffer = (char*)hasp_malloc(JSONL_BUFFER_SIZE);
+    if(!buffer) {
+        LOG_ERROR(TAG_MSGR, F(D_ERROR_OUT_OF_MEMORY));
+        return;
+    }
 
-    while(1) {
-        jsonError = deserializeJson(jsonl, stream);
-        if(jsonError == DeserializationError::Ok) {
-            hasp_new_object(jsonl.as<JsonObject>(), saved_page_id);
-            line++;
-        } else {
+    DynamicJsonDocument jsonl(MQTT_MAX_PACKET_SIZE / 2 + 128);
+    DeserializationError error = DeserializationError::Ok;
+    jsonl_stats_t stats        = {.line = 1, .pageid = saved_page_id, .objects = 0, .time = 0};
+    size_t len                 = 0;
+    bool eof                   = false;
+
+    while(!eof && !error) {
+        if(len >= JSONL_BUFFER_SIZE) {
+            error = DeserializationError::NoMemory; // a single object does not fit in the buffer
             break;
         }
-    };
 
-    /* For debugging purposes */
-    if(jsonError == DeserializationError::EmptyInput) {
-        LOG_DEBUG(TAG_MSGR, F(D_JSONL_SUCCEEDED));
+        size_t bytes = jsonl_read(stream, buffer + len, JSONL_BUFFER_SIZE - len);
+        eof          = (bytes == 0);
+        len += bytes;
 
-    } else {
-        LOG_ERROR(TAG_MSGR, F(D_JSONL_FAILED ": %s"), line, jsonError.c_str());
+        size_t used = jsonl_parse_buffer(jsonl, buffer, len, eof, saved_page_id, stats, error);
+        len -= used;
+        if(len > 0 && used > 0) memmove(buffer, buffer + used, len); // keep the incomplete object
     }
 
-    saved_jsonl_page = saved_page_id;
+    hasp_free(buffer);
+    jsonl_parse_end(stats, error, saved_page_id);
 }
 
 void dispatch_parse_jsonl(const char*, const char* payload, uint8_t source)
@@ -1009,7 +1128,7 @@ void dispatch_clear_page(const char*, const char* page, uint8_t source)
     haspPages.clear(pageid);
 }
 
-// Clears all fonts
+// Clears all pages and unloads the fonts that no object uses anymore
 void dispatch_clear_font(const char*, const char* payload, uint8_t source)
 {
     dispatch_clear_page(NULL, "all", source);
@@ -1211,7 +1330,7 @@ void dispatch_reboot(bool saveConfig)
     LOG_TRACE(TAG_MSGR, F(D_DISPATCH_REBOOT));
 
 #if HASP_TARGET_PC
-    fflush(stdout);
+    debugStop(); // write the queued log lines
 #else
     Serial.flush();
 #endif
@@ -1558,17 +1677,89 @@ void dispatch_service(const char*, const char* payload, uint8_t source)
 #endif
 }
 
+/* Change the runtime log level of a tag, i.e. "loglevel MQTT 4" or "loglevel all 6" */
+static void dispatch_log_level(const char*, const char* payload, uint8_t source)
+{
+    char name[8];
+    int level = LOG_LEVEL_DEBUG;
+    if(sscanf(payload, "%7s %d", name, &level) < 1) return;
+
+    int16_t tag = debugGetTagId(name);
+    if(tag < 0) return LOG_WARNING(TAG_MSGR, F("Unknown log tag %s"), name);
+
+    debugSetTagLevel(tag, level);
+    LOG_INFO(TAG_MSGR, F("Log level of %s set to %d"), name, level);
+}
+
 /******************************************* Commands builder *******************************************/
 
-static void dispatch_add_command(const char* p_cmdstr, void (*func)(const char*, const char*, uint8_t))
+#if HASP_USE_CONFIG > 0
+#if HASP_USE_WIFI > 0
+static void dispatch_config_wifi(const char* topic, const char* payload, uint8_t source)
 {
-    if(nCommands >= sizeof(commands) / sizeof(haspCommand_t)) {
-        LOG_FATAL(TAG_MSGR, F("CMD_OVERFLOW %d"), nCommands); // Needs to be in curly braces
-    } else {
-        commands[nCommands].p_cmdstr = p_cmdstr;
-        commands[nCommands].func     = func;
-        nCommands++;
+    StaticJsonDocument<64> settings;
+    settings[topic] = payload;
+    wifiSetConfig(settings.as<JsonObject>());
+}
+#endif // HASP_USE_WIFI
+
+#if HASP_USE_MQTT > 0
+static void dispatch_config_mqtt(const char* topic, const char* payload, uint8_t source)
+{
+    StaticJsonDocument<64> settings;
+    settings[topic + 4] = payload;
+    mqttSetConfig(settings.as<JsonObject>());
+}
+#endif // HASP_USE_MQTT
+#endif // HASP_USE_CONFIG
+
+static void dispatch_insert_command(haspCommand_t* table, uint16_t slots, const haspCommand_t& command)
+{
+    uint16_t mask = slots - 1;
+    uint16_t i    = command.hash & mask;
+    while(table[i].func) i = (i + 1) & mask;
+    table[i] = command;
+}
+
+/**
+ * Register a command, can also be used by custom code to add commands at runtime
+ * @param p_cmdstr name of the command, can be stored in flash and must stay valid
+ * @param func the function to execute, receives the full topic and payload
+ * @return true if the command was added or replaced
+ */
+bool dispatch_add_command(const char* p_cmdstr, void (*func)(const char*, const char*, uint8_t))
+{
+    if(!p_cmdstr || !func) return false;
+
+    char name[64] = ""; // the name can be stored in flash
+    strncpy_P(name, p_cmdstr, sizeof(name) - 1);
+
+    /* Replace an existing command */
+    if(haspCommand_t* command = dispatch_find_command(name)) {
+        command->func = func;
+        return true;
     }
+
+    /* Keep the table at most 3/4 full */
+    if((nCommands + 1) * 4 > nCommandSlots * 3) {
+        uint16_t slots       = nCommandSlots ? nCommandSlots * 2 : 32;
+        haspCommand_t* table = (haspCommand_t*)hasp_calloc(slots, sizeof(haspCommand_t));
+        if(!table) {
+            LOG_FATAL(TAG_MSGR, F("CMD_OVERFLOW %d"), nCommands); // Needs to be in curly braces
+            return false;
+        }
+
+        for(uint16_t i = 0; i < nCommandSlots; i++)
+            if(commands[i].func) dispatch_insert_command(table, slots, commands[i]);
+        hasp_free(commands);
+        commands      = table;
+        nCommandSlots = slots;
+    }
+
+    dispatch_insert_command(commands, nCommandSlots,
+                            {.p_cmdstr = p_cmdstr, .func = func, .hash = Parser::get_sdbm(name)});
+    nCommands++;
+    return true;
 }
 
 void dispatchSetup()
@@ -1578,7 +1769,10 @@ void dispatchSetup()
 
     LOG_TRACE(TAG_MSGR, F(D_SERVICE_STARTING));
 
-    /* WARNING: remember to expand the commands array when adding new commands */
+#if HASP_USE_DISPATCH_QUEUE > 0
+    dispatch_queue_init();
+#endif
+
     dispatch_add_command(PSTR("json"), dispatch_parse_json);
     dispatch_add_command(PSTR("jsonl"), dispatch_parse_jsonl);
     dispatch_add_command(PSTR("page"), dispatch_page);
@@ -1604,6 +1798,7 @@ void dispatchSetup()
     dispatch_add_command(PSTR("screenshot"), dispatch_screenshot);
     dispatch_add_command(PSTR("discovery"), dispatch_queue_discovery);
     dispatch_add_command(PSTR("factoryreset"), dispatch_factory_reset);
+    dispatch_add_command(PSTR("loglevel"), dispatch_log_level);
 
     /* obsolete commands */
     // dispatch_add_command(PSTR("dim"), dispatch_backlight_obsolete);
@@ -1619,11 +1814,184 @@ void dispatchSetup()
 #if HASP_USE_CONFIG > 0 && HASP_TARGET_ARDUINO
     dispatch_add_command(PSTR("setupap"), oobeFakeSetup);
 #endif
-    /* WARNING: remember to expand the commands array when adding new commands */
+
+    /* config settings */
+#if HASP_USE_CONFIG > 0
+#if HASP_USE_WIFI > 0
+    dispatch_add_command(FP_CONFIG_SSID, dispatch_config_wifi);
+    dispatch_add_command(FP_CONFIG_PASS, dispatch_config_wifi);
+#endif
+#if HASP_USE_MQTT > 0
+    dispatch_add_command(PSTR("mqtthost"), dispatch_config_mqtt);
+    dispatch_add_command(PSTR("mqttport"), dispatch_config_mqtt);
+    dispatch_add_command(PSTR("mqttuser"), dispatch_config_mqtt);
+    dispatch_add_command(PSTR("mqttpass"), dispatch_config_mqtt);
+    dispatch_add_command(PSTR("hostname"), dispatch_config_mqtt);
+#endif
+#endif
 
     LOG_INFO(TAG_MSGR, F(D_SERVICE_STARTED));
 }
 
+/******************************************* Command queue *******************************************/
+
+#if HASP_USE_DISPATCH_QUEUE > 0
+#include <atomic>
+#include "hasp_gui.h" // for gui_wake
+
+#ifdef MQTT_MAX_PACKET_SIZE
+#define DISPATCH_QUEUE_TEXT_SIZE MQTT_MAX_PACKET_SIZE
+#else
+#define DISPATCH_QUEUE_TEXT_SIZE 1024
+#endif
+#define DISPATCH_QUEUE_MASK (HASP_DISPATCH_QUEUE_SIZE - 1)
+
+static_assert((HASP_DISPATCH_QUEUE_SIZE & DISPATCH_QUEUE_MASK) == 0, "HASP_DISPATCH_QUEUE_SIZE must be a power of 2");
+
+enum dispatch_queue_kind_t : uint8_t {
+    DISPATCH_QUEUE_TOPIC_PAYLOAD, // text holds topic + '\0' + payload for dispatch_topic_payload()
+    DISPATCH_QUEUE_TEXT_LINE,     // text holds a line for dispatch_text_line()
+    DISPATCH_QUEUE_CURRENT_STATE, // no text, run dispatch_current_state()
+};
+
+/* One preallocated record, the sequence number tells whether it is free or holds a command */
+struct dispatch_queue_slot_t
+{
+    std::atomic<uint32_t> sequence;
+    uint32_t posted; // millis() when the command was posted
+    uint8_t source;
+    dispatch_queue_kind_t kind;
+    char text[DISPATCH_QUEUE_TEXT_SIZE]; // topic + '\0' + payload + '\0'
+};
+
+/* Bounded lock-free queue: any thread can post, only the thread running lvgl drains it */
+static dispatch_queue_slot_t dispatch_queue[HASP_DISPATCH_QUEUE_SIZE];
+static std::atomic<uint32_t> dispatch_queue_head(0); // next slot to post to
+static uint32_t dispatch_queue_tail = 0;             // next slot to drain, owned by the consumer
+
+static struct
+{
+    std::atomic<uint32_t> dropped;
+    uint32_t max_depth;   // since the last dispatch_queue_get_stats()
+    uint32_t max_latency; // ms between posting and dispatching
+} dispatch_queue_stats;
+
+static void dispatch_queue_init()
+{
+    for(uint32_t i = 0; i < HASP_DISPATCH_QUEUE_SIZE; i++) {
+        dispatch_queue[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    dispatch_queue_head.store(0, std::memory_order_release);
+    dispatch_queue_tail = 0;
+}
+
+static bool dispatch_queue_push(dispatch_queue_kind_t kind, const char* topic, const char* payload, uint8_t source)
+{
+    size_t topic_len   = topic ? strlen(topic) + 1 : 0;
+    size_t payload_len = payload ? strlen(payload) + 1 : 0;
+    if(topic_len + payload_len > DISPATCH_QUEUE_TEXT_SIZE) {
+        LOG_ERROR(TAG_MSGR, F(D_MQTT_PAYLOAD_TOO_LONG), (uint32_t)(topic_len + payload_len));
+        return false;
+    }
+
+    /* Claim a free slot, retry while the GUI thread is busy draining */
+    dispatch_queue_slot_t* slot;
+    uint32_t pos  = dispatch_queue_head.load(std::memory_order_relaxed);
+    uint8_t retry = 0;
+    for(;;) {
+        slot         = &dispatch_queue[pos & DISPATCH_QUEUE_MASK];
+        int32_t diff = (int32_t)(slot->sequence.load(std::memory_order_acquire) - pos);
+
+        if(diff == 0) {
+            if(dispatch_queue_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if(diff < 0) {
+            if(++retry > 100) {
+                dispatch_queue_stats.dropped++;
+                LOG_ERROR(TAG_MSGR, F("Command queue full, dropped %s"),
+                          topic ? topic : (payload ? payload : "current state"));
+                return false;
+            }
+            gui_wake();
+            delay(1);
+            pos = dispatch_queue_head.load(std::memory_order_relaxed);
+        } else {
+            pos = dispatch_queue_head.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->posted    = millis();
+    slot->source    = source;
+    slot->kind      = kind;
+    if(topic) memcpy(slot->text, topic, topic_len);
+    if(payload) memcpy(slot->text + topic_len, payload, payload_len);
+    slot->sequence.store(pos + 1, std::memory_order_release); // publish the record
+
+    gui_wake();
+    return true;
+}
+
+/* Run the command on the GUI thread, returns false if the queue is full */
+bool dispatch_queue_topic_payload(const char* topic, const char* payload, uint8_t source)
+{
+    return dispatch_queue_push(DISPATCH_QUEUE_TOPIC_PAYLOAD, topic, payload, source);
+}
+
+/* Run dispatch_text_line on the GUI thread, returns false if the queue is full */
+bool dispatch_queue_text_line(const char* cmnd, uint8_t source)
+{
+    return dispatch_queue_push(DISPATCH_QUEUE_TEXT_LINE, NULL, cmnd, source);
+}
+
+/* Run dispatch_current_state on the GUI thread, returns false if the queue is full */
+bool dispatch_queue_current_state(uint8_t source)
+{
+    return dispatch_queue_push(DISPATCH_QUEUE_CURRENT_STATE, NULL, NULL, source);
+}
+
+/* Dispatch the queued commands in order, called by the thread running lvgl */
+IRAM_ATTR void dispatch_queue_drain(void)
+{
+    uint32_t depth = dispatch_queue_head.load(std::memory_order_relaxed) - dispatch_queue_tail;
+    if(depth == 0) return;
+    if(depth > dispatch_queue_stats.max_depth) dispatch_queue_stats.max_depth = depth;
+
+    /* Only drain one queue length, commands posted meanwhile wait for the next call */
+    for(uint32_t i = 0; i < HASP_DISPATCH_QUEUE_SIZE; i++) {
+        dispatch_queue_slot_t* slot = &dispatch_queue[dispatch_queue_tail & DISPATCH_QUEUE_MASK];
+        if(slot->sequence.load(std::memory_order_acquire) != dispatch_queue_tail + 1) break; // empty
+
+        uint32_t latency = millis() - slot->posted;
+        if(latency > dispatch_queue_stats.max_latency) dispatch_queue_stats.max_latency = latency;
+
+        switch(slot->kind) {
+            case DISPATCH_QUEUE_TEXT_LINE:
+                dispatch_text_line(slot->text, slot->source);
+                break;
+            case DISPATCH_QUEUE_CURRENT_STATE:
+                dispatch_current_state(slot->source);
+                break;
+            default: {
+                const char* payload = slot->text + strlen(slot->text) + 1;
+                dispatch_topic_payload(slot->text, payload, *payload != '\0', slot->source);
+            }
+        }
+
+        slot->sequence.store(dispatch_queue_tail + HASP_DISPATCH_QUEUE_SIZE, std::memory_order_release); // free
+        dispatch_queue_tail++;
+    }
+}
+
+/* Peak queue depth and latency since the previous call, and the total number of dropped commands */
+void dispatch_queue_get_stats(uint32_t& max_depth, uint32_t& max_latency, uint32_t& dropped)
+{
+    max_depth                        = dispatch_queue_stats.max_depth;
+    max_latency                      = dispatch_queue_stats.max_latency;
+    dropped                          = dispatch_queue_stats.dropped;
+    dispatch_queue_stats.max_depth   = 0;
+    dispatch_queue_stats.max_latency = 0;
+}
+#endif // HASP_USE_DISPATCH_QUEUE
+
 IRAM_ATTR void dispatchLoop()
 {
     // UBaseType_t msg_count = uxQueueMessagesWaiting(message_queue));
@@ -56,13 +56,24 @@ void dispatchStop(void);
 
 /* ===== Special Event Processors ===== */
 void dispatch_topic_payload(const char* topic, const char* payload, bool update, uint8_t source);
+bool dispatch_add_command(const char* p_cmdstr, void (*func)(const char*, const char*, uint8_t));
 void dispatch_text_line(const char* cmnd, uint8_t source);
 
+/* ===== Thread-safe Command Queue ===== */
+#if HASP_USE_DISPATCH_QUEUE > 0
+bool dispatch_queue_topic_payload(const char* topic, const char* payload, uint8_t source);
+bool dispatch_queue_text_line(const char* cmnd, uint8_t source);
+bool dispatch_queue_current_state(uint8_t source);
+IRAM_ATTR void dispatch_queue_drain(void);
+void dispatch_queue_get_stats(uint32_t& max_depth, uint32_t& max_latency, uint32_t& dropped);
+#endif
+
 #ifdef ARDUINO
 void dispatch_parse_jsonl(Stream& stream, uint8_t& saved_page_id);
 #else
 void dispatch_parse_jsonl(std::istream& stream, uint8_t& saved_page_id);
 #endif
+void dispatch_parse_jsonl(char* buffer, size_t len, uint8_t& saved_page_id);
 bool dispatch_json_variant(JsonVariant& json, uint8_t& savedPage, uint8_t source);
 
 void dispatch_clear_page(const char* page);
@@ -109,6 +120,7 @@ struct haspCommand_t
 {
     const char* p_cmdstr;
     void (*func)(const char*, const char*, uint8_t);
+    uint16_t hash; // Parser::get_sdbm of p_cmdstr
 };
 
 #endif
\ No newline at end of file
@@ -33,8 +33,27 @@ static lv_style_int_t last_value_sent;
 static lv_obj_t* last_obj_sent = NULL;
 static lv_color_t last_color_sent;
 
+/* Changed events of an object with an event_rate are coalesced, only the latest value is sent per window.
+ * The window and the held back event are kept per object, in its extended user data. */
+static struct
+{
+    lv_obj_t* flushing; // object whose held back event is being sent
+    uint32_t sent;      // number of events sent
+    uint32_t coalesced; // number of changed events that were replaced by a later one
+} event_rate_limit;
+
 void swipe_event_handler(lv_obj_t* obj, lv_event_t event);
 
+// Drop the changed event held back for an object
+static void event_rate_limit_cancel(lv_obj_t* obj)
+{
+    hasp_ext_user_data_t* ext = (hasp_ext_user_data_t*)obj->user_data.ext;
+    if(!ext || !ext->event_task) return;
+
+    lv_task_del(ext->event_task);
+    ext->event_task = NULL;
+}
+
 // resets the last_value_sent
 void event_reset_last_value_sent()
 {
@@ -42,6 +61,12 @@ void event_reset_last_value_sent()
     last_value_sent = INT16_MIN;
 }
 
+void event_get_counters(uint32_t& sent, uint32_t& coalesced)
+{
+    sent      = event_rate_limit.sent;
+    coalesced = event_rate_limit.coalesced;
+}
+
 void script_event_handler(const char* eventname, const char* json)
 {
     StaticJsonDocument<256> doc;
@@ -107,9 +132,14 @@ void delete_event_handler(lv_obj_t* obj, lv_event_t event)
         my_obj_set_value_str_text(obj, part, LV_STATE_DISABLED + LV_STATE_DEFAULT, NULL);
         my_obj_set_value_str_text(obj, part, LV_STATE_DISABLED + LV_STATE_CHECKED, NULL);
     }
+    my_obj_release_fonts(obj);
+    event_rate_limit_cancel(obj);
     my_obj_set_tag(obj, (char*)NULL);
     my_obj_set_action(obj, (char*)NULL);
     my_obj_set_swipe(obj, (char*)NULL);
+    my_obj_set_event_rate(obj, 0);
+    object_index_remove(obj);
+    object_group_remove(obj);
 }
 
 /* ============================== Timer Event  ============================ */
@@ -211,6 +241,15 @@ void event_timer_refresh(lv_task_t* task)
    Then sends the data out on the state/pxby topic
 */
 
+// A value set by touch is not in the pages file, keep the page of the object in memory
+static inline void event_pin_page(lv_obj_t* obj)
+{
+#if HASP_LAZY_PAGES
+    uint8_t pageid;
+    if(haspPages.get_id(obj, &pageid)) haspPages.pin(pageid);
+#endif
+}
+
 /**
  * Get the hasp eventid for LV_EVENT_PRESSED, LV_EVENT_VALUE_CHANGED, LV_EVENT_LONG_PRESSED_REPEAT and
  * LV_EVENT_RELEASED Also updates the sleep state and handles LV_EVENT_DELETE events
@@ -241,10 +280,12 @@ static bool translate_event(lv_obj_t* obj, lv_event_t event, uint8_t& eventid)
             return true;
 
         case LV_EVENT_RELEASED:
+            event_pin_page(obj);
             eventid = HASP_EVENT_UP;
             return true;
 
         case LV_EVENT_VALUE_CHANGED:
+            event_pin_page(obj);
             eventid = HASP_EVENT_CHANGED;
             return true;
     }
@@ -260,49 +301,110 @@ static void event_send_object_data(lv_obj_t* obj, const char* data)
     uint8_t objid;
 
     if(hasp_find_id_from_obj(obj, &pageid, &objid)) {
-        if(!data) return;
+        if(!data) {
+            LOG_WARNING(TAG_EVENT, F("Event payload too long, not sent"));
+            return;
+        }
+        event_rate_limit.sent++;
         object_dispatch_state(pageid, objid, data);
     } else {
         LOG_ERROR(TAG_EVENT, F(D_OBJECT_UNKNOWN));
     }
 }
 
+// Payload size of an event, with room for the event name, the tag and extra values of the given size
+static inline size_t event_payload_size(const char* tag, size_t extra)
+{
+    return 24 + extra + (tag ? strlen(tag) + 8 : 0);
+}
+
+// Start an event payload with the event name
+static inline void event_add_name(JsonWriter& json, uint8_t eventid)
+{
+    char eventname[8];
+    Parser::get_event_name(eventid, eventname, sizeof(eventname));
+    json.add("event", eventname);
+}
+
 // Send out events with a val attribute
 static void event_object_val_event(lv_obj_t* obj, uint8_t eventid, int16_t val)
 {
-    char data[512];
-    {
-        char eventname[8];
-        Parser::get_event_name(eventid, eventname, sizeof(eventname));
-        if(const char* tag = my_obj_get_tag(obj))
-            snprintf_P(data, sizeof(data), PSTR("{\"event\":\"%s\",\"val\":%d,\"tag\":%s}"), eventname, val, tag);
-        else
-            snprintf_P(data, sizeof(data), PSTR("{\"event\":\"%s\",\"val\":%d}"), eventname, val);
-    }
-    event_send_object_data(obj, data);
+    const char* tag = my_obj_get_tag(obj);
+    JsonBuffer payload(event_payload_size(tag, 16));
+    JsonWriter json(payload.data(), payload.size());
+    event_add_name(json, eventid);
+    json.add("val", val);
+    if(tag) json.add_json("tag", tag);
+    event_send_object_data(obj, json.c_str());
 }
 
 // Send out events with a val and text attribute
 static void event_object_selection_changed(lv_obj_t* obj, uint8_t eventid, int16_t val, const char* text)
 {
-    char data[512];
-    {
-        StaticJsonDocument<256> doc;
-        size_t len = text ? strlen(text) : 0;
-        doc.set(text); // use text as-is
-        char serialized_text[256];
-        len = serializeJson(doc, serialized_text, sizeof(serialized_text));
+    const char* tag = my_obj_get_tag(obj);
+    JsonBuffer payload(event_payload_size(tag, 24 + JsonWriter::escaped_length(text)));
+    JsonWriter json(payload.data(), payload.size());
+    event_add_name(json, eventid);
+    json.add("val", val);
+    json.add("text", text);
+    if(tag) json.add_json("tag", tag);
+    event_send_object_data(obj, json.c_str());
+}
 
-        char eventname[8];
-        Parser::get_event_name(eventid, eventname, sizeof(eventname));
-        if(const char* tag = my_obj_get_tag(obj))
-            snprintf_P(data, sizeof(data), PSTR("{\"event\":\"%s\",\"val\":%d,\"text\":%s,\"tag\":%s}"), eventname,
-                       val, serialized_text, tag);
-        else
-            snprintf_P(data, sizeof(data), PSTR("{\"event\":\"%s\",\"val\":%d,\"text\":%s}"), eventname, val,
-                       serialized_text);
+// ##################### Rate Limiting ########################################################
+
+static void event_rate_limit_flush(lv_task_t* task)
+{
+    lv_obj_t* obj = (lv_obj_t*)task->user_data;
+    if(!lv_debug_check_obj_valid(obj)) return;
+
+    hasp_ext_user_data_t* ext = (hasp_ext_user_data_t*)obj->user_data.ext;
+    if(ext) ext->event_task = NULL; // lv_task_once deletes the task
+
+    /* Send the latest value by replaying a changed event */
+    event_rate_limit.flushing = obj;
+    if(lv_event_cb_t cb = lv_obj_get_event_cb(obj)) cb(obj, LV_EVENT_LONG_PRESSED_REPEAT);
+    event_rate_limit.flushing = NULL;
+}
+
+/**
+ * Check if a changed event can be sent now or if it is coalesced with the next one
+ * Down and up events must call event_rate_limit_edge() instead
+ * @param obj pointer to the object sending a changed event
+ * @return true if the event is held back and sent at the end of the window
+ */
+static bool event_rate_limit_changed(lv_obj_t* obj)
+{
+    hasp_ext_user_data_t* ext = (hasp_ext_user_data_t*)obj->user_data.ext;
+    if(!ext) return false;
+
+    uint32_t now = millis();
+    if(event_rate_limit.flushing == obj || now - ext->event_sent >= ext->event_rate) {
+        event_rate_limit_cancel(obj);
+        ext->event_sent = now; // a new window starts
+        return false;
+    }
+
+    if(ext->event_task) {
+        event_rate_limit.coalesced++; // the previous held back value is replaced
+    } else {
+        uint32_t delay  = ext->event_rate - (now - ext->event_sent);
+        ext->event_task = lv_task_create(event_rate_limit_flush, delay, LV_TASK_PRIO_MID, obj);
+        if(!ext->event_task) return false; // send it now
+        lv_task_once(ext->event_task);
     }
-    event_send_object_data(obj, data);
+    return true;
+}
+
+// Down and up events are never held back, a pending changed event is superseded by them
+static void event_rate_limit_edge(lv_obj_t* obj)
+{
+    hasp_ext_user_data_t* ext = (hasp_ext_user_data_t*)obj->user_data.ext;
+    if(!ext) return;
+
+    if(ext->event_task) event_rate_limit.coalesced++;
+    event_rate_limit_cancel(obj);
+    ext->event_sent = millis() - ext->event_rate; // the next change is sent right away
 }
 
 // ##################### Event Handlers ########################################################
@@ -437,23 +539,20 @@ void textarea_event_handler(lv_obj_t* obj, lv_event_t event)
         uint8_t hasp_event_id;
         if(!translate_event(obj, event, hasp_event_id)) return;
 
-        char data[1024];
-        {
-            char eventname[8];
-            Parser::get_event_name(hasp_event_id, eventname, sizeof(eventname));
-            if(const char* tag = my_obj_get_tag(obj))
-                snprintf_P(data, sizeof(data), PSTR("{\"event\":\"%s\",\"text\":\"%s\",\"tag\":%s}"), eventname,
-                           lv_textarea_get_text(obj), tag);
-            else
-                snprintf_P(data, sizeof(data), PSTR("{\"event\":\"%s\",\"text\":\"%s\"}"), eventname,
-                           lv_textarea_get_text(obj));
-        }
-
-        event_send_object_data(obj, data);
+        const char* text = lv_textarea_get_text(obj);
+        const char* tag  = my_obj_get_tag(obj);
+        JsonBuffer payload(event_payload_size(tag, 8 + JsonWriter::escaped_length(text)));
+        JsonWriter json(payload.data(), payload.size());
+        event_add_name(json, hasp_event_id);
+        json.add("text", text);
+        if(tag) json.add_json("tag", tag);
+        event_send_object_data(obj, json.c_str());
     } else if(event == LV_EVENT_FOCUSED) {
         lv_textarea_set_cursor_hidden(obj, false);
     } else if(event == LV_EVENT_DEFOCUSED) {
         lv_textarea_set_cursor_hidden(obj, true);
+    } else if(event == LV_EVENT_DELETE) {
+        delete_event_handler(obj, event);
     }
 }
 
@@ -528,16 +627,12 @@ void generic_event_handler(lv_obj_t* obj, lv_event_t event)
         Parser::get_event_name(last_value_sent, eventname, sizeof(eventname));
         script_event_handler(eventname, action);
     } else {
-        char data[512];
-        {
-            char eventname[8];
-            Parser::get_event_name(last_value_sent, eventname, sizeof(eventname));
-            if(const char* tag = my_obj_get_tag(obj))
-                snprintf_P(data, sizeof(data), PSTR("{\"event\":\"%s\",\"tag\":%s}"), eventname, tag);
-            else
-                snprintf_P(data, sizeof(data), PSTR("{\"event\":\"%s\"}"), eventname);
-        }
-        event_send_object_data(obj, data);
+        const char* tag = my_obj_get_tag(obj);
+        JsonBuffer payload(event_payload_size(tag, 0));
+        JsonWriter json(payload.data(), payload.size());
+        event_add_name(json, last_value_sent);
+        if(tag) json.add_json("tag", tag);
+        event_send_object_data(obj, json.c_str());
     }
 
     // Update group objects and gpios on release
@@ -606,9 +701,6 @@ void selector_event_handler(lv_obj_t* obj, lv_event_t event)
 
     /* Get the new value */
     char buffer[128];
-#if LV_USE_TABLE > 0
-    char property[36];
-#endif
     uint16_t val = 0;
     uint16_t max = 0;
 
@@ -642,10 +734,12 @@ void selector_event_handler(lv_obj_t* obj, lv_event_t event)
             if(lv_table_get_pressed_cell(obj, &row, &col) != LV_RES_OK) return; // outside any cell
 
             const char* txt = lv_table_get_cell_value(obj, row, col);
-            strncpy(buffer, txt, sizeof(buffer));
-
-            snprintf_P(property, sizeof(property), PSTR("row\":%d,\"col\":%d,\"text"), row, col);
-            attr_out_str(obj, property, buffer);
+            JsonBuffer payload(40 + JsonWriter::escaped_length(txt));
+            JsonWriter json(payload.data(), payload.size());
+            json.add("row", row);
+            json.add("col", col);
+            json.add("text", txt);
+            event_send_object_data(obj, json.c_str());
             return; // done sending
         }
 #endif
@@ -818,6 +912,11 @@ void slider_event_handler(lv_obj_t* obj, lv_event_t event)
     if(hasp_event_id == HASP_EVENT_CHANGED && last_value_sent == val && last_obj_sent == obj)
         return; // same object and value as before
 
+    if(hasp_event_id != HASP_EVENT_CHANGED)
+        event_rate_limit_edge(obj);
+    else if(event_rate_limit_changed(obj))
+        return; // sent at the end of the event_rate window
+
     last_value_sent = val;
     last_obj_sent   = obj;
     event_object_val_event(obj, hasp_event_id, val);
@@ -844,31 +943,30 @@ void cpicker_event_handler(lv_obj_t* obj, lv_event_t event)
 
     if(hasp_event_id == HASP_EVENT_CHANGED && last_color_sent.full == color.full) return; // same value as before
 
-    char data[512];
-    {
-        char eventname[8];
-        Parser::get_event_name(hasp_event_id, eventname, sizeof(eventname));
-
-        lv_color32_t c32;
-        lv_color_hsv_t hsv;
-        c32.full        = lv_color_to32(color);
-        hsv             = lv_color_rgb_to_hsv(c32.ch.red, c32.ch.green, c32.ch.blue);
-        last_color_sent = color;
-
-        if(const char* tag = my_obj_get_tag(obj))
-            snprintf_P(data, sizeof(data),
-                       PSTR("{\"event\":\"%s\",\"color\":\"#%02x%02x%02x\",\"r\":%d,\"g\":%d,\"b\":%d,\"h\":%d,\"s\":%"
-                            "d,\"v\":%d,\"tag\":%s}"),
-                       eventname, c32.ch.red, c32.ch.green, c32.ch.blue, c32.ch.red, c32.ch.green, c32.ch.blue, hsv.h,
-                       hsv.s, hsv.v, tag);
-        else
-            snprintf_P(data, sizeof(data),
-                       PSTR("{\"event\":\"%s\",\"color\":\"#%02x%02x%02x\",\"r\":%d,\"g\":%d,\"b\":%d,\"h\":%d,\"s\":%"
-                            "d,\"v\":%d}"),
-                       eventname, c32.ch.red, c32.ch.green, c32.ch.blue, c32.ch.red, c32.ch.green, c32.ch.blue, hsv.h,
-                       hsv.s, hsv.v);
-    }
-    event_send_object_data(obj, data);
+    if(hasp_event_id != HASP_EVENT_CHANGED)
+        event_rate_limit_edge(obj);
+    else if(event_rate_limit_changed(obj))
+        return; // sent at the end of the event_rate window
+
+    lv_color32_t c32;
+    lv_color_hsv_t hsv;
+    c32.full        = lv_color_to32(color);
+    hsv             = lv_color_rgb_to_hsv(c32.ch.red, c32.ch.green, c32.ch.blue);
+    last_color_sent = color;
+
+    const char* tag = my_obj_get_tag(obj);
+    JsonBuffer payload(event_payload_size(tag, 80));
+    JsonWriter json(payload.data(), payload.size());
+    event_add_name(json, hasp_event_id);
+    json.add_color("color", c32);
+    json.add("r", c32.ch.red);
+    json.add("g", c32.ch.green);
+    json.add("b", c32.ch.blue);
+    json.add("h", hsv.h);
+    json.add("s", hsv.s);
+    json.add("v", hsv.v);
+    if(tag) json.add_json("tag", tag);
+    event_send_object_data(obj, json.c_str());
 
     // event_update_group(obj->user_data.groupid, obj, val, min, max);
 }
@@ -879,6 +977,10 @@ void calendar_event_handler(lv_obj_t* obj, lv_event_t event)
     log_event("calendar", event);
 
     uint8_t hasp_event_id;
+    if(event == LV_EVENT_DELETE) {
+        delete_event_handler(obj, event); // free and destroy persistent memory allocated for certain objects
+        return;
+    }
     if(event != LV_EVENT_PRESSED && event != LV_EVENT_RELEASED && event != LV_EVENT_VALUE_CHANGED) return;
     if(!translate_event(obj, event, hasp_event_id)) return; // Use LV_EVENT_VALUE_CHANGED
 
@@ -894,24 +996,22 @@ void calendar_event_handler(lv_obj_t* obj, lv_event_t event)
     if(hasp_event_id == HASP_EVENT_CHANGED && last_value_sent == val && last_obj_sent == obj)
         return; // same object and value as before
 
-    char data[512];
-    {
-        char eventname[8];
-        Parser::get_event_name(hasp_event_id, eventname, sizeof(eventname));
-
-        last_value_sent = val;
-        last_obj_sent   = obj;
+    last_value_sent = val;
+    last_obj_sent   = obj;
 
-        if(const char* tag = my_obj_get_tag(obj))
-            snprintf_P(data, sizeof(data),
-                       PSTR("{\"event\":\"%s\",\"val\":\"%d\",\"text\":\"%04d-%02d-%02dT00:00:00Z\",\"tag\":%s}"),
-                       eventname, date->day, date->year, date->month, date->day, tag);
-        else
-            snprintf_P(data, sizeof(data),
-                       PSTR("{\"event\":\"%s\",\"val\":\"%d\",\"text\":\"%04d-%02d-%02dT00:00:00Z\"}"), eventname,
-                       date->day, date->year, date->month, date->day);
-    }
-    event_send_object_data(obj, data);
+    char day[4];
+    char text[24];
+    snprintf_P(day, sizeof(day), PSTR("%d"), date->day);
+    snprintf_P(text, sizeof(text), PSTR("%04d-%02d-%02dT00:00:00Z"), date->year, date->month, date->day);
+
+    const char* tag = my_obj_get_tag(obj);
+    JsonBuffer payload(event_payload_size(tag, 48));
+    JsonWriter json(payload.data(), payload.size());
+    event_add_name(json, hasp_event_id);
+    json.add("val", day); // the calendar sends val as a string
+    json.add("text", text);
+    if(tag) json.add_json("tag", tag);
+    event_send_object_data(obj, json.c_str());
 
     // event_update_group(obj->user_data.groupid, obj, val, min, max);
 }
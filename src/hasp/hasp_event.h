@@ -31,5 +31,6 @@ void alarm_event_handler(lv_obj_t* obj, lv_event_t event);
 
 // Other functions
 void event_reset_last_value_sent();
+void event_get_counters(uint32_t& sent, uint32_t& coalesced);
 
 #endif // HASP_EVENT_H
\ No newline at end of file
@@ -24,6 +24,7 @@ typedef struct
 #endif // HASP_USE_FREETYPE
 
 #include "hasp_mem.h"
+#include "dev/device.h"
 #include "font/hasp_font_loader.h"
 
 #if defined(ARDUINO_ARCH_ESP32) && (HASP_USE_FREETYPE > 0) // && defined(ESP32S3)
@@ -36,15 +37,71 @@ extern const uint8_t OPENHASP_TTF_END[] asm("_binary_data_openhasp_ttf_end");
 // #endif
 #endif
 
-static lv_ll_t hasp_fonts_ll;
+#if HASP_FONT_PRELOAD_MAX > 0 && (defined(ARDUINO_ARCH_ESP32) || HASP_TARGET_PC)
+#define HASP_FONT_PRELOAD_THREAD 1
+#include <atomic>
+#if !defined(ARDUINO_ARCH_ESP32)
+#include <mutex>
+#include <condition_variable>
+#endif
+#else
+#define HASP_FONT_PRELOAD_THREAD 0
+#endif
 
-typedef struct
+#ifndef LV_FS_PC_PATH
+#define LV_FS_PC_PATH "." /* Project root, same as the lv_fs_pc driver */
+#endif
+
+#define FONT_BUCKETS 16 // power of 2
+
+typedef struct hasp_font_info_t
 {
-    char* payload;   /* The payload with name and size */
-    lv_font_t* font; /* point to lvgl font */
-    uint8_t type;
+    struct hasp_font_info_t* next;      // next font with the same payload hash
+    struct hasp_font_info_t* next_font; // next font with the same font pointer hash
+    char* payload;                      // The payload with name and size
+    lv_font_t* font;                    // point to lvgl font, NULL if no font file was found
+    uint32_t hash;
+    uint16_t refcount; // number of local styles of objects using this font
+    uint8_t type;      // 0 = bin, 1 = ttf/otf file, 2 = embedded ttf
 } hasp_font_info_t;
 
+static hasp_font_info_t* font_by_payload[FONT_BUCKETS];
+static hasp_font_info_t* font_by_pointer[FONT_BUCKETS];
+static uint8_t font_missing_count; // negative entries in the registry
+
+#if HASP_FONT_PRELOAD_MAX > 0
+enum {
+    FONT_PRELOAD_PENDING, // the file is being read
+    FONT_PRELOAD_READY,   // the file contents are in the buffer
+    FONT_PRELOAD_MISSING, // stdio found no .bin file, lv_fs may still find it
+    FONT_PRELOAD_SKIPPED, // the .bin file is paged or could not be read, load it the normal way
+    FONT_PRELOAD_DONE,    // the font is in the registry
+};
+
+typedef struct
+{
+    char* payload;
+    uint8_t* buffer;
+    uint32_t size;
+#if HASP_FONT_PRELOAD_THREAD
+    std::atomic<uint8_t> state;
+#else
+    uint8_t state;
+#endif
+} hasp_font_preload_t;
+
+static hasp_font_preload_t font_preload_list[HASP_FONT_PRELOAD_MAX];
+static uint8_t font_preload_count;
+
+/* Signaled by the worker every time it publishes a file */
+#if HASP_FONT_PRELOAD_THREAD && defined(ARDUINO_ARCH_ESP32)
+static SemaphoreHandle_t font_preload_signal;
+#elif HASP_FONT_PRELOAD_THREAD
+static std::mutex font_preload_mutex;
+static std::condition_variable& font_preload_signal = *new std::condition_variable; // outlives the worker at exit
+#endif
+#endif
+
 bool font_dummy_glyph_dsc(const struct _lv_font_struct*, lv_font_glyph_dsc_t*, uint32_t letter, uint32_t letter_next)
 {
     return false;
@@ -69,14 +126,18 @@ void font_setup()
         LOG_ERROR(TAG_FONT, F("FreeType " D_SERVICE_START_FAILED));
     }
 #elif HASP_TARGET_PC
+    if(lv_freetype_init(LVGL_FREETYPE_MAX_FACES, LVGL_FREETYPE_MAX_SIZES, LVGL_FREETYPE_MAX_BYTES)) {
+        LOG_VERBOSE(TAG_FONT, F("FreeType v%d.%d.%d " D_SERVICE_STARTED), FREETYPE_MAJOR, FREETYPE_MINOR,
+                    FREETYPE_PATCH);
+    } else {
+        LOG_ERROR(TAG_FONT, F("FreeType " D_SERVICE_START_FAILED));
+    }
 #else
 #endif
 
 #else
     LOG_VERBOSE(TAG_FONT, F("FreeType " D_SERVICE_DISABLED));
 #endif // HASP_USE_FREETYPE
-
-    _lv_ll_init(&hasp_fonts_ll, sizeof(hasp_font_info_t));
 }
 
 size_t font_split_payload(const char* payload)
@@ -89,86 +150,346 @@ size_t font_split_payload(const char* payload)
     return 0;
 }
 
-static void font_release(void* node)
+/* FNV-1a hash of the payload */
+static uint32_t font_hash(const char* payload)
+{
+    uint32_t hash = 2166136261u;
+    while(*payload) hash = (hash ^ (uint8_t)*payload++) * 16777619u;
+    return hash;
+}
+
+static inline uint8_t font_pointer_bucket(const lv_font_t* font)
+{
+    return ((uintptr_t)font >> 4) & (FONT_BUCKETS - 1);
+}
+
+static hasp_font_info_t* font_find_in_list(const char* payload, uint32_t hash)
+{
+    hasp_font_info_t* font_p = font_by_payload[hash & (FONT_BUCKETS - 1)];
+    while(font_p) {
+        if(font_p->hash == hash && strcmp(font_p->payload, payload) == 0) return font_p; // name and size
+        font_p = font_p->next;
+    }
+    return NULL;
+}
+
+static hasp_font_info_t* font_find_pointer(const lv_font_t* font)
+{
+    hasp_font_info_t* font_p = font_by_pointer[font_pointer_bucket(font)];
+    while(font_p && font_p->font != font) font_p = font_p->next_font;
+    return font_p;
+}
+
+/* Destroy the font and free the registry entry, it must be unlinked first */
+static void font_unload(hasp_font_info_t* font_p)
 {
-    hasp_font_info_t* font_p = (hasp_font_info_t*)node;
     if(font_p->font) {
-        if(font_p->type = 1) { // It's a FreeType font
+        if(font_p->type == 0) { // It's a binary font
+            hasp_font_free(font_p->font);
+        } else { // It's a FreeType font
 #if(HASP_USE_FREETYPE > 0)
             lv_ft_font_destroy(font_p->font);
 #endif
-        } else if(font_p->type = 0) { // It's a binary font
-            hasp_font_free(font_p->font);
         }
+        LOG_DEBUG(TAG_FONT, F("Released font %s"), font_p->payload);
     }
+    hasp_free(font_p); // the payload is stored in the same allocation
+}
 
-    /* Free the allocated font_name last */
-    if(font_p->payload) {
-        LOG_DEBUG(TAG_FONT, F("Released font %s"), font_p->payload);
-        hasp_free(font_p->payload);
+/* Unlink and unload the fonts that no object uses, and forget the missing files */
+static void font_remove_unused(bool missing_only)
+{
+    for(uint8_t i = 0; i < FONT_BUCKETS; i++) {
+        hasp_font_info_t** link = &font_by_payload[i];
+        while(hasp_font_info_t* font_p = *link) {
+            if(font_p->refcount > 0 || (missing_only && font_p->font)) {
+                link = &font_p->next;
+                continue;
+            }
+            *link = font_p->next;
+
+            if(font_p->font) {
+                hasp_font_info_t** ptr_link = &font_by_pointer[font_pointer_bucket(font_p->font)];
+                while(*ptr_link != font_p) ptr_link = &(*ptr_link)->next_font;
+                *ptr_link = font_p->next_font;
+            } else {
+                font_missing_count--;
+            }
+            font_unload(font_p);
+        }
     }
 }
 
-void font_clear_list(const char* payload)
+static hasp_font_info_t* font_insert(const char* payload, uint32_t hash, lv_font_t* font, uint8_t type)
 {
-    if(_lv_ll_is_empty(&hasp_fonts_ll)) return;
+    if(!font && font_missing_count >= HASP_FONT_MISSING_MAX) font_remove_unused(true);
+
+    /* alloc the entry and payload str together */
+    size_t len               = strlen(payload);
+    hasp_font_info_t* font_p = (hasp_font_info_t*)hasp_calloc(1, sizeof(hasp_font_info_t) + len + 1);
+    if(!font_p) return NULL;
+
+    font_p->payload = (char*)(font_p + 1);
+    memcpy(font_p->payload, payload, len);
+    font_p->font = font;
+    font_p->hash = hash;
+    font_p->type = type;
+
+    uint8_t bucket          = hash & (FONT_BUCKETS - 1);
+    font_p->next            = font_by_payload[bucket];
+    font_by_payload[bucket] = font_p;
+
+    if(font) {
+        bucket                  = font_pointer_bucket(font);
+        font_p->next_font       = font_by_pointer[bucket];
+        font_by_pointer[bucket] = font_p;
+    } else {
+        font_missing_count++;
+    }
+    return font_p;
+}
+
+/* ========================= Preload ========================= */
+#if HASP_FONT_PRELOAD_MAX > 0
 
-    while(void* node = _lv_ll_get_head(&hasp_fonts_ll)) {
-        font_release(node);
-        _lv_ll_remove(&hasp_fonts_ll, node);
-        lv_mem_free(node);
+/* Publish the result of the worker and wake the thread waiting for it */
+static void font_preload_publish(hasp_font_preload_t* preload, uint8_t state)
+{
+#if HASP_FONT_PRELOAD_THREAD && defined(ARDUINO_ARCH_ESP32)
+    preload->state = state;
+    if(font_preload_signal) xSemaphoreGive(font_preload_signal);
+#elif HASP_FONT_PRELOAD_THREAD
+    {
+        std::lock_guard<std::mutex> lock(font_preload_mutex);
+        preload->state = state;
     }
+    font_preload_signal.notify_all();
+#else
+    preload->state = state;
+#endif
 }
 
-// void font_clear_list2(const char* payload)
-// {
-//     hasp_font_info_t* font_p = (hasp_font_info_t*)_lv_ll_get_head(&hasp_fonts_ll);
-//     while(font_p) {
-//         if(font_p->type == 1) {
-//             lv_font_fmt_ft_dsc_t* dsc = (lv_font_fmt_ft_dsc_t*)font_p->font->dsc;
-//             if(strcmp(dsc->name, payload) == 0) { // name and size
-//                 lv_ft_font_destroy(font_p->font);
-//                 *font_p->font = HASP_FONT_1;
-//                 font_p->type  = 255;
-//             }
-//         }
-//         // if(strcmp(font_p->payload, payload) == 0) { // name and size
-//         //     LOG_DEBUG(TAG_FONT, F("Payload %s found => line height = %d - base_line = %d"), payload,
-//         //               font_p->font->line_height, font_p->font->base_line);
-//         //     return font_p->font;
-//         // }
-
-//         font_p = (hasp_font_info_t*)_lv_ll_get_next(&hasp_fonts_ll, font_p);
-//     }
-// }
-
-static lv_font_t* font_find_in_list(const char* payload)
+/* Block until the worker has read the file of the entry */
+static void font_preload_wait(hasp_font_preload_t* preload)
 {
-    hasp_font_info_t* font_p = (hasp_font_info_t*)_lv_ll_get_head(&hasp_fonts_ll);
-    while(font_p) {
-        if(strcmp(font_p->payload, payload) == 0) { // name and size
-            LOG_DEBUG(TAG_FONT, F("Payload %s found => line height = %d - base_line = %d"), payload,
-                      font_p->font->line_height, font_p->font->base_line);
-            return font_p->font;
+#if HASP_FONT_PRELOAD_THREAD && defined(ARDUINO_ARCH_ESP32)
+    while(preload->state == FONT_PRELOAD_PENDING) xSemaphoreTake(font_preload_signal, portMAX_DELAY);
+#elif HASP_FONT_PRELOAD_THREAD
+    std::unique_lock<std::mutex> lock(font_preload_mutex);
+    font_preload_signal.wait(lock, [preload] { return preload->state != FONT_PRELOAD_PENDING; });
+#endif
+}
+
+/* Only reads the .bin files with stdio, lv_fs and the lvgl heap are not thread safe */
+static void font_preload_task(void* arg)
+{
+    char filename[256];
+    uint8_t count = font_preload_count; // the list is reset once the last file is published
+
+    for(uint8_t i = 0; i < count; i++) {
+        hasp_font_preload_t* preload = &font_preload_list[i];
+        uint8_t state                = FONT_PRELOAD_MISSING;
+
+#if defined(WINDOWS)
+        snprintf(filename, sizeof(filename), LV_FS_PC_PATH "\\%s.bin", preload->payload);
+#else
+        snprintf(filename, sizeof(filename), LV_FS_PC_PATH "/%s.bin", preload->payload);
+#endif
+        if(FILE* file = fopen(filename, "rb")) {
+            state = FONT_PRELOAD_SKIPPED;
+            long size = fseek(file, 0, SEEK_END) == 0 ? ftell(file) : -1;
+            rewind(file);
+
+            if(size > 0 && (HASP_FONT_PAGED_SIZE == 0 || (uint32_t)size <= HASP_FONT_PAGED_SIZE)) {
+                preload->buffer = (uint8_t*)hasp_malloc(size);
+                if(preload->buffer && fread(preload->buffer, 1, size, file) == (size_t)size) {
+                    preload->size = size;
+                    state         = FONT_PRELOAD_READY;
+                } else {
+                    hasp_free(preload->buffer);
+                    preload->buffer = NULL;
+                }
+            }
+            fclose(file);
         }
-        font_p = (hasp_font_info_t*)_lv_ll_get_next(&hasp_fonts_ll, font_p);
+        font_preload_publish(preload, state);
     }
+}
 
-    return NULL;
+#if HASP_FONT_PRELOAD_THREAD && defined(ARDUINO_ARCH_ESP32)
+static void font_preload_esp_task(void* arg)
+{
+    font_preload_task(arg);
+    vTaskDelete(NULL);
 }
+#endif
 
-static lv_font_t* font_add_to_list(const char* payload)
+/* Wait for the worker and take the prefetched file of the payload, if any */
+static uint8_t font_preload_take(const char* payload, uint8_t** buffer, uint32_t* size)
+{
+    for(uint8_t i = 0; i < font_preload_count; i++) {
+        hasp_font_preload_t* preload = &font_preload_list[i];
+        if(preload->state == FONT_PRELOAD_DONE || strcmp(preload->payload, payload) != 0) continue;
+
+        font_preload_wait(preload);
+
+        uint8_t state = preload->state;
+        if(state == FONT_PRELOAD_READY) {
+            *buffer         = preload->buffer;
+            *size           = preload->size;
+            preload->buffer = NULL;
+        }
+        preload->state = FONT_PRELOAD_DONE;
+        return state;
+    }
+    return FONT_PRELOAD_SKIPPED;
+}
+
+/**
+ * Start reading the .bin files of the fonts in the list in the background, so pages can be built meanwhile
+ * @param list font payloads separated by commas or spaces, like "robotocondensed_24,mdi_32"
+ */
+void font_preload(const char* list)
+{
+    font_preload_finish(); // a previous preload must be complete
+    if(!list) return;
+
+    while(*list && font_preload_count < HASP_FONT_PRELOAD_MAX) {
+        size_t len = strcspn(list, ", ");
+        if(len > 0 && len < 64) {
+            char payload[64];
+            memcpy(payload, list, len);
+            payload[len] = '\0';
+
+            // built-in fonts, fonts that are loaded already and repeated payloads don't need a preload
+            bool listed = false;
+            for(uint8_t i = 0; i < font_preload_count && !listed; i++) {
+                listed = !strcmp(font_preload_list[i].payload, payload);
+            }
+            if(!listed && !Parser::is_only_digits(payload) && !font_find_in_list(payload, font_hash(payload))) {
+                hasp_font_preload_t* preload = &font_preload_list[font_preload_count];
+                preload->payload             = (char*)hasp_calloc(1, len + 1);
+                if(preload->payload) {
+                    memcpy(preload->payload, payload, len);
+                    preload->buffer = NULL;
+                    preload->size   = 0;
+                    preload->state  = FONT_PRELOAD_PENDING;
+                    font_preload_count++;
+                }
+            }
+        }
+        list += len;
+        while(*list == ',' || *list == ' ') list++;
+    }
+    if(font_preload_count == 0) return;
+
+    LOG_VERBOSE(TAG_FONT, F("Preloading %u fonts"), font_preload_count);
+#if HASP_FONT_PRELOAD_THREAD && defined(ARDUINO_ARCH_ESP32)
+    if(!font_preload_signal) font_preload_signal = xSemaphoreCreateBinary();
+    if(!font_preload_signal || xTaskCreate(font_preload_esp_task, "fontPreload", 4096, NULL, 1, NULL) != pdPASS) {
+        font_preload_task(NULL); // read the files now
+    }
+#elif HASP_FONT_PRELOAD_THREAD
+    haspDevice.run_thread(font_preload_task, NULL);
+#else
+    font_preload_task(NULL);
+#endif
+}
+
+/**
+ * Add the preloaded fonts that no page has used yet to the registry and free the preload list
+ * Waits for the worker first, it reads the payloads and writes the buffers of all entries.
+ */
+void font_preload_finish()
+{
+    for(uint8_t i = 0; i < font_preload_count; i++) font_preload_wait(&font_preload_list[i]);
+
+    for(uint8_t i = 0; i < font_preload_count; i++) {
+        hasp_font_preload_t* preload = &font_preload_list[i];
+        if(preload->state != FONT_PRELOAD_DONE) get_font(preload->payload); // takes the buffer
+        hasp_free(preload->buffer); // not taken if the font was loaded some other way meanwhile
+        hasp_free(preload->payload);
+        preload->buffer  = NULL;
+        preload->payload = NULL;
+    }
+    font_preload_count = 0;
+}
+#else
+void font_preload(const char* list)
+{}
+void font_preload_finish()
+{}
+#endif // HASP_FONT_PRELOAD_MAX
+
+/* ========================= Registry ========================= */
+
+/**
+ * Unload all fonts that are not used by any object
+ * Fonts still in use stay loaded, the registry forgets about all missing font files.
+ * @param payload unused
+ */
+void font_clear_list(const char* payload)
+{
+    font_preload_finish();
+    font_remove_unused(false);
+
+    uint8_t in_use = 0;
+    for(uint8_t i = 0; i < FONT_BUCKETS; i++)
+        for(hasp_font_info_t* font_p = font_by_payload[i]; font_p; font_p = font_p->next) in_use++;
+    if(in_use) {
+        LOG_VERBOSE(TAG_FONT, F("%u fonts are still in use"), in_use);
+    }
+}
+
+/**
+ * Count an object style that uses the font
+ * @param font the font that was set
+ * @return false if the font is not in the registry, like the built-in fonts
+ */
+bool font_retain(const lv_font_t* font)
+{
+    hasp_font_info_t* font_p = font_find_pointer(font);
+    if(!font_p) return false;
+    font_p->refcount++;
+    return true;
+}
+
+/**
+ * Uncount an object style that no longer uses the font, it is unloaded by the next font_clear_list()
+ * @param font the font that was replaced or whose object was deleted
+ */
+void font_release(const lv_font_t* font)
+{
+    hasp_font_info_t* font_p = font_find_pointer(font);
+    if(font_p && font_p->refcount > 0) font_p->refcount--;
+}
+
+static lv_font_t* font_add_to_list(const char* payload, uint32_t hash)
 {
     char filename[256];
+    lv_font_t* font   = NULL;
+    uint8_t font_type = 0;
 
-    // Try .bin file
+#if HASP_USE_FREETYPE > 0
+    LOG_DEBUG(TAG_FONT, F("FreeType High Watermark %u"), lv_ft_freetype_high_watermark());
+#endif
+
+    // Try .bin file, it may have been read by the preload already
     snprintf_P(filename, sizeof(filename), PSTR("L:\\%s.bin"), payload);
-    lv_font_t* font   = hasp_font_load(filename);
-    char* name_p      = NULL;
-    uint8_t font_type = 0;
+#if HASP_FONT_PRELOAD_MAX > 0
+    uint8_t* buffer = NULL;
+    uint32_t length = 0;
+    uint8_t state   = font_preload_take(payload, &buffer, &length);
+    if(state == FONT_PRELOAD_READY)
+        font = hasp_font_load_buffer(buffer, length);
+    else // stdio and lv_fs may not see the same files, so a missing file is looked up again
+        font = hasp_font_load(filename);
+#else
+    font = hasp_font_load(filename);
+#endif
 
-#if defined(ARDUINO_ARCH_ESP32) && (HASP_USE_FREETYPE > 0)
-    char* ext[] = {"ttf", "otf"};
+#if(HASP_USE_FREETYPE > 0)
+    const char* ext[] = {"ttf", "otf"};
     for(size_t i = 0; i < 2; i++) {
         if(!font) {
 
@@ -193,6 +514,10 @@ static lv_font_t* font_add_to_list(const char* payload)
                     lv_fs_close(&f);
                     LOG_VERBOSE(TAG_FONT, F(D_FILE_LOADING), filename);
                 }
+#if HASP_TARGET_PC
+                // the system FreeType library opens files by their real path
+                snprintf(filename, sizeof(filename), LV_FS_PC_PATH "/%s.%s", fontname, ext[i]);
+#endif
 
                 lv_ft_info_t info;
                 info.name     = filename;
@@ -209,7 +534,7 @@ static lv_font_t* font_add_to_list(const char* payload)
         }
     }
 
-#if 1 || defined(ESP32S3)
+#if defined(ARDUINO_ARCH_ESP32) // || defined(ESP32S3)
     if(!font) {
         strcpy(filename, "default");
         uint16_t size = atoi(payload);
@@ -227,38 +552,42 @@ static lv_font_t* font_add_to_list(const char* payload)
             }
         }
     }
-#endif // ESP32S3
+#endif // ESP32
+
+#endif // HASP_USE_FREETYPE
 
-#endif // ESP32 && HASP_USE_FREETYPE
+    // Missing fonts are remembered too, so the files are not probed again until the next clearfont
+    if(!font_insert(payload, hash, font, font_type)) {
+        if(font && font_type == 0) hasp_font_free(font);
+#if(HASP_USE_FREETYPE > 0)
+        if(font && font_type != 0) lv_ft_font_destroy(font);
+#endif
+        return NULL;
+    }
 
     if(!font) return NULL;
     LOG_VERBOSE(TAG_FONT, F("Loaded font %s line_height %d"), filename, font->line_height);
-
-    /* alloc payload str */
-    size_t len = strlen(payload);
-    name_p     = (char*)hasp_calloc(sizeof(char), len + 1);
-    if(!name_p) return NULL;
-    strncpy(name_p, payload, len);
-
-    hasp_font_info_t* new_font_item;
-    new_font_item = (hasp_font_info_t*)_lv_ll_ins_tail(&hasp_fonts_ll);
-    if(!new_font_item) return NULL;
-
-    new_font_item->payload = name_p;
-    new_font_item->font    = font;
-    new_font_item->type    = font_type;
     return font;
 }
 
-// Convert the payload to a font pointer
-lv_font_t* get_font(const char* payload)
+/**
+ * Render the glyphs of a text in one go, instead of one by one while the text is drawn
+ * @param font the font of the text, only FreeType fonts have glyphs to render
+ * @param text the new text
+ */
+void font_prefetch_text(const lv_font_t* font, const char* text)
 {
 #if HASP_USE_FREETYPE > 0
-    LOG_DEBUG(TAG_FONT, F("FreeType High Watermark %u"), lv_ft_freetype_high_watermark());
+    lv_ft_font_prefetch(font, text);
 #endif
+}
 
-    lv_font_t* font = font_find_in_list(payload);
-    if(font) return font;
+// Convert the payload to a font pointer
+lv_font_t* get_font(const char* payload)
+{
+    uint32_t hash            = font_hash(payload);
+    hasp_font_info_t* font_p = font_find_in_list(payload, hash);
+    if(font_p) return font_p->font;
 
-    return font_add_to_list(payload);
+    return font_add_to_list(payload, hash);
 }
@@ -7,5 +7,10 @@
 void font_setup();
 lv_font_t* get_font(const char* payload);
 void font_clear_list(const char* payload);
+bool font_retain(const lv_font_t* font);
+void font_release(const lv_font_t* font);
+void font_preload(const char* list);
+void font_preload_finish();
+void font_prefetch_text(const lv_font_t* font, const char* text);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,188 @@
+/* MIT License - Copyright (c) 2019-2024 Francis Van Roie
+   For full license information read the LICENSE file in the project folder */
+
+#include "hasplib.h"
+
+namespace hasp {
+
+static const char hex_digits[] = "0123456789abcdef";
+
+JsonWriter::JsonWriter(char* buffer, size_t size)
+{
+    _buffer   = buffer;
+    _size     = size;
+    _len      = 0;
+    _overflow = size < 3; // room for {}
+    write('{');
+}
+
+/* Two bytes are always kept free to close the object */
+void JsonWriter::write(char c)
+{
+    if(_overflow || _len + 3 > _size) {
+        _overflow = true;
+        return;
+    }
+    _buffer[_len++] = c;
+}
+
+void JsonWriter::write(const char* str, size_t len)
+{
+    if(_overflow || _len + len + 2 > _size) {
+        _overflow = true;
+        return;
+    }
+    memcpy(_buffer + _len, str, len);
+    _len += len;
+}
+
+void JsonWriter::write_int(int32_t val)
+{
+    char digits[11];
+    size_t pos    = sizeof(digits);
+    uint32_t uval = val < 0 ? 0U - (uint32_t)val : (uint32_t)val;
+
+    do {
+        digits[--pos] = '0' + uval % 10;
+        uval /= 10;
+    } while(uval);
+
+    if(val < 0) write('-');
+    write(digits + pos, sizeof(digits) - pos);
+}
+
+void JsonWriter::write_string(const char* str)
+{
+    write('"');
+    const char* start = str; // unescaped characters are copied in runs
+    for(; *str; str++) {
+        unsigned char c = *str;
+        if(c >= 0x20 && c != '"' && c != '\\') continue;
+
+        write(start, str - start);
+        start = str + 1;
+
+        char escape[6] = {'\\', 0, '0', '0', 0, 0};
+        switch(c) {
+            case '"':
+            case '\\':
+                escape[1] = c;
+                break;
+            case '\b':
+                escape[1] = 'b';
+                break;
+            case '\f':
+                escape[1] = 'f';
+                break;
+            case '\n':
+                escape[1] = 'n';
+                break;
+            case '\r':
+                escape[1] = 'r';
+                break;
+            case '\t':
+                escape[1] = 't';
+                break;
+            default:
+                escape[1] = 'u';
+                escape[4] = hex_digits[c >> 4];
+                escape[5] = hex_digits[c & 0x0f];
+                write(escape, 6);
+                continue;
+        }
+        write(escape, 2);
+    }
+    write(start, str - start);
+    write('"');
+}
+
+void JsonWriter::write_key(const char* key)
+{
+    if(_len > 1) write(',');
+    write('"');
+    write(key, strlen(key)); // keys are trusted and not escaped
+    write("\":", 2);
+}
+
+void JsonWriter::add(const char* key, const char* str)
+{
+    write_key(key);
+    if(str)
+        write_string(str);
+    else
+        write("null", 4);
+}
+
+void JsonWriter::add(const char* key, int32_t val)
+{
+    write_key(key);
+    write_int(val);
+}
+
+// Add a value that is already serialized, i.e. the tag of an object
+void JsonWriter::add_json(const char* key, const char* json)
+{
+    write_key(key);
+    if(json)
+        write(json, strlen(json));
+    else
+        write("null", 4);
+}
+
+void JsonWriter::add_null(const char* key)
+{
+    write_key(key);
+    write("null", 4);
+}
+
+void JsonWriter::add_color(const char* key, lv_color32_t c32)
+{
+    char color[9] = {'"',
+                     '#',
+                     hex_digits[c32.ch.red >> 4],
+                     hex_digits[c32.ch.red & 0x0f],
+                     hex_digits[c32.ch.green >> 4],
+                     hex_digits[c32.ch.green & 0x0f],
+                     hex_digits[c32.ch.blue >> 4],
+                     hex_digits[c32.ch.blue & 0x0f],
+                     '"'};
+    write_key(key);
+    write(color, sizeof(color));
+}
+
+/**
+ * Close the json object
+ * @return the serialized object or NULL if the buffer was too small
+ */
+const char* JsonWriter::c_str()
+{
+    if(_overflow) return NULL;
+    _buffer[_len]     = '}';
+    _buffer[_len + 1] = '\0';
+    return _buffer;
+}
+
+size_t JsonWriter::length()
+{
+    return _overflow ? 0 : _len + 1;
+}
+
+// Size of a string once it is quoted and escaped by the writer
+size_t JsonWriter::escaped_length(const char* str)
+{
+    size_t len = 2;
+    if(!str) return 4; // null
+
+    for(; *str; str++) {
+        unsigned char c = *str;
+        if(c >= 0x20 && c != '"' && c != '\\')
+            len++;
+        else if(c == '"' || c == '\\' || c == '\b' || c == '\f' || c == '\n' || c == '\r' || c == '\t')
+            len += 2;
+        else
+            len += 6;
+    }
+    return len;
+}
+
+} // namespace hasp
@@ -0,0 +1,84 @@
+/* MIT License - Copyright (c) 2019-2024 Francis Van Roie
+   For full license information read the LICENSE file in the project folder */
+
+#ifndef HASP_JSON_H
+#define HASP_JSON_H
+
+#include "hasplib.h"
+
+namespace hasp {
+
+/**
+ * Writes a flat json object into a caller supplied buffer, without a JsonDocument
+ * Strings are escaped straight into the buffer and integers are converted without snprintf.
+ * When the buffer is too small the writer stops writing and c_str() returns NULL.
+ */
+class JsonWriter {
+  private:
+    char* _buffer;
+    size_t _size;
+    size_t _len;
+    bool _overflow;
+
+    void write(char c);
+    void write(const char* str, size_t len);
+    void write_int(int32_t val);
+    void write_string(const char* str);
+    void write_key(const char* key);
+
+  public:
+    JsonWriter(char* buffer, size_t size);
+
+    void add(const char* key, const char* str);
+    void add(const char* key, int32_t val);
+    void add_json(const char* key, const char* json);
+    void add_null(const char* key);
+    void add_color(const char* key, lv_color32_t c32);
+
+    const char* c_str();
+    size_t length();
+
+    static size_t escaped_length(const char* str);
+};
+
+#define JSON_BUFFER_STACK_SIZE 256 // payloads up to this size are built on the stack
+#define JSON_BUFFER_MAX_SIZE 2048  // longer payloads do not fit and are not sent
+
+/**
+ * Buffer for a JsonWriter, on the stack unless a long tag or text needs more room
+ * The heap is only used up to JSON_BUFFER_MAX_SIZE, so the stack use is bounded whatever the input.
+ */
+class JsonBuffer {
+  private:
+    char _stack[JSON_BUFFER_STACK_SIZE];
+    char* _heap;
+    size_t _size;
+
+  public:
+    JsonBuffer(size_t size) : _heap(NULL), _size(sizeof(_stack))
+    {
+        if(size <= sizeof(_stack)) return;
+        if(size > JSON_BUFFER_MAX_SIZE) size = JSON_BUFFER_MAX_SIZE;
+        if((_heap = (char*)hasp_malloc(size))) _size = size;
+    }
+    ~JsonBuffer()
+    {
+        hasp_free(_heap);
+    }
+
+    char* data()
+    {
+        return _heap ? _heap : _stack;
+    }
+    size_t size()
+    {
+        return _size;
+    }
+};
+
+} // namespace hasp
+
+using hasp::JsonBuffer;
+using hasp::JsonWriter;
+
+#endif // HASP_JSON_H
@@ -46,6 +46,194 @@ void hasp_free(void* ptr)
     free(ptr);
 }
 
+#if HASP_USE_MEM_POOL > 0
+/* Small allocations are served from fixed size blocks so they can't fragment the heap.
+ * Chunks are carved into blocks of one size class and stay reserved for that class. */
+#define POOL_LARGE 0xFF
+
+struct hasp_pool_header_t
+{
+    uint32_t size; // requested size
+    uint8_t cls;   // size class or POOL_LARGE
+    uint8_t reserved[3];
+};
+
+struct hasp_pool_t
+{
+    uint16_t block_size;
+    uint32_t used;
+    uint32_t total;
+    hasp_pool_header_t* free_list; // the payload of a free block holds the next free block
+};
+
+static hasp_pool_t pools[] = {{16}, {32}, {64}, {128}, {256}};
+static const uint8_t pool_count = sizeof(pools) / sizeof(pools[0]);
+static uint32_t pool_large_used = 0;
+
+static bool pool_grow(hasp_pool_t& pool)
+{
+    size_t stride = sizeof(hasp_pool_header_t) + pool.block_size;
+    size_t blocks = HASP_MEM_POOL_CHUNK_SIZE / stride;
+    if(blocks == 0) blocks = 1;
+
+    uint8_t* chunk = (uint8_t*)malloc(blocks * stride);
+    if(!chunk) return false;
+
+    for(size_t i = 0; i < blocks; i++) {
+        hasp_pool_header_t* block          = (hasp_pool_header_t*)(chunk + i * stride);
+        block->cls                         = &pool - pools;
+        *(hasp_pool_header_t**)(block + 1) = pool.free_list;
+        pool.free_list                     = block;
+    }
+    pool.total += blocks;
+    return true;
+}
+
+void* hasp_pool_alloc(size_t size)
+{
+    hasp_pool_header_t* block = NULL;
+
+    for(uint8_t cls = 0; cls < pool_count; cls++) {
+        hasp_pool_t& pool = pools[cls];
+        if(size > pool.block_size) continue;
+
+        if(!pool.free_list && !pool_grow(pool)) return NULL;
+        block          = pool.free_list;
+        pool.free_list = *(hasp_pool_header_t**)(block + 1);
+        pool.used++;
+        break;
+    }
+
+    if(!block) {
+        block = (hasp_pool_header_t*)malloc(sizeof(hasp_pool_header_t) + size);
+        if(!block) return NULL;
+        block->cls = POOL_LARGE;
+        pool_large_used++;
+    }
+
+    block->size = size;
+    return block + 1;
+}
+
+void hasp_pool_free(void* ptr)
+{
+    if(!ptr) return;
+
+    hasp_pool_header_t* block = (hasp_pool_header_t*)ptr - 1;
+    if(block->cls == POOL_LARGE) {
+        pool_large_used--;
+        free(block);
+        return;
+    }
+
+    hasp_pool_t& pool                  = pools[block->cls];
+    *(hasp_pool_header_t**)(block + 1) = pool.free_list;
+    pool.free_list                     = block;
+    pool.used--;
+}
+
+/* Fill stats for each size class followed by the large allocations, returns the number of entries */
+uint8_t hasp_pool_get_stats(hasp_pool_stats_t* stats, uint8_t count)
+{
+    uint8_t i = 0;
+    for(; i < pool_count && i < count; i++) {
+        stats[i].block_size = pools[i].block_size;
+        stats[i].used       = pools[i].used;
+        stats[i].total      = pools[i].total;
+        stats[i].free_pct   = pools[i].total ? 100 - pools[i].used * 100 / pools[i].total : 0;
+    }
+    if(i < count) {
+        stats[i].block_size = 0;
+        stats[i].used = stats[i].total = pool_large_used;
+        stats[i].free_pct              = 0;
+        i++;
+    }
+    return i;
+}
+#endif // HASP_USE_MEM_POOL
+
+/* Every arena block is linked into the list of its page, so clearing a page can free the metadata of all its
+ * objects in one pass, including the tags of objects that were deleted without releasing them. */
+struct hasp_arena_block_t
+{
+    hasp_arena_block_t* prev;
+    hasp_arena_block_t* next;
+    uint32_t size;
+    uint8_t arena;
+} __attribute__((aligned(8)));
+
+static hasp_arena_block_t* arenas[HASP_NUM_PAGES + 1];
+static size_t arena_sizes[HASP_NUM_PAGES + 1];
+
+void* hasp_arena_alloc(uint8_t arena, size_t size)
+{
+#if HASP_USE_MEM_POOL > 0
+    hasp_arena_block_t* block = (hasp_arena_block_t*)hasp_pool_alloc(sizeof(hasp_arena_block_t) + size);
+#else
+    hasp_arena_block_t* block = (hasp_arena_block_t*)hasp_malloc(sizeof(hasp_arena_block_t) + size);
+#endif
+    if(!block) return NULL;
+
+    memset(block + 1, 0, size);
+    block->size  = size;
+    block->arena = arena <= HASP_NUM_PAGES ? arena : HASP_ARENA_NONE;
+    block->prev  = NULL;
+    block->next  = NULL;
+
+    if(block->arena != HASP_ARENA_NONE) {
+        block->next = arenas[arena];
+        if(block->next) block->next->prev = block;
+        arenas[arena] = block;
+        arena_sizes[arena] += size;
+    }
+    return block + 1;
+}
+
+static void arena_block_free(hasp_arena_block_t* block)
+{
+#if HASP_USE_MEM_POOL > 0
+    hasp_pool_free(block);
+#else
+    hasp_free(block);
+#endif
+}
+
+void hasp_arena_free(void* ptr)
+{
+    if(!ptr) return;
+
+    hasp_arena_block_t* block = (hasp_arena_block_t*)ptr - 1;
+    if(block->arena != HASP_ARENA_NONE) {
+        if(block->prev)
+            block->prev->next = block->next;
+        else
+            arenas[block->arena] = block->next;
+        if(block->next) block->next->prev = block->prev;
+        arena_sizes[block->arena] -= block->size;
+    }
+    arena_block_free(block);
+}
+
+/* Free all remaining blocks of a page, only call this when none of its objects are left */
+void hasp_arena_release(uint8_t arena)
+{
+    if(arena > HASP_NUM_PAGES) return;
+
+    hasp_arena_block_t* block = arenas[arena];
+    while(block) {
+        hasp_arena_block_t* next = block->next;
+        arena_block_free(block);
+        block = next;
+    }
+    arenas[arena]      = NULL;
+    arena_sizes[arena] = 0;
+}
+
+size_t hasp_arena_size(uint8_t arena)
+{
+    return arena <= HASP_NUM_PAGES ? arena_sizes[arena] : 0;
+}
+
 #ifdef LODEPNG_NO_COMPILE_ALLOCATORS
 void* lodepng_malloc(size_t size)
 {
@@ -53,10 +53,149 @@ lv_obj_t* hasp_find_obj_from_parent_id(lv_obj_t* parent, uint8_t objid)
     return NULL;
 }
 
+// ##################### Object Index ########################################################
+
+/* Objects created by hasp_new_object are indexed per page by their objid so lookups don't need to walk the tree.
+ * Index 0 = lv_layer_top (page 0), 1..HASP_NUM_PAGES = pages. The system layer (page 255) is not indexed.
+ * The 256 slot table of a page is only allocated when the first object is added to it. */
+static lv_obj_t** object_index[HASP_NUM_PAGES + 1];
+static bool object_index_duplicates[HASP_NUM_PAGES + 1]; // an objid of the page was used more than once
+
+static inline lv_obj_t** object_index_get_table(uint8_t pageid, bool create)
+{
+    if(pageid > HASP_NUM_PAGES) return NULL;
+    if(!object_index[pageid] && create)
+        object_index[pageid] = (lv_obj_t**)hasp_calloc(UINT8_MAX + 1, sizeof(lv_obj_t*));
+    return object_index[pageid];
+}
+
+// Add an object to the index of a page, using its current objid
+void object_index_add(uint8_t pageid, lv_obj_t* obj)
+{
+    if(!obj || obj->user_data.id == 0) return;
+
+    lv_obj_t** table = object_index_get_table(pageid, true);
+    if(!table) return;
+
+    uint8_t objid = obj->user_data.id;
+    if(table[objid] && table[objid] != obj) {
+        LOG_WARNING(TAG_HASP, F("Duplicate object id " HASP_OBJECT_NOTATION), pageid, objid);
+        object_index_duplicates[pageid] = true;
+    }
+    table[objid] = obj;
+}
+
+// Remove an object from the index, the page of a deleted object can't be resolved anymore so check all tables
+// If an older object with the same objid is left on the page, it takes the slot back like the tree lookup did
+void object_index_remove(lv_obj_t* obj)
+{
+    if(!obj || obj->user_data.id == 0) return;
+
+    uint8_t objid = obj->user_data.id;
+    for(uint8_t i = 0; i <= HASP_NUM_PAGES; i++) {
+        if(object_index[i] && object_index[i][objid] == obj) {
+            object_index[i][objid] = NULL;
+            if(object_index_duplicates[i]) {
+                obj->user_data.id      = 0; // still in the tree while it is being deleted, skip it
+                object_index[i][objid] = hasp_find_obj_from_parent_id(haspPages.get_obj(i), objid);
+                obj->user_data.id      = objid;
+            }
+            return;
+        }
+    }
+}
+
+// Forget all objects of a page, used when the page is cleaned or replaced
+void object_index_clear(uint8_t pageid)
+{
+    if(lv_obj_t** table = object_index_get_table(pageid, false)) {
+        memset(table, 0, (UINT8_MAX + 1) * sizeof(lv_obj_t*));
+    }
+    if(pageid <= HASP_NUM_PAGES) object_index_duplicates[pageid] = false;
+}
+
 // Return the object with a specific pageid and objid
 lv_obj_t* hasp_find_obj_from_page_id(uint8_t pageid, uint8_t objid)
 {
-    return hasp_find_obj_from_parent_id(haspPages.get_obj(pageid), objid);
+    lv_obj_t* page = haspPages.get_obj(pageid);
+    if(objid == 0 || page == nullptr) return page;
+    if(pageid > HASP_NUM_PAGES) return hasp_find_obj_from_parent_id(page, objid); // not indexed
+
+    lv_obj_t** table = object_index_get_table(pageid, false);
+    lv_obj_t* obj    = table ? table[objid] : NULL;
+
+#if defined(HASP_DEBUG_OBJ_INDEX)
+    lv_obj_t* test = hasp_find_obj_from_parent_id(page, objid);
+    if(test != obj) {
+        LOG_ERROR(TAG_HASP, F(D_OBJECT_MISMATCH " " HASP_OBJECT_NOTATION), pageid, objid);
+    }
+#endif
+
+    return obj;
+}
+
+// ##################### Group Index ########################################################
+
+#define HASP_NUM_GROUPS 16 // groupid is a 4-bit field, group 0 means no group
+
+struct hasp_group_members_t
+{
+    lv_obj_t** objs;
+    uint16_t count;
+    uint16_t size;
+};
+
+/* Objects are listed by their groupid so group updates don't need to walk the object tree of every page */
+static hasp_group_members_t group_index[HASP_NUM_GROUPS];
+
+// Add an object to the member list of its current groupid
+void object_group_add(lv_obj_t* obj)
+{
+    if(!obj || obj->user_data.groupid == 0) return;
+
+    hasp_group_members_t& group = group_index[obj->user_data.groupid];
+    if(group.count == group.size) {
+        uint16_t size   = group.size ? group.size * 2 : 4;
+        lv_obj_t** objs = (lv_obj_t**)hasp_realloc(group.objs, size * sizeof(lv_obj_t*));
+        if(!objs) {
+            LOG_ERROR(TAG_HASP, F(D_ERROR_OUT_OF_MEMORY));
+            return;
+        }
+        group.objs = objs;
+        group.size = size;
+    }
+    group.objs[group.count++] = obj;
+}
+
+// Remove an object from the member list of its current groupid
+void object_group_remove(const lv_obj_t* obj)
+{
+    if(!obj || obj->user_data.groupid == 0) return;
+
+    hasp_group_members_t& group = group_index[obj->user_data.groupid];
+    for(uint16_t i = 0; i < group.count; i++) {
+        if(group.objs[i] == obj) {
+            group.objs[i] = group.objs[--group.count]; // order doesn't matter
+            return;
+        }
+    }
+}
+
+// Forget the group members on a page, used when the page is cleaned or replaced
+void object_group_clear(uint8_t pageid)
+{
+    lv_obj_t* page = haspPages.get_obj(pageid);
+    if(!page) return;
+
+    for(uint8_t g = 1; g < HASP_NUM_GROUPS; g++) {
+        hasp_group_members_t& group = group_index[g];
+        for(uint16_t i = 0; i < group.count;) {
+            if(lv_obj_get_screen(group.objs[i]) == page)
+                group.objs[i] = group.objs[--group.count];
+            else
+                i++;
+        }
+    }
 }
 
 // Return the pageid and objid of an object
@@ -106,57 +245,71 @@ void hasp_object_tree(const lv_obj_t* parent, uint8_t pageid, uint16_t level)
 
 // ##################### Value Dispatchers ########################################################
 
-/* Sends the data out on the state/pxby topic */
-void object_dispatch_state(uint8_t pageid, uint8_t btnid, const char* payload)
+#ifndef HASP_OBJECT_TOPIC_CACHE_SIZE
+#define HASP_OBJECT_TOPIC_CACHE_SIZE 4 // Number of object topics kept formatted, must be a power of 2
+#endif
+
+struct hasp_object_topic_t
 {
-    char topic[64];
-    char* pagename = haspPages.get_name(pageid);
-    if(pagename)
-        snprintf_P(topic, sizeof(topic), PSTR("%s.b%u"), pagename, btnid);
-    else
-        snprintf_P(topic, sizeof(topic), PSTR(HASP_OBJECT_NOTATION), pageid, btnid);
-    dispatch_state_subtopic(topic, payload);
-}
+    uint8_t pageid;
+    uint8_t objid;
+    char topic[64]; // empty if unused
+};
 
-// ##################### State Changers ########################################################
+/* Recently used state topics, so objects sending many events don't format their topic every time */
+static hasp_object_topic_t object_topics[HASP_OBJECT_TOPIC_CACHE_SIZE];
 
-// Recursive function that goes over all objects only ONCE
-void object_set_group_values(lv_obj_t* parent, hasp_update_value_t& value)
+// Forget the cached topics, called when a page name changes
+void object_dispatch_reset_topics()
 {
-    if(parent == nullptr) return;
+    for(uint8_t i = 0; i < HASP_OBJECT_TOPIC_CACHE_SIZE; i++) object_topics[i].topic[0] = '\0';
+}
 
-    // Update object if it's in the same group
-    if(value.group == parent->user_data.groupid && value.obj != parent) {
-        attribute_set_normalized_value(parent, value);
+/* Sends the data out on the state/pxby topic */
+void object_dispatch_state(uint8_t pageid, uint8_t btnid, const char* payload)
+{
+    if(!payload) {
+        LOG_WARNING(TAG_HASP, F("Payload of " HASP_OBJECT_NOTATION " is too long"), pageid, btnid);
+        return;
     }
 
-    /* check tabs */
-    if(obj_get_type(parent) == LV_HASP_TABVIEW) {
-        uint16_t tabcount = lv_tabview_get_tab_count(parent);
-        for(uint16_t i = 0; i < tabcount; i++) {
-            lv_obj_t* tab = lv_tabview_get_tab(parent, i);
-            object_set_group_values(tab, value);
-        }
-    } else {
-        lv_obj_t* child;
-        child = lv_obj_get_child(parent, NULL);
-        while(child) {
-            object_set_group_values(child, value);
-            child = lv_obj_get_child(parent, child);
-        }
+    hasp_object_topic_t& entry = object_topics[(pageid ^ btnid) & (HASP_OBJECT_TOPIC_CACHE_SIZE - 1)];
+    if(entry.topic[0] == '\0' || entry.pageid != pageid || entry.objid != btnid) {
+        char* pagename = haspPages.get_name(pageid);
+        if(pagename)
+            snprintf_P(entry.topic, sizeof(entry.topic), PSTR("%s.b%u"), pagename, btnid);
+        else
+            snprintf_P(entry.topic, sizeof(entry.topic), PSTR(HASP_OBJECT_NOTATION), pageid, btnid);
+        entry.pageid = pageid;
+        entry.objid  = btnid;
     }
+    dispatch_state_subtopic(entry.topic, payload);
 }
 
+// ##################### State Changers ########################################################
+
 // SHOULD only by called from DISPATCH
 void object_set_normalized_group_values(hasp_update_value_t& value)
 {
-    if(value.group == 0 || value.min == value.max) return;
+    if(value.group == 0 || value.group >= HASP_NUM_GROUPS || value.min == value.max) return;
 
-    uint8_t page = haspPages.get();
-    object_set_group_values(haspPages.get_obj(page), value); // Update visible objects first
+    hasp_group_members_t& group = group_index[value.group];
+    lv_obj_t* screen            = lv_scr_act();
 
-    for(uint8_t i = 0; i < HASP_NUM_PAGES; i++) {
-        if(i != page) object_set_group_values(haspPages.get_obj(i), value);
+    // Update visible objects first
+    for(uint16_t i = 0; i < group.count; i++) {
+        lv_obj_t* obj = group.objs[i];
+        if(obj != value.obj && lv_obj_get_screen(obj) == screen) attribute_set_normalized_value(obj, value);
+    }
+    for(uint16_t i = 0; i < group.count; i++) {
+        lv_obj_t* obj = group.objs[i];
+        if(obj != value.obj && lv_obj_get_screen(obj) != screen) {
+#if HASP_LAZY_PAGES
+            uint8_t pageid;
+            if(haspPages.get_id(obj, &pageid)) haspPages.pin(pageid); // the new value is not in the shadow store
+#endif
+            attribute_set_normalized_value(obj, value);
+        }
     }
 }
 
@@ -165,6 +318,11 @@ void object_set_normalized_group_values(hasp_update_value_t& value)
 // Used in the dispatcher
 void hasp_process_attribute(uint8_t pageid, uint8_t objid, const char* attr, const char* payload, bool update)
 {
+#if HASP_LAZY_PAGES
+    // Updates of lazy pages are kept in the shadow store, to replay them when the page is (re)built
+    if(update && haspPages.shadow_attribute(pageid, objid, attr, payload)) return;
+#endif
+
     if(lv_obj_t* obj = hasp_find_obj_from_page_id(pageid, objid)) {
         hasp_process_obj_attribute(obj, attr, payload, update); // || strlen(payload) > 0);
     } else {
@@ -174,33 +332,62 @@ void hasp_process_attribute(uint8_t pageid, uint8_t objid, const char* attr, con
 
 // ##################### Object Creator ########################################################
 
+#if HASP_TARGET_PC || defined(ESP32)
+#define JSON_VALUE_STRING(value) value.as<std::string>()
+#else
+#define JSON_VALUE_STRING(value) value.as<String>()
+#endif
+
 // Called from hasp_new_object or TAG_JSON to process all attributes
+// The attributes are applied in document order as one batch, the visibility last. The intermediate states are not
+// invalidated, so a multi-key update only causes a single redraw of the object.
 int hasp_parse_json_attributes(lv_obj_t* obj, const JsonObject& doc)
 {
     int i = 0;
+    const char* hidden_key = NULL;
 
 #if HASP_TARGET_PC || defined(ESP32)
     std::string v;
+#else
+    String v((char*)0);
+#endif
     v.reserve(64);
 
+    // A hidden object is not invalidated by lvgl, so hide it while the attributes are applied
+    bool was_hidden = lv_obj_get_hidden(obj);
+    if(!was_hidden) {
+        lv_obj_invalidate(obj); // the area before the update
+        obj->hidden = 1;        // don't use lv_obj_set_hidden, it signals the parent
+    }
+
     for(JsonPair keyValue : doc) {
-        // LOG_VERBOSE(TAG_HASP, F(D_BULLET "%s=%s"), keyValue.key().c_str(),
-        // keyValue.value().as<std::string>().c_str());
-        v = keyValue.value().as<std::string>();
-        hasp_process_obj_attribute(obj, keyValue.key().c_str(), keyValue.value().as<std::string>().c_str(), true);
+        const char* key = keyValue.key().c_str();
+        // LOG_VERBOSE(TAG_HASP, F(D_BULLET "%s=%s"), key, JSON_VALUE_STRING(keyValue.value()).c_str());
+
+        switch(Parser::get_sdbm(key)) {
+            case ATTR_VIS:
+            case ATTR_HIDDEN:
+                hidden_key = key;
+                continue;
+        }
+
+        v = JSON_VALUE_STRING(keyValue.value());
+        hasp_process_obj_attribute(obj, key, v.c_str(), true);
         i++;
     }
-#else
-    String v((char*)0);
-    v.reserve(64);
 
-    for(JsonPair keyValue : doc) {
-        // LOG_DEBUG(TAG_HASP, F(D_BULLET "%s=%s"), keyValue.key().c_str(), keyValue.value().as<String>().c_str());
-        v = keyValue.value().as<String>();
-        hasp_process_obj_attribute(obj, keyValue.key().c_str(), keyValue.value().as<String>().c_str(), true);
+    if(!was_hidden) {
+        obj->hidden = 0;
+        lv_obj_invalidate(obj); // the area after the update
+    }
+
+    /* Visibility */
+    if(hidden_key) {
+        v = JSON_VALUE_STRING(doc[hidden_key]);
+        hasp_process_obj_attribute(obj, hidden_key, v.c_str(), true);
         i++;
     }
-#endif
+
     // LOG_DEBUG(TAG_HASP, F("%d keys processed"), i);
     return i;
 }
@@ -245,11 +432,14 @@ void hasp_new_object(const JsonObject& config, uint8_t& saved_page_id)
     } else {
         saved_page_id = pageid; /* save the current pageid for next objects */
     }
+#if HASP_LAZY_PAGES
+    haspPages.pin(pageid); // the page can not be rebuilt from the file without this object
+#endif
 
     /* A custom parentid was set */
     if(!config[FPSTR(FP_PARENTID)].isNull()) {
         uint8_t parentid = config[FPSTR(FP_PARENTID)].as<uint8_t>();
-        parent_obj       = hasp_find_obj_from_parent_id(parent_obj, parentid);
+        parent_obj       = hasp_find_obj_from_page_id(pageid, parentid);
         if(!parent_obj) {
             LOG_WARNING(TAG_HASP, F("Parent ID " HASP_OBJECT_NOTATION " not found, skipping..."), pageid, parentid);
             return;
@@ -259,474 +449,483 @@ void hasp_new_object(const JsonObject& config, uint8_t& saved_page_id)
         config.remove(FPSTR(FP_PARENTID));
     }
 
-    uint16_t sdbm = 0;
-    uint8_t id    = config[FPSTR(FP_ID)].as<uint8_t>();
+    uint8_t id = config[FPSTR(FP_ID)].as<uint8_t>();
     config.remove(FPSTR(FP_ID));
 
-    /* Create the object if it does not exist */
-    lv_obj_t* obj = hasp_find_obj_from_parent_id(parent_obj, id);
+    /* Create the object if it does not exist, objids are unique per page */
+    lv_obj_t* obj = id ? hasp_find_obj_from_page_id(pageid, id) : parent_obj;
     if(!obj) {
 
-        /* Create the object first */
-
         /* Validate type */
-       // if(config[FPSTR(FP_OBJID)].isNull()) { // TODO: obsolete objid
-            if(config[FPSTR(FP_OBJ)].isNull()) {
-                return; // comments
-            } else {
-                sdbm = Parser::get_sdbm(config[FPSTR(FP_OBJ)].as<const char*>());
-                config.remove(FPSTR(FP_OBJ));
-            }
-        // } else {
-        //     LOG_WARNING(TAG_HASP, F(D_ATTRIBUTE_OBSOLETE D_ATTRIBUTE_INSTEAD), "objid",
-        //                 "obj"); // TODO: obsolete objid
-        //     sdbm = config[FPSTR(FP_OBJID)].as<uint8_t>();
-        //     config.remove(FPSTR(FP_OBJID));
-        // }
-
-        switch(sdbm) {
-                /* ----- Custom Objects ------ */
-            case LV_HASP_ALARM:
-            case HASP_OBJ_ALARM:
-                obj = lv_obj_create(parent_obj, NULL);
-                if(obj) obj->user_data.objid = LV_HASP_ALARM;
-                break;
-
-            /* ----- Basic Objects ------ */
-            case LV_HASP_BTNMATRIX:
-            case HASP_OBJ_BTNMATRIX:
-                obj = lv_btnmatrix_create(parent_obj, NULL);
-                if(obj) {
-                    lv_btnmatrix_set_recolor(obj, true);
-                    if(obj_check_type(parent_obj, LV_HASP_ALARM))
-                        lv_obj_set_event_cb(obj, alarm_event_handler);
-                    else
-                        lv_obj_set_event_cb(obj, btnmatrix_event_handler);
-
-                    lv_btnmatrix_ext_t* ext = (lv_btnmatrix_ext_t*)lv_obj_get_ext_attr(obj);
-                    btnmatrix_default_map   = ext->map_p; // store the static pointer to the default lvgl btnmap
-                    obj->user_data.objid    = LV_HASP_BTNMATRIX;
-                }
-                break;
-
-#if LV_USE_TABLE > 0
-            case LV_HASP_TABLE:
-            case HASP_OBJ_TABLE:
-                obj = lv_table_create(parent_obj, NULL);
-                if(obj) {
-                    lv_obj_set_event_cb(obj, selector_event_handler);
-                    obj->user_data.objid = LV_HASP_TABLE;
-                }
-                break;
-#endif
-
-            case LV_HASP_BUTTON:
-            case HASP_OBJ_BTN:
-                obj = lv_btn_create(parent_obj, NULL);
-                if(obj) {
-                    lv_obj_t* lbl = lv_label_create(obj, NULL);
-                    if(lbl) {
-                        lv_label_set_text(lbl, "");
-                        lv_label_set_recolor(lbl, true);
-                        lbl->user_data.objid = LV_HASP_LABEL;
-                        lv_obj_align(lbl, NULL, LV_ALIGN_CENTER, 0, 0);
-                    }
-                    lv_obj_set_event_cb(obj, generic_event_handler);
-                    obj->user_data.objid = LV_HASP_BUTTON;
-                }
-                break;
-
-            case LV_HASP_CHECKBOX:
-            case HASP_OBJ_CHECKBOX:
-                obj = lv_checkbox_create(parent_obj, NULL);
-                if(obj) {
-                    lv_obj_set_event_cb(obj, toggle_event_handler);
-                    obj->user_data.objid = LV_HASP_CHECKBOX;
-                }
-                break;
-
-            case LV_HASP_LABEL:
-            case HASP_OBJ_LABEL:
-                obj = lv_label_create(parent_obj, NULL);
-                if(obj) {
-                    lv_label_set_long_mode(obj, LV_LABEL_LONG_CROP);
-                    lv_label_set_recolor(obj, true);
-                    lv_obj_set_event_cb(obj, generic_event_handler);
-                    obj->user_data.objid = LV_HASP_LABEL;
+        if(config[FPSTR(FP_OBJ)].isNull()) {
+            return; // comments
+        }
 
-                    // if(id >= 250) object_add_task(obj, event_timer_clock, 1000);
-                }
-                break;
+        uint16_t sdbm = Parser::get_sdbm(config[FPSTR(FP_OBJ)].as<const char*>());
+        config.remove(FPSTR(FP_OBJ));
 
-            case LV_HASP_TEXTAREA:
-            case HASP_OBJ_TEXTAREA:
-                obj = lv_textarea_create(parent_obj, NULL);
-                if(obj) {
-                    lv_obj_set_event_cb(obj, textarea_event_handler);
-                    lv_textarea_set_cursor_click_pos(obj, true);
-                    obj->user_data.objid = LV_HASP_TEXTAREA;
-                }
-                break;
+        obj = hasp_create_object(parent_obj, pageid, id, sdbm);
+        if(!obj) return;
+    }
 
-            case LV_HASP_IMAGE:
-            case HASP_OBJ_IMG:
-                obj = lv_img_create(parent_obj, NULL);
-                if(obj) {
-                    lv_obj_set_event_cb(obj, generic_event_handler);
-                    obj->user_data.objid = LV_HASP_IMAGE;
-                }
-                break;
+    hasp_parse_json_attributes(obj, config);
+}
 
-            case LV_HASP_ARC:
-            case HASP_OBJ_ARC:
-                obj = lv_arc_create(parent_obj, NULL);
-                if(obj) {
-                    lv_obj_set_event_cb(obj, generic_event_handler);
-                    obj->user_data.objid = LV_HASP_ARC;
-                }
-                break;
+/**
+ * Create a new object on a page
+ * @param parent_obj lv_obj_t*: the parent of the new object
+ * @param pageid uint8_t: the page of the new object
+ * @param id uint8_t: the id of the new object, unique per page
+ * @param type uint16_t: the lv_hasp_obj_type_t or the sdbm hash of the object type name
+ * @return the new object or NULL if it could not be created
+ */
+lv_obj_t* hasp_create_object(lv_obj_t* parent_obj, uint8_t pageid, uint8_t id, uint16_t type)
+{
+    lv_obj_t* obj = NULL;
+
+    switch(type) {
+            /* ----- Custom Objects ------ */
+        case LV_HASP_ALARM:
+        case HASP_OBJ_ALARM:
+            obj = lv_obj_create(parent_obj, NULL);
+            if(obj) obj->user_data.objid = LV_HASP_ALARM;
+            break;
+
+        /* ----- Basic Objects ------ */
+        case LV_HASP_BTNMATRIX:
+        case HASP_OBJ_BTNMATRIX:
+            obj = lv_btnmatrix_create(parent_obj, NULL);
+            if(obj) {
+                lv_btnmatrix_set_recolor(obj, true);
+                if(obj_check_type(parent_obj, LV_HASP_ALARM))
+                    lv_obj_set_event_cb(obj, alarm_event_handler);
+                else
+                    lv_obj_set_event_cb(obj, btnmatrix_event_handler);
+
+                lv_btnmatrix_ext_t* ext = (lv_btnmatrix_ext_t*)lv_obj_get_ext_attr(obj);
+                btnmatrix_default_map   = ext->map_p; // store the static pointer to the default lvgl btnmap
+                obj->user_data.objid    = LV_HASP_BTNMATRIX;
+            }
+            break;
 
-            case LV_HASP_CONTAINER:
-            case HASP_OBJ_CONT:
-                obj = lv_cont_create(parent_obj, NULL);
-                if(obj) {
-                    lv_obj_set_event_cb(obj, generic_event_handler);
-                    obj->user_data.objid = LV_HASP_CONTAINER;
-                }
-                break;
+#if LV_USE_TABLE > 0
+        case LV_HASP_TABLE:
+        case HASP_OBJ_TABLE:
+            obj = lv_table_create(parent_obj, NULL);
+            if(obj) {
+                lv_obj_set_event_cb(obj, selector_event_handler);
+                obj->user_data.objid = LV_HASP_TABLE;
+            }
+            break;
+#endif
 
-            case LV_HASP_OBJECT:
-            case HASP_OBJ_OBJ:
-                obj = lv_obj_create(parent_obj, NULL);
-                if(obj) {
-                    lv_obj_set_event_cb(obj, generic_event_handler);
-                    obj->user_data.objid = LV_HASP_OBJECT;
+        case LV_HASP_BUTTON:
+        case HASP_OBJ_BTN:
+            obj = lv_btn_create(parent_obj, NULL);
+            if(obj) {
+                lv_obj_t* lbl = lv_label_create(obj, NULL);
+                if(lbl) {
+                    lv_label_set_text(lbl, "");
+                    lv_label_set_recolor(lbl, true);
+                    lbl->user_data.objid = LV_HASP_LABEL;
+                    lv_obj_align(lbl, NULL, LV_ALIGN_CENTER, 0, 0);
                 }
-                break;
+                lv_obj_set_event_cb(obj, generic_event_handler);
+                obj->user_data.objid = LV_HASP_BUTTON;
+            }
+            break;
+
+        case LV_HASP_CHECKBOX:
+        case HASP_OBJ_CHECKBOX:
+            obj = lv_checkbox_create(parent_obj, NULL);
+            if(obj) {
+                lv_obj_set_event_cb(obj, toggle_event_handler);
+                obj->user_data.objid = LV_HASP_CHECKBOX;
+            }
+            break;
+
+        case LV_HASP_LABEL:
+        case HASP_OBJ_LABEL:
+            obj = lv_label_create(parent_obj, NULL);
+            if(obj) {
+                lv_label_set_long_mode(obj, LV_LABEL_LONG_CROP);
+                lv_label_set_recolor(obj, true);
+                lv_obj_set_event_cb(obj, generic_event_handler);
+                obj->user_data.objid = LV_HASP_LABEL;
+
+                // if(id >= 250) object_add_task(obj, event_timer_clock, 1000);
+            }
+            break;
+
+        case LV_HASP_TEXTAREA:
+        case HASP_OBJ_TEXTAREA:
+            obj = lv_textarea_create(parent_obj, NULL);
+            if(obj) {
+                lv_obj_set_event_cb(obj, textarea_event_handler);
+                lv_textarea_set_cursor_click_pos(obj, true);
+                obj->user_data.objid = LV_HASP_TEXTAREA;
+            }
+            break;
+
+        case LV_HASP_IMAGE:
+        case HASP_OBJ_IMG:
+            obj = lv_img_create(parent_obj, NULL);
+            if(obj) {
+                lv_obj_set_event_cb(obj, generic_event_handler);
+                obj->user_data.objid = LV_HASP_IMAGE;
+            }
+            break;
+
+        case LV_HASP_ARC:
+        case HASP_OBJ_ARC:
+            obj = lv_arc_create(parent_obj, NULL);
+            if(obj) {
+                lv_obj_set_event_cb(obj, generic_event_handler);
+                obj->user_data.objid = LV_HASP_ARC;
+            }
+            break;
+
+        case LV_HASP_CONTAINER:
+        case HASP_OBJ_CONT:
+            obj = lv_cont_create(parent_obj, NULL);
+            if(obj) {
+                lv_obj_set_event_cb(obj, generic_event_handler);
+                obj->user_data.objid = LV_HASP_CONTAINER;
+            }
+            break;
+
+        case LV_HASP_OBJECT:
+        case HASP_OBJ_OBJ:
+            obj = lv_obj_create(parent_obj, NULL);
+            if(obj) {
+                lv_obj_set_event_cb(obj, generic_event_handler);
+                obj->user_data.objid = LV_HASP_OBJECT;
+            }
+            break;
 
 #if LVGL_VERSION_MAJOR == 7 && LV_USE_PAGE
-            case LV_HASP_PAGE:
-            case HASP_OBJ_PAGE:
-                obj = lv_page_create(parent_obj, NULL);
-                if(obj) obj->user_data.objid = LV_HASP_PAGE;
-                // No event handler for pages
-                break;
+        case LV_HASP_PAGE:
+        case HASP_OBJ_PAGE:
+            obj = lv_page_create(parent_obj, NULL);
+            if(obj) obj->user_data.objid = LV_HASP_PAGE;
+            // No event handler for pages
+            break;
 #endif
 
 #if LV_USE_WIN && LVGL_VERSION_MAJOR == 7
-            case LV_HASP_WINDOW:
-            case HASP_OBJ_WIN:
-                obj = lv_win_create(parent_obj, NULL);
-                if(obj) obj->user_data.objid = LV_HASP_WINDOW;
-                // No event handler for pages
-                break;
+        case LV_HASP_WINDOW:
+        case HASP_OBJ_WIN:
+            obj = lv_win_create(parent_obj, NULL);
+            if(obj) obj->user_data.objid = LV_HASP_WINDOW;
+            // No event handler for pages
+            break;
 
 #endif
 
 #if LVGL_VERSION_MAJOR == 8
-            case LV_HASP_LED:
-            case HASP_OBJ_LED:
-                obj = lv_led_create(parent_obj);
-                if(obj) {
-                    lv_obj_set_event_cb(obj, generic_event_handler);
-                    obj->user_data.objid = LV_HASP_LED;
-                }
-                break;
-
-            case LV_HASP_TILEVIEW:
-            case HASP_OBJ_TILEVIEW:
-                obj = lv_tileview_create(parent_obj);
-                if(obj) obj->user_data.objid = LV_HASP_TILEVIEW;
-                // No event handler for tileviews
-                break;
-
-            case LV_HASP_TABVIEW:
-            case HASP_OBJ_TABVIEW:
-                obj = lv_tabview_create(parent_obj, LV_DIR_TOP, 100);
-                // No event handler for tabs
-                if(obj) {
-                    lv_obj_set_event_cb(obj, selector_event_handler);
-                    obj->user_data.objid = LV_HASP_TABVIEW;
-                }
-                break;
+        case LV_HASP_LED:
+        case HASP_OBJ_LED:
+            obj = lv_led_create(parent_obj);
+            if(obj) {
+                lv_obj_set_event_cb(obj, generic_event_handler);
+                obj->user_data.objid = LV_HASP_LED;
+            }
+            break;
+
+        case LV_HASP_TILEVIEW:
+        case HASP_OBJ_TILEVIEW:
+            obj = lv_tileview_create(parent_obj);
+            if(obj) obj->user_data.objid = LV_HASP_TILEVIEW;
+            // No event handler for tileviews
+            break;
+
+        case LV_HASP_TABVIEW:
+        case HASP_OBJ_TABVIEW:
+            obj = lv_tabview_create(parent_obj, LV_DIR_TOP, 100);
+            // No event handler for tabs
+            if(obj) {
+                lv_obj_set_event_cb(obj, selector_event_handler);
+                obj->user_data.objid = LV_HASP_TABVIEW;
+            }
+            break;
 
 #else
-            case LV_HASP_LED:
-            case HASP_OBJ_LED:
-                obj = lv_led_create(parent_obj, NULL);
-                if(obj) {
-                    lv_obj_set_event_cb(obj, generic_event_handler);
-                    obj->user_data.objid = LV_HASP_LED;
-                }
-                break;
+        case LV_HASP_LED:
+        case HASP_OBJ_LED:
+            obj = lv_led_create(parent_obj, NULL);
+            if(obj) {
+                lv_obj_set_event_cb(obj, generic_event_handler);
+                obj->user_data.objid = LV_HASP_LED;
+            }
+            break;
 
 #if LV_USE_TILEVIEW > 0
-            case LV_HASP_TILEVIEW:
-            case HASP_OBJ_TILEVIEW:
-                obj = lv_tileview_create(parent_obj, NULL);
-                if(obj) obj->user_data.objid = LV_HASP_TILEVIEW;
+        case LV_HASP_TILEVIEW:
+        case HASP_OBJ_TILEVIEW:
+            obj = lv_tileview_create(parent_obj, NULL);
+            if(obj) obj->user_data.objid = LV_HASP_TILEVIEW;
 
-                // No event handler for tileviews
-                break;
+            // No event handler for tileviews
+            break;
 #endif
 
-            case LV_HASP_TABVIEW:
-            case HASP_OBJ_TABVIEW:
-                obj = lv_tabview_create(parent_obj, NULL);
-                // No event handler for tabs
+        case LV_HASP_TABVIEW:
+        case HASP_OBJ_TABVIEW:
+            obj = lv_tabview_create(parent_obj, NULL);
+            // No event handler for tabs
+            if(obj) {
+                lv_obj_set_event_cb(obj, selector_event_handler);
+                obj->user_data.objid = LV_HASP_TABVIEW;
+            }
+            break;
+
+        case LV_HASP_TAB:
+        case HASP_OBJ_TAB:
+            if(parent_obj && parent_obj->user_data.objid == LV_HASP_TABVIEW) {
+                obj = lv_tabview_add_tab(parent_obj, "Tab");
                 if(obj) {
-                    lv_obj_set_event_cb(obj, selector_event_handler);
-                    obj->user_data.objid = LV_HASP_TABVIEW;
-                }
-                break;
-
-            case LV_HASP_TAB:
-            case HASP_OBJ_TAB:
-                if(parent_obj && parent_obj->user_data.objid == LV_HASP_TABVIEW) {
-                    obj = lv_tabview_add_tab(parent_obj, "Tab");
-                    if(obj) {
-                        lv_obj_set_event_cb(obj, generic_event_handler);
-                        obj->user_data.objid = LV_HASP_TAB;
-                    }
-                } else {
-                    LOG_WARNING(TAG_HASP, F("Parent of a tab must be a tabview object"));
-                    return;
+                    lv_obj_set_event_cb(obj, generic_event_handler);
+                    obj->user_data.objid = LV_HASP_TAB;
                 }
-                break;
+            } else {
+                LOG_WARNING(TAG_HASP, F("Parent of a tab must be a tabview object"));
+                return NULL;
+            }
+            break;
 
 #endif
-            /* ----- Color Objects ------ */
-            case LV_HASP_CPICKER:
-            case HASP_OBJ_CPICKER:
-                obj = lv_cpicker_create(parent_obj, NULL);
-                if(obj) {
-                    lv_obj_set_event_cb(obj, cpicker_event_handler);
-                    obj->user_data.objid = LV_HASP_CPICKER;
-                }
-                break;
+        /* ----- Color Objects ------ */
+        case LV_HASP_CPICKER:
+        case HASP_OBJ_CPICKER:
+            obj = lv_cpicker_create(parent_obj, NULL);
+            if(obj) {
+                lv_obj_set_event_cb(obj, cpicker_event_handler);
+                obj->user_data.objid = LV_HASP_CPICKER;
+            }
+            break;
 
 #if LV_USE_SPINNER != 0
-            case LV_HASP_SPINNER:
-            case HASP_OBJ_SPINNER:
-                obj = lv_spinner_create(parent_obj, NULL);
-                if(obj) {
-                    obj->user_data.objid = LV_HASP_SPINNER;
-                    lv_obj_set_event_cb(obj, generic_event_handler);
-                }
-                break;
+        case LV_HASP_SPINNER:
+        case HASP_OBJ_SPINNER:
+            obj = lv_spinner_create(parent_obj, NULL);
+            if(obj) {
+                obj->user_data.objid = LV_HASP_SPINNER;
+                lv_obj_set_event_cb(obj, generic_event_handler);
+            }
+            break;
 #endif
 
-            /* ----- Range Objects ------ */
-            case LV_HASP_SLIDER:
-            case HASP_OBJ_SLIDER:
-                obj = lv_slider_create(parent_obj, NULL);
-                if(obj) {
-                    lv_slider_set_range(obj, 0, 100);
-                    lv_obj_set_event_cb(obj, slider_event_handler);
-                    obj->user_data.objid = LV_HASP_SLIDER;
-                }
-                // bool knobin = config[F("knobin")].as<bool>() | true;
-                // lv_slider_set_knob_in(obj, knobin);
-                break;
-
-            case LV_HASP_GAUGE:
-            case HASP_OBJ_GAUGE:
-                obj = lv_gauge_create(parent_obj, NULL);
-                if(obj) {
-                    lv_gauge_set_range(obj, 0, 100);
-                    lv_obj_set_event_cb(obj, generic_event_handler);
-                    obj->user_data.objid = LV_HASP_GAUGE;
-                }
-                break;
-
-            case LV_HASP_LINE:
-            case HASP_OBJ_LINE:
-                obj = lv_line_create(parent_obj, NULL);
-                if(obj) {
-                    lv_obj_set_style_local_line_width(obj, LV_LINE_PART_MAIN, LV_STATE_DEFAULT, 1);
-                    lv_obj_set_event_cb(obj, delete_event_handler);
-                    obj->user_data.objid = LV_HASP_LINE;
-                }
-                break;
-
-            case LV_HASP_BAR:
-            case HASP_OBJ_BAR:
-                obj = lv_bar_create(parent_obj, NULL);
-                if(obj) {
-                    lv_bar_set_range(obj, 0, 100);
-                    lv_obj_set_event_cb(obj, generic_event_handler);
-                    obj->user_data.objid = LV_HASP_BAR;
-                }
-                break;
-
-            case LV_HASP_LINEMETER:
-            case HASP_OBJ_LMETER: // obsolete
-            case HASP_OBJ_LINEMETER:
-                obj = lv_linemeter_create(parent_obj, NULL);
-                if(obj) {
-                    lv_linemeter_set_range(obj, 0, 100);
-                    lv_obj_set_event_cb(obj, generic_event_handler);
-                    obj->user_data.objid = LV_HASP_LINEMETER;
-                }
-                break;
+        /* ----- Range Objects ------ */
+        case LV_HASP_SLIDER:
+        case HASP_OBJ_SLIDER:
+            obj = lv_slider_create(parent_obj, NULL);
+            if(obj) {
+                lv_slider_set_range(obj, 0, 100);
+                lv_obj_set_event_cb(obj, slider_event_handler);
+                obj->user_data.objid = LV_HASP_SLIDER;
+            }
+            // bool knobin = config[F("knobin")].as<bool>() | true;
+            // lv_slider_set_knob_in(obj, knobin);
+            break;
+
+        case LV_HASP_GAUGE:
+        case HASP_OBJ_GAUGE:
+            obj = lv_gauge_create(parent_obj, NULL);
+            if(obj) {
+                lv_gauge_set_range(obj, 0, 100);
+                lv_obj_set_event_cb(obj, generic_event_handler);
+                obj->user_data.objid = LV_HASP_GAUGE;
+            }
+            break;
+
+        case LV_HASP_LINE:
+        case HASP_OBJ_LINE:
+            obj = lv_line_create(parent_obj, NULL);
+            if(obj) {
+                lv_obj_set_style_local_line_width(obj, LV_LINE_PART_MAIN, LV_STATE_DEFAULT, 1);
+                lv_obj_set_event_cb(obj, delete_event_handler);
+                obj->user_data.objid = LV_HASP_LINE;
+            }
+            break;
+
+        case LV_HASP_BAR:
+        case HASP_OBJ_BAR:
+            obj = lv_bar_create(parent_obj, NULL);
+            if(obj) {
+                lv_bar_set_range(obj, 0, 100);
+                lv_obj_set_event_cb(obj, generic_event_handler);
+                obj->user_data.objid = LV_HASP_BAR;
+            }
+            break;
+
+        case LV_HASP_LINEMETER:
+        case HASP_OBJ_LMETER: // obsolete
+        case HASP_OBJ_LINEMETER:
+            obj = lv_linemeter_create(parent_obj, NULL);
+            if(obj) {
+                lv_linemeter_set_range(obj, 0, 100);
+                lv_obj_set_event_cb(obj, generic_event_handler);
+                obj->user_data.objid = LV_HASP_LINEMETER;
+            }
+            break;
 
 #if LV_USE_SPINBOX > 0
-            case LV_HASP_SPINBOX:
-            case HASP_OBJ_SPINBOX:
-                obj = lv_spinbox_create(parent_obj, NULL);
-                if(obj) {
-                    lv_spinbox_set_range(obj, 0, 100);
-                    lv_obj_set_event_cb(obj, slider_event_handler);
-                    obj->user_data.objid = LV_HASP_SPINBOX;
-                }
-                break;
+        case LV_HASP_SPINBOX:
+        case HASP_OBJ_SPINBOX:
+            obj = lv_spinbox_create(parent_obj, NULL);
+            if(obj) {
+                lv_spinbox_set_range(obj, 0, 100);
+                lv_obj_set_event_cb(obj, slider_event_handler);
+                obj->user_data.objid = LV_HASP_SPINBOX;
+            }
+            break;
 #endif
 
-            case LV_HASP_LIST:
-            case HASP_OBJ_LIST:
-                obj = lv_list_create(parent_obj, NULL);
-                if(obj) {
-                    // Callbacks are set on the individual buttons
-                    obj->user_data.objid = LV_HASP_LIST;
-                }
-                break;
+        case LV_HASP_LIST:
+        case HASP_OBJ_LIST:
+            obj = lv_list_create(parent_obj, NULL);
+            if(obj) {
+                // Callbacks are set on the individual buttons
+                obj->user_data.objid = LV_HASP_LIST;
+            }
+            break;
 
 #if LV_USE_CHART > 0
-            case LV_HASP_CHART:
-            case HASP_OBJ_CHART:
-                obj = lv_chart_create(parent_obj, NULL);
-                if(obj) {
-                    lv_chart_set_range(obj, 0, 100);
-                    lv_obj_set_event_cb(obj, generic_event_handler);
-
-                    lv_chart_add_series(obj, LV_COLOR_RED);
-                    lv_chart_add_series(obj, LV_COLOR_GREEN);
-                    lv_chart_add_series(obj, LV_COLOR_BLUE);
-
-                    lv_chart_series_t* ser = my_chart_get_series(obj, 2);
-                    lv_chart_set_next(obj, ser, 10);
-                    lv_chart_set_next(obj, ser, 20);
-                    lv_chart_set_next(obj, ser, 30);
-                    lv_chart_set_next(obj, ser, 40);
-
-                    obj->user_data.objid = LV_HASP_CHART;
-                }
-                break;
+        case LV_HASP_CHART:
+        case HASP_OBJ_CHART:
+            obj = lv_chart_create(parent_obj, NULL);
+            if(obj) {
+                lv_chart_set_range(obj, 0, 100);
+                lv_obj_set_event_cb(obj, generic_event_handler);
+
+                lv_chart_add_series(obj, LV_COLOR_RED);
+                lv_chart_add_series(obj, LV_COLOR_GREEN);
+                lv_chart_add_series(obj, LV_COLOR_BLUE);
+
+                lv_chart_series_t* ser = my_chart_get_series(obj, 2);
+                lv_chart_set_next(obj, ser, 10);
+                lv_chart_set_next(obj, ser, 20);
+                lv_chart_set_next(obj, ser, 30);
+                lv_chart_set_next(obj, ser, 40);
+
+                obj->user_data.objid = LV_HASP_CHART;
+            }
+            break;
 #endif
 
-            /* ----- On/Off Objects ------ */
-            case LV_HASP_SWITCH:
-            case HASP_OBJ_SWITCH:
-                obj = lv_switch_create(parent_obj, NULL);
-                if(obj) {
-                    lv_obj_set_event_cb(obj, toggle_event_handler);
-                    obj->user_data.objid = LV_HASP_SWITCH;
-                }
-                break;
-
-            /* ----- List Object ------- */
-            case LV_HASP_DROPDOWN:
-            case HASP_OBJ_DROPDOWN:
-                obj = lv_dropdown_create(parent_obj, NULL);
-                if(obj) {
-                    lv_dropdown_set_draw_arrow(obj, true);
-                    // lv_dropdown_set_anim_time(obj, 200);
-                    lv_obj_set_top(obj, true);
-                    // lv_obj_align(obj, NULL, LV_ALIGN_IN_TOP_MID, 0, 20);
-                    lv_obj_set_event_cb(obj, selector_event_handler);
-                    obj->user_data.objid = LV_HASP_DROPDOWN;
-                }
-                break;
-
-            case LV_HASP_ROLLER:
-            case HASP_OBJ_ROLLER:
-                obj = lv_roller_create(parent_obj, NULL);
+        /* ----- On/Off Objects ------ */
+        case LV_HASP_SWITCH:
+        case HASP_OBJ_SWITCH:
+            obj = lv_switch_create(parent_obj, NULL);
+            if(obj) {
+                lv_obj_set_event_cb(obj, toggle_event_handler);
+                obj->user_data.objid = LV_HASP_SWITCH;
+            }
+            break;
+
+        /* ----- List Object ------- */
+        case LV_HASP_DROPDOWN:
+        case HASP_OBJ_DROPDOWN:
+            obj = lv_dropdown_create(parent_obj, NULL);
+            if(obj) {
+                lv_dropdown_set_draw_arrow(obj, true);
+                // lv_dropdown_set_anim_time(obj, 200);
+                lv_obj_set_top(obj, true);
                 // lv_obj_align(obj, NULL, LV_ALIGN_IN_TOP_MID, 0, 20);
-                if(obj) {
-                    lv_roller_set_auto_fit(obj, false);
-                    lv_obj_set_event_cb(obj, selector_event_handler);
-                    obj->user_data.objid = LV_HASP_ROLLER;
-                }
-                break;
-
-            case LV_HASP_MSGBOX:
-            case HASP_OBJ_MSGBOX:
-                obj = lv_msgbox_create(parent_obj, NULL);
-                if(obj) {
-                    /* Assign default OK btnmap and enable recolor */
-                    if(msgbox_default_map) lv_msgbox_add_btns(obj, msgbox_default_map);
-                    lv_msgbox_ext_t* ext = (lv_msgbox_ext_t*)lv_obj_get_ext_attr(obj);
-                    if(ext && ext->btnm) lv_btnmatrix_set_recolor(ext->btnm, true);
-
-                    /* msgbox parameters */
-                    lv_obj_align(obj, NULL, LV_ALIGN_CENTER, 0, 0);
-                    lv_obj_set_auto_realign(obj, true);
-                    lv_obj_set_event_cb(obj, msgbox_event_handler);
-                    obj->user_data.objid = LV_HASP_MSGBOX;
-                }
-                break;
+                lv_obj_set_event_cb(obj, selector_event_handler);
+                obj->user_data.objid = LV_HASP_DROPDOWN;
+            }
+            break;
+
+        case LV_HASP_ROLLER:
+        case HASP_OBJ_ROLLER:
+            obj = lv_roller_create(parent_obj, NULL);
+            // lv_obj_align(obj, NULL, LV_ALIGN_IN_TOP_MID, 0, 20);
+            if(obj) {
+                lv_roller_set_auto_fit(obj, false);
+                lv_obj_set_event_cb(obj, selector_event_handler);
+                obj->user_data.objid = LV_HASP_ROLLER;
+            }
+            break;
+
+        case LV_HASP_MSGBOX:
+        case HASP_OBJ_MSGBOX:
+            obj = lv_msgbox_create(parent_obj, NULL);
+            if(obj) {
+                /* Assign default OK btnmap and enable recolor */
+                if(msgbox_default_map) lv_msgbox_add_btns(obj, msgbox_default_map);
+                lv_msgbox_ext_t* ext = (lv_msgbox_ext_t*)lv_obj_get_ext_attr(obj);
+                if(ext && ext->btnm) lv_btnmatrix_set_recolor(ext->btnm, true);
+
+                /* msgbox parameters */
+                lv_obj_align(obj, NULL, LV_ALIGN_CENTER, 0, 0);
+                lv_obj_set_auto_realign(obj, true);
+                lv_obj_set_event_cb(obj, msgbox_event_handler);
+                obj->user_data.objid = LV_HASP_MSGBOX;
+            }
+            break;
 
 #if LV_USE_CALENDAR > 0
-            case LV_HASP_CALENDER:
-            case HASP_OBJ_CALENDAR:
-                obj = lv_calendar_create(parent_obj, NULL);
-                // lv_obj_align(obj, NULL, LV_ALIGN_IN_TOP_MID, 0, 20);
-                if(obj) {
-                    lv_obj_set_event_cb(obj, calendar_event_handler);
-                    obj->user_data.objid = LV_HASP_CALENDER;
-
-                    object_add_task(obj, pageid, id, event_timer_calendar, 5000);
-                }
-                break;
+        case LV_HASP_CALENDER:
+        case HASP_OBJ_CALENDAR:
+            obj = lv_calendar_create(parent_obj, NULL);
+            // lv_obj_align(obj, NULL, LV_ALIGN_IN_TOP_MID, 0, 20);
+            if(obj) {
+                lv_obj_set_event_cb(obj, calendar_event_handler);
+                obj->user_data.objid = LV_HASP_CALENDER;
+
+                object_add_task(obj, pageid, id, event_timer_calendar, 5000);
+            }
+            break;
 #endif
 
-                /* ----- Other Object ------ */
-                // default:
-                //    return LOG_WARNING(TAG_HASP, F("Unsupported Object ID %u"), objid);
-        }
+            /* ----- Other Object ------ */
+            // default:
+            //    return LOG_WARNING(TAG_HASP, F("Unsupported Object ID %u"), objid);
+    }
 
-        /* No object was actually created */
-        if(!obj) {
-            LOG_ERROR(TAG_HASP, F(D_OBJECT_CREATE_FAILED), id);
-            return;
-        }
+    /* No object was actually created */
+    if(!obj) {
+        LOG_ERROR(TAG_HASP, F(D_OBJECT_CREATE_FAILED), id);
+        return NULL;
+    }
 
-        // Prevent losing press when the press is slid out of the objects.
-        // (E.g. a Button can be released out of it if it was being pressed)
-        lv_obj_add_protect(obj, LV_PROTECT_PRESS_LOST);
-        lv_obj_set_gesture_parent(obj, false);
-        lv_obj_set_click(obj, true);
+    // Prevent losing press when the press is slid out of the objects.
+    // (E.g. a Button can be released out of it if it was being pressed)
+    lv_obj_add_protect(obj, LV_PROTECT_PRESS_LOST);
+    lv_obj_set_gesture_parent(obj, false);
+    lv_obj_set_click(obj, true);
 
-        /* id tag the object */
-        obj->user_data.id = id;
+    // Objects without event handler still need to be cleaned up and removed from the index when deleted
+    if(!lv_obj_get_event_cb(obj)) lv_obj_set_event_cb(obj, delete_event_handler);
+
+    /* id tag the object */
+    obj->user_data.id = id;
+    object_index_add(pageid, obj);
 
 #ifdef HASP_DEBUG
-        uint8_t temp; // needed for debug tests
-        (void)temp;
-        /** testing start **/
-        if(!hasp_find_id_from_obj(obj, &pageid, &temp)) {
-            LOG_ERROR(TAG_HASP, F(D_OBJECT_LOST));
-            return;
-        }
+    uint8_t temp; // needed for debug tests
+    (void)temp;
+    /** testing start **/
+    if(!hasp_find_id_from_obj(obj, &pageid, &temp)) {
+        LOG_ERROR(TAG_HASP, F(D_OBJECT_LOST));
+        return NULL;
+    }
 #endif
 
-        /** verbose reporting **/
-        LOG_VERBOSE(TAG_HASP, F(D_BULLET HASP_OBJECT_NOTATION " = %s"), pageid, id, obj_get_type_name(obj));
+    /** verbose reporting **/
+    LOG_VERBOSE(TAG_HASP, F(D_BULLET HASP_OBJECT_NOTATION " = %s"), pageid, id, obj_get_type_name(obj));
 
 #ifdef HASP_DEBUG
-        /* test double-check */
-        lv_obj_t* test = hasp_find_obj_from_page_id(pageid, (uint8_t)temp);
-        if(test != obj || temp != id) {
-            LOG_ERROR(TAG_HASP, F(D_OBJECT_MISMATCH));
-            return;
-        } else {
-            // object created successfully
-        }
-#endif
-
+    /* test double-check */
+    lv_obj_t* test = hasp_find_obj_from_page_id(pageid, (uint8_t)temp);
+    if(test != obj || temp != id) {
+        LOG_ERROR(TAG_HASP, F(D_OBJECT_MISMATCH));
+        return NULL;
     } else {
-        // object already exists
+        // object created successfully
     }
+#endif
 
-    hasp_parse_json_attributes(obj, config);
+    return obj;
 }
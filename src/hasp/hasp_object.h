@@ -14,11 +14,24 @@ const char FP_OBJ[] PROGMEM      = "obj";
 const char FP_PARENTID[] PROGMEM = "parentid";
 const char FP_GROUPID[] PROGMEM  = "groupid";
 
+typedef struct hasp_font_ref_t
+{
+    struct hasp_font_ref_t* next;
+    const lv_font_t* font;
+    lv_style_property_t prop; // LV_STYLE_TEXT_FONT or LV_STYLE_VALUE_FONT
+    uint8_t part;
+    lv_state_t state;
+} hasp_font_ref_t;
+
 typedef struct
 {
     char* action;
     char* tag;
     const char* swipe;
+    hasp_font_ref_t* fonts; // loaded fonts set as local style, each holds a reference on its font
+    uint16_t event_rate;    // minimum ms between changed events, 0 = send every change
+    uint32_t event_sent;    // millis of the last changed event sent, start of the event_rate window
+    lv_task_t* event_task;  // sends the held back changed event at the end of the window
 } hasp_ext_user_data_t;
 
 typedef struct
@@ -94,14 +107,24 @@ enum lv_hasp_obj_type_t {
 };
 
 void hasp_new_object(const JsonObject& config, uint8_t& saved_page_id);
+lv_obj_t* hasp_create_object(lv_obj_t* parent_obj, uint8_t pageid, uint8_t id, uint16_t type);
 
 lv_obj_t* hasp_find_obj_from_parent_id(lv_obj_t* parent, uint8_t objid);
 lv_obj_t* hasp_find_obj_from_page_id(uint8_t pageid, uint8_t objid);
 bool hasp_find_id_from_obj(const lv_obj_t* obj, uint8_t* pageid, uint8_t* objid);
 
+void object_index_add(uint8_t pageid, lv_obj_t* obj);
+void object_index_remove(lv_obj_t* obj);
+void object_index_clear(uint8_t pageid);
+
+void object_group_add(lv_obj_t* obj);
+void object_group_remove(const lv_obj_t* obj);
+void object_group_clear(uint8_t pageid);
+
 void hasp_object_tree(const lv_obj_t* parent, uint8_t pageid, uint16_t level);
 
 void object_dispatch_state(uint8_t pageid, uint8_t btnid, const char* payload);
+void object_dispatch_reset_topics();
 
 void hasp_process_attribute(uint8_t pageid, uint8_t objid, const char* attr, const char* payload, bool update);
 int hasp_parse_json_attributes(lv_obj_t* obj, const JsonObject& doc);
@@ -5,6 +5,7 @@
 
 #include <fstream>
 #include "hasp_anim.h"
+#include "dev/device.h"
 
 #if defined(ARDUINO)
 #include "StreamUtils.h" // For EEPromStream
@@ -14,6 +15,16 @@
 #endif
 #endif // ARDUINO
 
+#if HASP_TARGET_PC
+#include <sys/stat.h>
+#endif
+
+#if defined(POSIX)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
 namespace hasp {
 
 bool Page::is_valid(uint8_t pageid)
@@ -41,9 +52,12 @@ void Page::swap(lv_obj_t* page, uint8_t id)
         return;
     }
 
+    if(_pages[id]) object_group_clear(id + PAGE_START_INDEX); // members of the previous page
+
     // Swap page objects
     lv_obj_t* prev_page_obj     = _pages[id];
     _pages[id]                  = page;
+    object_index_clear(id + PAGE_START_INDEX);
     _pages[id]->user_data.objid = LV_HASP_SCREEN;
     _pages[id]->user_data.id    = 0;
 
@@ -64,7 +78,12 @@ void Page::swap(lv_obj_t* page, uint8_t id)
 void Page::init(uint8_t start_page)
 {
     lv_obj_t* scr_act = lv_scr_act();
+    object_group_clear(0);
     lv_obj_clean(lv_layer_top());
+    object_index_clear(0);
+#if HASP_LAZY_PAGES
+    lazy_reset();
+#endif
 
     for(int i = 0; i < count(); i++) {
         lv_obj_t* page = lv_obj_create(NULL, NULL);
@@ -84,16 +103,32 @@ void Page::clear(uint8_t pageid)
     lv_obj_t* page = get_obj(pageid);
     if(page == lv_layer_top() || is_valid(pageid)) {
         LOG_TRACE(TAG_HASP, F(D_HASP_CLEAR_PAGE), pageid);
-        lv_obj_clean(page);
+        clear_objects(page, pageid);
+#if HASP_LAZY_PAGES
+        if(pageid >= PAGE_START_INDEX) lazy_forget(pageid); // the cleared objects must not come back from the file
+#endif
     } else {
         LOG_WARNING(TAG_HASP, F(D_HASP_INVALID_LAYER)); // lv_layer_sys
     }
 }
 
+void Page::clear_objects(lv_obj_t* page, uint8_t pageid)
+{
+    object_group_clear(pageid);
+    lv_obj_clean(page);
+    object_index_clear(pageid);
+    hasp_arena_release(pageid); // metadata of the deleted objects
+}
+
 void Page::set(uint8_t pageid, lv_scr_load_anim_t anim_type, uint32_t time, uint32_t delay)
 {
     if(!is_valid(pageid)) return; // produces a log warning if not between 1 and 12
 
+#if HASP_LAZY_PAGES
+    if(!is_built(pageid)) lazy_build(pageid);
+    _lazy[pageid - PAGE_START_INDEX].last_used = millis();
+#endif
+
     lv_obj_t* page = get_obj(pageid);
     if(!page) {
         // Invalid page object
@@ -163,6 +198,7 @@ void Page::set_name(uint8_t pageid, const char* name)
     }
 
     LOG_DEBUG(TAG_HASP, F("%s - %d"), __FILE__, __LINE__);
+    object_dispatch_reset_topics();
 
     if(_pagenames[pageid]) {
         hasp_free(_pagenames[pageid]);
@@ -175,6 +211,7 @@ void Page::set_name(uint8_t pageid, const char* name)
 
     LOG_DEBUG(TAG_HASP, F("%s - %d"), __FILE__, __LINE__);
     if(size > 1) {
+        // not in the page arena, the name outlives clearpage
         _pagenames[pageid] = (char*)hasp_calloc(sizeof(char), size);
         LOG_DEBUG(TAG_HASP, F("%s - %d"), __FILE__, __LINE__);
         if(_pagenames[pageid] == NULL) return;
@@ -204,6 +241,553 @@ uint8_t Page::get()
     return _current_page;
 }
 
+/* ===== Binary pages ===== */
+#if HASP_USE_SPIFFS > 0 || HASP_USE_LITTLEFS > 0 || HASP_TARGET_PC
+
+// pages.bin is compiled from pages.jsonl by tools/hasp_pages_compile.py, see the tool for the file format
+#define PAGES_BIN_VERSION 1
+#define PAGES_BIN_HEADER_SIZE 12
+#define PAGES_BIN_FLAG_PAGE 0x01
+#define PAGES_BIN_FLAG_PARENTID 0x02
+#define PAGES_BIN_FLAG_OBJ 0x04
+
+static inline uint16_t pages_bin_read16(const uint8_t* data)
+{
+    return data[0] | (data[1] << 8);
+}
+
+// Get the pages.bin filename that belongs to a .jsonl file
+static bool pages_bin_get_path(const char* pagesfile, char* path, size_t size)
+{
+    size_t len = strlen(pagesfile);
+    if(len < 6 || len + 1 > size || strcasecmp(pagesfile + len - 6, ".jsonl")) return false;
+
+    memcpy(path, pagesfile, len - 6);
+    strcpy(path + len - 6, ".bin");
+    return true;
+}
+
+// Creates the objects of a pages.bin file loaded in memory, without json parsing or attribute hashing
+static bool pages_bin_parse(const uint8_t* data, size_t len, uint8_t& saved_page_id)
+{
+    if(len < PAGES_BIN_HEADER_SIZE || memcmp(data, "HASP", 4) || data[4] != PAGES_BIN_VERSION) {
+        LOG_ERROR(TAG_HASP, F("Invalid pages.bin header"));
+        return false;
+    }
+
+    uint16_t count     = pages_bin_read16(data + 6);
+    size_t string_size = pages_bin_read16(data + 8) | ((uint32_t)pages_bin_read16(data + 10) << 16);
+    if(PAGES_BIN_HEADER_SIZE + string_size > len) return false;
+
+    /* Index the interned strings */
+    const char** strings = (const char**)hasp_malloc((count ? count : 1) * sizeof(const char*));
+    if(!strings) {
+        LOG_ERROR(TAG_HASP, F(D_ERROR_OUT_OF_MEMORY));
+        return false;
+    }
+
+    const char* str = (const char*)data + PAGES_BIN_HEADER_SIZE;
+    const char* end = str + string_size;
+    for(uint16_t i = 0; i < count; i++) {
+        const char* next = (const char*)memchr(str, '\0', end - str);
+        if(!next) {
+            hasp_free(strings);
+            return false;
+        }
+        strings[i] = str;
+        str        = next + 1;
+    }
+
+    /* Create the objects */
+    size_t pos       = PAGES_BIN_HEADER_SIZE + string_size;
+    uint16_t objects = 0;
+    bool valid       = true;
+
+    while(pos < len) {
+        if(pos + 7 > len) {
+            valid = false;
+            break;
+        }
+
+        uint8_t flags    = data[pos];
+        uint8_t pageid   = (flags & PAGES_BIN_FLAG_PAGE) ? data[pos + 1] : saved_page_id;
+        uint8_t parentid = data[pos + 2];
+        uint8_t id       = data[pos + 3];
+        uint16_t type    = pages_bin_read16(data + pos + 4);
+        uint8_t attrs    = data[pos + 6];
+        const uint8_t* attr = data + pos + 7;
+
+        pos += 7 + attrs * 6;
+        if(pos > len) {
+            valid = false;
+            break;
+        }
+
+        /* Same object resolution as hasp_new_object */
+        lv_obj_t* parent_obj = haspPages.get_obj(pageid);
+        if(!parent_obj) {
+            LOG_WARNING(TAG_HASP, F(D_OBJECT_PAGE_UNKNOWN), pageid);
+            continue;
+        }
+        saved_page_id = pageid;
+
+        if(flags & PAGES_BIN_FLAG_PARENTID) {
+            parent_obj = hasp_find_obj_from_page_id(pageid, parentid);
+            if(!parent_obj) {
+                LOG_WARNING(TAG_HASP, F("Parent ID " HASP_OBJECT_NOTATION " not found, skipping..."), pageid,
+                            parentid);
+                continue;
+            }
+        }
+
+        lv_obj_t* obj = id ? hasp_find_obj_from_page_id(pageid, id) : parent_obj;
+        if(!obj) {
+            if(!(flags & PAGES_BIN_FLAG_OBJ)) continue; // comments
+            obj = hasp_create_object(parent_obj, pageid, id, type);
+            if(!obj) continue;
+        }
+
+        for(uint8_t i = 0; i < attrs; i++, attr += 6) {
+            uint16_t name  = pages_bin_read16(attr + 2);
+            uint16_t value = pages_bin_read16(attr + 4);
+            if(name >= count || value >= count) continue;
+            hasp_process_obj_attribute(obj, strings[name], pages_bin_read16(attr), strings[value], true);
+        }
+        objects++;
+    }
+
+    hasp_free(strings);
+    if(!valid) {
+        LOG_ERROR(TAG_HASP, F("pages.bin is truncated"));
+    }
+    LOG_VERBOSE(TAG_HASP, F("%u objects loaded from pages.bin"), objects);
+    return true;
+}
+
+#if HASP_USE_SPIFFS > 0 || HASP_USE_LITTLEFS > 0
+static bool pages_bin_load(const char* pagesfile, uint8_t& saved_page_id)
+{
+#if defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_ESP8266)
+    char binfile[strlen(pagesfile) + 1];
+    if(!pages_bin_get_path(pagesfile, binfile, sizeof(binfile)) || !HASP_FS.exists(binfile)) return false;
+
+    File bin = HASP_FS.open(binfile, "r");
+    if(!bin) return false;
+
+    /* Only use pages.bin when it is newer than the jsonl file */
+    if(HASP_FS.exists(pagesfile)) {
+        File jsonl = HASP_FS.open(pagesfile, "r");
+        bool stale = jsonl && jsonl.getLastWrite() > bin.getLastWrite();
+        jsonl.close();
+        if(stale) {
+            LOG_WARNING(TAG_HASP, F("%s is older than %s, ignoring it"), binfile, pagesfile);
+            bin.close();
+            return false;
+        }
+    }
+
+    size_t len    = bin.size();
+    uint8_t* data = (uint8_t*)hasp_malloc(len);
+    if(!data) {
+        bin.close();
+        return false; // fall back to jsonl
+    }
+
+    LOG_TRACE(TAG_HASP, F(D_FILE_LOADING), binfile);
+    bool loaded = bin.read(data, len) == len && pages_bin_parse(data, len, saved_page_id);
+    bin.close();
+    hasp_free(data);
+
+    if(loaded) {
+        LOG_INFO(TAG_HASP, F(D_FILE_LOADED), binfile);
+    }
+    return loaded;
+#else
+    return false;
+#endif
+}
+
+#elif HASP_TARGET_PC
+static bool pages_bin_load(const char* pagesfile, uint8_t& saved_page_id)
+{
+    char binfile[strlen(pagesfile) + 1];
+    if(!pages_bin_get_path(pagesfile, binfile, sizeof(binfile))) return false;
+
+    /* Only use pages.bin when it is newer than the jsonl file */
+    struct stat bin_stat;
+    struct stat jsonl_stat;
+    if(stat(binfile, &bin_stat) != 0 || bin_stat.st_size <= 0) return false;
+    if(stat(pagesfile, &jsonl_stat) == 0 && jsonl_stat.st_mtime > bin_stat.st_mtime) {
+        LOG_WARNING(TAG_HASP, F("%s is older than %s, ignoring it"), binfile, pagesfile);
+        return false;
+    }
+
+    FILE* bin = fopen(binfile, "rb");
+    if(!bin) return false;
+
+    LOG_TRACE(TAG_HASP, F("Loading %s from disk..."), binfile);
+    size_t len    = bin_stat.st_size;
+    uint8_t* data = (uint8_t*)hasp_malloc(len);
+    bool loaded   = data && fread(data, 1, len, bin) == len;
+    fclose(bin);
+
+    if(loaded) loaded = pages_bin_parse(data, len, saved_page_id);
+    hasp_free(data);
+
+    if(loaded) {
+        LOG_INFO(TAG_HASP, F("Loaded %s from disk"), binfile);
+    }
+    return loaded;
+}
+#endif
+
+#endif // HASP_USE_SPIFFS || HASP_USE_LITTLEFS || HASP_TARGET_PC
+
+/* ===== Lazy pages ===== */
+#if HASP_LAZY_PAGES
+
+#define LAZY_BUFFER_SIZE (2 * MQTT_MAX_PACKET_SIZE) // maximum length of a jsonl line
+#define LAZY_SEGMENT_MAX (4 * 1024U)                // consecutive lines are merged up to this size
+
+typedef struct
+{
+    uint8_t pageid;
+    uint8_t objid;
+    uint16_t attr_hash;
+    char* attr;
+    char* payload;
+} hasp_shadow_attr_t;
+
+static hasp_shadow_attr_t shadow_store[HASP_LAZY_PAGES_SHADOW_SIZE];
+
+#if HASP_USE_SPIFFS > 0 || HASP_USE_LITTLEFS > 0
+typedef File lazy_file_t;
+
+static bool lazy_file_open(lazy_file_t& file, const char* path)
+{
+    file = HASP_FS.open(path, "r");
+    return (bool)file;
+}
+
+static size_t lazy_file_read(lazy_file_t& file, uint32_t offset, char* buffer, size_t len)
+{
+    if(!file.seek(offset)) return 0;
+    return file.read((uint8_t*)buffer, len);
+}
+
+static void lazy_file_close(lazy_file_t& file)
+{
+    file.close();
+}
+#else
+typedef FILE* lazy_file_t;
+
+static bool lazy_file_open(lazy_file_t& file, const char* path)
+{
+    file = fopen(path, "rb");
+    return file != NULL;
+}
+
+static size_t lazy_file_read(lazy_file_t& file, uint32_t offset, char* buffer, size_t len)
+{
+    if(fseek(file, offset, SEEK_SET) != 0) return 0;
+    return fread(buffer, 1, len, file);
+}
+
+static void lazy_file_close(lazy_file_t& file)
+{
+    fclose(file);
+}
+#endif
+
+static char* lazy_strdup(const char* str)
+{
+    size_t len = strlen(str) + 1;
+    char* copy = (char*)hasp_malloc(len);
+    if(copy) memcpy(copy, str, len);
+    return copy;
+}
+
+static void shadow_clear(hasp_shadow_attr_t& entry)
+{
+    hasp_free(entry.attr);
+    hasp_free(entry.payload);
+    entry.attr    = NULL;
+    entry.payload = NULL;
+}
+
+void Page::lazy_reset()
+{
+    for(uint8_t i = 0; i < HASP_NUM_PAGES; i++) {
+        hasp_free(_lazy[i].segments);
+        _lazy[i] = {.segments = NULL, .count = 0, .size = 0, .last_used = 0, .built = true, .pinned = false};
+    }
+    for(uint8_t i = 0; i < HASP_LAZY_PAGES_SHADOW_SIZE; i++) shadow_clear(shadow_store[i]);
+
+    hasp_free(_lazy_file);
+    _lazy_file     = NULL;
+    _lazy_building = false;
+}
+
+// Drop the file segments and shadowed updates of a page, it is never rebuilt from the file again
+void Page::lazy_forget(uint8_t pageid)
+{
+    hasp_lazy_page_t& page = _lazy[pageid - PAGE_START_INDEX];
+    hasp_free(page.segments);
+    page = {.segments = NULL, .count = 0, .size = 0, .last_used = 0, .built = true, .pinned = false};
+
+    for(uint8_t i = 0; i < HASP_LAZY_PAGES_SHADOW_SIZE; i++)
+        if(shadow_store[i].attr && shadow_store[i].pageid == pageid) shadow_clear(shadow_store[i]);
+}
+
+void Page::lazy_add_segment(uint8_t pageid, uint32_t offset, uint32_t length)
+{
+    hasp_lazy_page_t& page = _lazy[pageid - PAGE_START_INDEX];
+    page.built             = false;
+
+    if(page.count > 0) {
+        hasp_page_segment_t& last = page.segments[page.count - 1];
+        if(last.offset + last.length == offset && last.length + length <= LAZY_SEGMENT_MAX) {
+            last.length += length;
+            return;
+        }
+    }
+
+    if(page.count == page.size) {
+        uint16_t size = page.size ? page.size * 2 : 4;
+        hasp_page_segment_t* segments =
+            (hasp_page_segment_t*)hasp_realloc(page.segments, size * sizeof(hasp_page_segment_t));
+        if(!segments) {
+            LOG_ERROR(TAG_HASP, F(D_ERROR_OUT_OF_MEMORY));
+            return;
+        }
+        page.segments = segments;
+        page.size     = size;
+    }
+
+    page.segments[page.count++] = {.offset = offset, .length = length};
+}
+
+/**
+ * Index the jsonl lines of each page by file offset, objects of pages 1 to HASP_NUM_PAGES are built on first use
+ * Lines for the page itself (id 0) and for layers other than pages are processed immediately
+ */
+bool Page::lazy_index(const char* pagesfile, uint8_t& saved_page_id)
+{
+    lazy_file_t file;
+    if(!lazy_file_open(file, pagesfile)) return false;
+
+    char* buffer = (char*)hasp_malloc(LAZY_BUFFER_SIZE);
+    if(!buffer) {
+        lazy_file_close(file);
+        return false;
+    }
+
+    lazy_reset();
+    _lazy_file     = lazy_strdup(pagesfile);
+    _lazy_building = true; // the page properties processed below are in the file too
+    LOG_TRACE(TAG_HASP, F("Indexing %s..."), pagesfile);
+
+    StaticJsonDocument<64> filter;
+    filter[FPSTR(FP_PAGE)] = true;
+    filter[FPSTR(FP_ID)]   = true;
+    StaticJsonDocument<64> doc;
+
+    uint32_t start  = millis();
+    uint32_t offset = 0; // file offset of the start of the buffer
+    size_t len      = 0;
+    bool eof        = false;
+
+    while(!eof) {
+        size_t bytes = lazy_file_read(file, offset + len, buffer + len, LAZY_BUFFER_SIZE - len);
+        eof          = (bytes == 0);
+        len += bytes;
+
+        size_t pos = 0;
+        while(pos < len) {
+            char* newline = (char*)memchr(buffer + pos, '\n', len - pos);
+            if(!newline && !eof) break; // wait for the rest of the line
+
+            char* line  = buffer + pos;
+            size_t size = newline ? newline - line + 1 : len - pos;
+
+            /* Only the page and id keys are needed to index the line */
+            DeserializationError error =
+                deserializeJson(doc, (const char*)line, size, DeserializationOption::Filter(filter));
+
+            if(error == DeserializationError::EmptyInput) {
+                // blank line
+            } else {
+                uint8_t pageid = saved_page_id;
+                uint8_t id     = 0;
+                if(!error && doc.is<JsonObject>()) {
+                    if(!doc[FPSTR(FP_PAGE)].isNull()) pageid = doc[FPSTR(FP_PAGE)].as<uint8_t>();
+                    id = doc[FPSTR(FP_ID)].as<uint8_t>();
+                }
+
+                if(!error && id != 0 && pageid >= PAGE_START_INDEX && pageid <= HASP_NUM_PAGES) {
+                    lazy_add_segment(pageid, offset + pos, size);
+                    saved_page_id = pageid;
+                } else {
+                    dispatch_parse_jsonl(line, size, saved_page_id); // also reports invalid lines
+                }
+            }
+
+            pos += size;
+        }
+
+        if(pos == 0 && len >= LAZY_BUFFER_SIZE) {
+            LOG_ERROR(TAG_HASP, F("Line at offset %u is too long"), offset);
+            break;
+        }
+
+        len -= pos;
+        offset += pos;
+        if(len > 0 && pos > 0) memmove(buffer, buffer + pos, len);
+    }
+
+    hasp_free(buffer);
+    lazy_file_close(file);
+    _lazy_building = false;
+
+    LOG_INFO(TAG_HASP, F("Indexed %s in %u ms"), pagesfile, millis() - start);
+    return true;
+}
+
+void Page::lazy_build(uint8_t pageid)
+{
+    hasp_lazy_page_t& page = _lazy[pageid - PAGE_START_INDEX];
+    page.built             = true;
+
+    bool building  = _lazy_building;
+    _lazy_building = true;
+    uint32_t start = millis();
+    lazy_file_t file;
+    if(page.count > 0 && _lazy_file && lazy_file_open(file, _lazy_file)) {
+        uint8_t saved_page_id = pageid;
+
+        for(uint16_t i = 0; i < page.count; i++) {
+            hasp_page_segment_t& segment = page.segments[i];
+            char* buffer                 = (char*)hasp_malloc(segment.length);
+            if(!buffer) {
+                LOG_ERROR(TAG_HASP, F(D_ERROR_OUT_OF_MEMORY));
+                break;
+            }
+
+            if(lazy_file_read(file, segment.offset, buffer, segment.length) == segment.length)
+                dispatch_parse_jsonl(buffer, segment.length, saved_page_id);
+            hasp_free(buffer);
+        }
+
+        lazy_file_close(file);
+    }
+
+    /* Replay the updates received while the page was not built */
+    for(uint8_t i = 0; i < HASP_LAZY_PAGES_SHADOW_SIZE; i++) {
+        hasp_shadow_attr_t& entry = shadow_store[i];
+        if(entry.attr && entry.pageid == pageid) {
+            if(lv_obj_t* obj = hasp_find_obj_from_page_id(entry.pageid, entry.objid))
+                hasp_process_obj_attribute(obj, entry.attr, entry.attr_hash, entry.payload, true);
+        }
+    }
+    _lazy_building = building;
+
+    LOG_VERBOSE(TAG_HASP, F("Page %u built in %u ms"), pageid, millis() - start);
+}
+
+bool Page::is_built(uint8_t pageid)
+{
+    if(pageid < PAGE_START_INDEX || pageid > HASP_NUM_PAGES) return true;
+    return _lazy[pageid - PAGE_START_INDEX].built;
+}
+
+/**
+ * Keep the last value of an attribute of a lazy page, so it can be replayed when the page is (re)built
+ * @return true if the page is not built and the update can not be applied now
+ * @note when the shadow store is full, the page is built and pinned so it is never evicted
+ */
+bool Page::shadow_attribute(uint8_t pageid, uint8_t objid, const char* attr, const char* payload)
+{
+    if(pageid < PAGE_START_INDEX || pageid > HASP_NUM_PAGES || _lazy[pageid - PAGE_START_INDEX].count == 0)
+        return false;
+
+    uint16_t attr_hash        = Parser::get_sdbm(attr);
+    hasp_shadow_attr_t* entry = NULL;
+    for(uint8_t i = 0; i < HASP_LAZY_PAGES_SHADOW_SIZE; i++) {
+        hasp_shadow_attr_t& item = shadow_store[i];
+        if(item.attr && item.pageid == pageid && item.objid == objid && item.attr_hash == attr_hash &&
+           !strcmp(item.attr, attr)) {
+            entry = &item; // replace the previous value
+            break;
+        }
+        if(!item.attr && !entry) entry = &item;
+    }
+
+    bool built = is_built(pageid);
+    if(!entry) {
+        // The page can not be rebuilt from the file without losing this update, so keep it in memory
+        LOG_WARNING(TAG_HASP, F("Shadow store full, page %u is kept in memory"), pageid);
+        if(!built) lazy_build(pageid);
+        _lazy[pageid - PAGE_START_INDEX].pinned = true;
+        return false;
+    }
+
+    shadow_clear(*entry);
+    entry->pageid    = pageid;
+    entry->objid     = objid;
+    entry->attr_hash = attr_hash;
+    entry->attr      = lazy_strdup(attr);
+    entry->payload   = lazy_strdup(payload);
+    if(!entry->attr || !entry->payload) shadow_clear(*entry);
+
+    return !built;
+}
+
+/**
+ * Keep a page in memory because its objects were changed in a way the file and the shadow store don't record,
+ * like objects created by the jsonl command or values set by touch. A page that is not built is built first.
+ */
+void Page::pin(uint8_t pageid)
+{
+    if(_lazy_building || pageid < PAGE_START_INDEX || pageid > HASP_NUM_PAGES) return;
+
+    hasp_lazy_page_t& page = _lazy[pageid - PAGE_START_INDEX];
+    if(page.pinned || page.count == 0) return;
+
+    if(!page.built) lazy_build(pageid);
+    page.pinned = true;
+    LOG_VERBOSE(TAG_HASP, F("Page %u is kept in memory"), pageid);
+}
+
+// Destroy the objects of the least recently used page when lvgl memory is low
+void Page::evict()
+{
+#if LV_MEM_CUSTOM == 0
+    lv_mem_monitor_t mem_mon;
+    lv_mem_monitor(&mem_mon);
+    size_t free_size = mem_mon.free_size;
+#else
+    size_t free_size = haspDevice.get_free_heap(); // lvgl allocates from the system heap
+#endif
+    if(free_size >= HASP_LAZY_PAGES_MIN_FREE) return;
+
+    uint8_t pageid = 0;
+    for(uint8_t i = 0; i < HASP_NUM_PAGES; i++) {
+        hasp_lazy_page_t& page = _lazy[i];
+        if(!page.built || page.pinned || page.count == 0 || _pages[i] == lv_scr_act() ||
+           i + PAGE_START_INDEX == _current_page)
+            continue;
+        if(pageid == 0 || page.last_used < _lazy[pageid - PAGE_START_INDEX].last_used) pageid = i + PAGE_START_INDEX;
+    }
+    if(pageid == 0) return;
+
+    clear_objects(get_obj(pageid), pageid);
+    _lazy[pageid - PAGE_START_INDEX].built = false;
+    LOG_INFO(TAG_HASP, F("Page %u evicted, %u bytes free"), pageid, (uint32_t)free_size);
+}
+
+#endif // HASP_LAZY_PAGES
+
 void Page::load_jsonl(const char* pagesfile)
 {
     uint8_t savedPage = haspPages.get();
@@ -215,6 +799,11 @@ void Page::load_jsonl(const char* pagesfile)
         return;
     }
 
+#if HASP_LAZY_PAGES
+    if(HASP_FS.exists(pagesfile) && lazy_index(pagesfile, savedPage)) return;
+#endif
+    if(pages_bin_load(pagesfile, savedPage)) return;
+
     if(!HASP_FS.exists(pagesfile)) {
         LOG_WARNING(TAG_HASP, F(D_FILE_NOT_FOUND ": %s"), pagesfile);
         return;
@@ -250,12 +839,35 @@ void Page::load_jsonl(const char* pagesfile)
     path[1] = '/';
 #endif
 
+#if HASP_TARGET_PC
+#if HASP_LAZY_PAGES
+    if(lazy_index(path, savedPage)) return;
+#endif
+    if(pages_bin_load(path, savedPage)) return;
+#endif
+
     LOG_TRACE(TAG_HASP, F("Loading %s from disk..."), path);
+#if defined(POSIX)
+    int fd = open(path, O_RDONLY);
+    struct stat st;
+    if(fd >= 0 && fstat(fd, &st) == 0 && st.st_size > 0) {
+        // A private mapping is writable, so the file can be parsed in place without copying it
+        char* data = (char*)mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if(data != MAP_FAILED) {
+            dispatch_parse_jsonl(data, st.st_size, savedPage);
+            munmap(data, st.st_size);
+        } else {
+            LOG_ERROR(TAG_HASP, F(D_FILE_LOAD_FAILED), path);
+        }
+    }
+    if(fd >= 0) close(fd);
+#else
     std::ifstream f(path); // taking file as inputstream
     if(f) {
         dispatch_parse_jsonl(f, savedPage);
     }
     f.close();
+#endif
     LOG_INFO(TAG_HASP, F("Loaded %s from disk"), path);
 
     // char path[strlen(pagesfile) + 4];
@@ -22,6 +22,27 @@ struct hasp_page_meta_data_t
     uint8_t back : 4;
 };
 
+// Lazy pages need random access to the pages file
+#define HASP_LAZY_PAGES (HASP_USE_LAZY_PAGES > 0 && (HASP_USE_SPIFFS > 0 || HASP_USE_LITTLEFS > 0 || HASP_TARGET_PC))
+
+#if HASP_LAZY_PAGES
+struct hasp_page_segment_t
+{
+    uint32_t offset; // file offset of the first jsonl line
+    uint32_t length; // length of consecutive lines belonging to the page
+};
+
+struct hasp_lazy_page_t
+{
+    hasp_page_segment_t* segments;
+    uint16_t count;
+    uint16_t size;
+    uint32_t last_used; // millis of the last page change to this page
+    bool built;
+    bool pinned; // has changes that are not in the file or the shadow store, so it can not be rebuilt from the file
+};
+#endif
+
 namespace hasp {
 
 class Page {
@@ -31,6 +52,20 @@ class Page {
     lv_obj_t* _pages[HASP_NUM_PAGES];                 // index 0 = Page 1 etc.
     uint8_t _current_page;
 
+    void clear_objects(lv_obj_t* page, uint8_t pageid);
+
+#if HASP_LAZY_PAGES
+    hasp_lazy_page_t _lazy[HASP_NUM_PAGES]; // index 0 = Page 1 etc.
+    char* _lazy_file;
+    bool _lazy_building; // objects are being created from the file, they don't pin the page
+
+    void lazy_reset();
+    void lazy_forget(uint8_t pageid);
+    bool lazy_index(const char* pagesfile, uint8_t& saved_page_id);
+    void lazy_add_segment(uint8_t pageid, uint32_t offset, uint32_t length);
+    void lazy_build(uint8_t pageid);
+#endif
+
   public:
     Page();
     uint8_t count();
@@ -59,6 +94,13 @@ class Page {
     lv_obj_t* get_obj(uint8_t pageid);
     bool get_id(const lv_obj_t* obj, uint8_t* pageid);
     bool is_valid(uint8_t pageid);
+
+#if HASP_LAZY_PAGES
+    bool is_built(uint8_t pageid);
+    bool shadow_attribute(uint8_t pageid, uint8_t objid, const char* attr, const char* payload);
+    void pin(uint8_t pageid);
+    void evict();
+#endif
 };
 
 } // namespace hasp
@@ -55,6 +55,7 @@ const char FP_CONFIG_THEME[] PROGMEM           = "theme";
 const char FP_CONFIG_HUE[] PROGMEM             = "hue";
 const char FP_CONFIG_ZIFONT[] PROGMEM          = "font";
 const char FP_CONFIG_PAGES[] PROGMEM           = "pages";
+const char FP_CONFIG_PRELOAD[] PROGMEM         = "preload";
 const char FP_CONFIG_COLOR1[] PROGMEM          = "color1";
 const char FP_CONFIG_COLOR2[] PROGMEM          = "color2";
 const char FP_CONFIG_ENABLE[] PROGMEM          = "enable";
@@ -90,6 +91,8 @@ const char FP_GUI_BACKLIGHTINVERT[] PROGMEM    = "bcklinv";
 const char FP_GUI_POINTER[] PROGMEM            = "cursor";
 const char FP_GUI_LONG_TIME[] PROGMEM          = "long";
 const char FP_GUI_REPEAT_TIME[] PROGMEM        = "repeat";
+const char FP_GUI_VDB_SIZE[] PROGMEM           = "vdb";
+const char FP_GUI_VDB_DOUBLE[] PROGMEM         = "vdb2";
 const char FP_DEBUG_TELEPERIOD[] PROGMEM       = "tele";
 const char FP_DEBUG_ANSI[] PROGMEM             = "ansi";
 const char FP_GPIO_CONFIG[] PROGMEM            = "config";
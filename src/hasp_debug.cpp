@@ -16,10 +16,50 @@
 #elif HASP_TARGET_PC
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdarg.h>
 #include <iostream>
+#include <atomic>
+#if HASP_TARGET_PC
+#include <mutex>
+#include <condition_variable>
+#endif
+
+#ifndef HASP_LOG_LINE_SIZE
+#define HASP_LOG_LINE_SIZE 512 // longer log lines are truncated
+#endif
+
+#ifndef HASP_LOG_QUEUE_SIZE
+#define HASP_LOG_QUEUE_SIZE 256 // lines waiting for the log writer thread, must be a power of 2
+#endif
+
+#ifndef HASP_LOG_DEFERRED
+#define HASP_LOG_DEFERRED 1 // the writer thread formats lines with a constant format string
+#endif
 
-#define debug_print(io, ...) fprintf(stdout, __VA_ARGS__)
-#define debug_newline(io) fprintf(stdout, "\n")
+/* Each thread formats its log line here before it is queued for the writer thread */
+static thread_local char debug_line[HASP_LOG_LINE_SIZE];
+static thread_local size_t debug_line_len = 0;
+
+static void debug_vappend(const char* format, va_list args)
+{
+    size_t room = sizeof(debug_line) - debug_line_len;
+    int len     = vsnprintf(debug_line + debug_line_len, room, format, args);
+    if(len > 0) debug_line_len += (size_t)len < room ? len : room - 1;
+}
+
+static void debug_append(const char* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    debug_vappend(format, args);
+    va_end(args);
+}
+
+#define debug_print(io, ...) debug_append(__VA_ARGS__)
+#define debug_newline(io) debug_append("\n")
+
+/* Set by the writer thread while it formats a deferred record, the prefix then shows the time of the log call */
+static thread_local const timeval* debug_replay_time = NULL;
 
 #if defined(WINDOWS)
 #include <windows.h>
@@ -36,6 +76,7 @@
 #endif
 
 bool debugAnsiCodes = false;
+uint16_t debugTagMask[HASP_LOG_TAG_COUNT];
 
 inline void debugSendAnsiCode(const __FlashStringHelper* code, Print* _logOutput)
 {
@@ -73,9 +114,18 @@ static void debugPrintTimestamp(int level, Print* _logOutput)
 { /* Print Current Time */
 
     timeval curTime;
-    int rslt     = gettimeofday(&curTime, NULL);
-    time_t t     = curTime.tv_sec;
+#if HASP_TARGET_PC
+    int rslt = debug_replay_time ? (curTime = *debug_replay_time, 0) : gettimeofday(&curTime, NULL);
+#else
+    int rslt = gettimeofday(&curTime, NULL);
+#endif
+    time_t t = curTime.tv_sec;
+#if defined(POSIX)
+    tm timebuf;
+    tm* timeinfo = localtime_r(&t, &timebuf); // log lines are formatted on several threads
+#else
     tm* timeinfo = localtime(&t);
+#endif
     (void)rslt; // unused
 
     debugSendAnsiCode(F(TERM_COLOR_CYAN), _logOutput);
@@ -105,6 +155,10 @@ static void debugPrintTimestamp(int level, Print* _logOutput)
 
 /* ===== Default Event Processors ===== */
 
+#if HASP_TARGET_PC
+static void debug_commit(int level);
+#endif
+
 static inline void debug_flush()
 {
 #if defined(ARDUINO)
@@ -112,7 +166,7 @@ static inline void debug_flush()
 #endif
 
 #if HASP_TARGET_PC
-    fflush(stdout);
+    debug_commit(LOG_LEVEL_FATAL); // queue the pending text and wait for the writer thread
 #endif
 }
 
@@ -132,6 +186,7 @@ void debugStart(void)
     debug_newline();
     debugPrintHaspHeader(NULL);
     debug_newline();
+    debug_flush();
 
     char curdir[PATH_MAX];
     LOG_INFO(TAG_DEBG, F("Configuration directory: %s"), cwd(curdir, sizeof(curdir)));
@@ -147,7 +202,9 @@ void debugStart(void)
 }
 
 void debugStop()
-{}
+{
+    debug_flush();
+}
 
 /* ===== Special Event Processors ===== */
 
@@ -337,18 +394,85 @@ void debug_get_tag(uint8_t tag, char* buffer)
             memcpy_P(buffer, PSTR("WG  "), 5);
             break;
 
+        case TAG_VNC:
+            memcpy_P(buffer, PSTR("VNC "), 5);
+            break;
+
         default:
             memcpy_P(buffer, PSTR("----"), 5);
             break;
     }
 }
 
+/**
+ * Find the tag id of a tag name as printed in the log prefix, or a numeric tag id
+ * @param name i.e. "MQTT", "12" or "all"
+ * @return the tag id, HASP_LOG_ALL_TAGS or -1 if the name is unknown
+ */
+int16_t debugGetTagId(const char* name)
+{
+    if(!name || !*name) return -1;
+    if(!strcasecmp_P(name, PSTR("all"))) return HASP_LOG_ALL_TAGS;
+    if(Parser::is_only_digits(name)) return atoi(name) < HASP_LOG_TAG_COUNT ? atoi(name) : -1;
+
+    char buffer[10];
+    for(uint8_t tag = 0; tag < HASP_LOG_TAG_COUNT; tag++) {
+        debug_get_tag(tag, buffer);
+        for(char* c = buffer + 3; c > buffer && *c == ' '; c--) *c = '\0'; // "HAL " and "FTP "
+        if(!strcasecmp(name, buffer)) return tag;
+    }
+    return -1;
+}
+
+/**
+ * Change the runtime log level of a tag, levels above the compile-time level of the tag stay disabled
+ * @param tag the tag id or HASP_LOG_ALL_TAGS
+ * @param level the most verbose level that is still logged, LOG_LEVEL_SILENT mutes all but fatal messages
+ */
+void debugSetTagLevel(uint8_t tag, int8_t level)
+{
+    if(level < LOG_LEVEL_SILENT) level = LOG_LEVEL_SILENT;
+    uint16_t mask = level >= 15 ? 0 : (uint16_t)(0xFFFF << (level + 1)) & ~1u; // fatal messages are always kept
+
+    if(tag == HASP_LOG_ALL_TAGS) {
+        for(uint8_t i = 0; i < HASP_LOG_TAG_COUNT; i++) debugTagMask[i] = mask;
+    } else if(tag < HASP_LOG_TAG_COUNT) {
+        debugTagMask[tag] = mask;
+    }
+}
+
+/* Heap statistics for the log prefix, sampled at most once per DEBUG_MEM_SAMPLE_INTERVAL instead of every line */
+#define DEBUG_MEM_SAMPLE_INTERVAL 100 // ms
+
+static struct
+{
+    uint32_t hasp_sampled;
+    size_t maxfree;
+    size_t totalfree;
+    uint8_t frag;
+#if LV_MEM_CUSTOM == 0
+    uint32_t lvgl_sampled;
+    lv_mem_monitor_t lvgl;
+#endif
+} debug_mem = {
+    .hasp_sampled = 0u - DEBUG_MEM_SAMPLE_INTERVAL, // sample on first use
+#if LV_MEM_CUSTOM == 0
+    .lvgl_sampled = 0u - DEBUG_MEM_SAMPLE_INTERVAL,
+#endif
+};
+
 static void debugPrintHaspMemory(int level, Print* _logOutput)
 {
 #ifdef ARDUINO
-    size_t maxfree   = haspDevice.get_free_max_block();
-    size_t totalfree = haspDevice.get_free_heap();
-    uint8_t frag     = haspDevice.get_heap_fragmentation();
+    if(millis() - debug_mem.hasp_sampled >= DEBUG_MEM_SAMPLE_INTERVAL) {
+        debug_mem.maxfree      = haspDevice.get_free_max_block();
+        debug_mem.totalfree    = haspDevice.get_free_heap();
+        debug_mem.frag         = haspDevice.get_heap_fragmentation();
+        debug_mem.hasp_sampled = millis();
+    }
+    size_t maxfree   = debug_mem.maxfree;
+    size_t totalfree = debug_mem.totalfree;
+    uint8_t frag     = debug_mem.frag;
 
     /* Print HASP Memory Info */
     if(debugAnsiCodes) {
@@ -366,8 +490,15 @@ static void debugPrintHaspMemory(int level, Print* _logOutput)
 static void debugPrintLvglMemory(int level, Print* _logOutput)
 {
 #if LV_MEM_CUSTOM == 0
-    lv_mem_monitor_t mem_mon;
-    lv_mem_monitor(&mem_mon);
+    bool resample = millis() - debug_mem.lvgl_sampled >= DEBUG_MEM_SAMPLE_INTERVAL;
+#if HASP_TARGET_PC
+    if(debug_replay_time) resample = false; // the writer thread never walks the lvgl heap
+#endif
+    if(resample) {
+        lv_mem_monitor(&debug_mem.lvgl); // walks the whole lvgl heap
+        debug_mem.lvgl_sampled = millis();
+    }
+    const lv_mem_monitor_t& mem_mon = debug_mem.lvgl;
 
     /* Print LVGL Memory Info */
     if(debugAnsiCodes) {
@@ -458,3 +589,513 @@ void debugPrintPrefix(uint8_t tag, int level, Print* _logOutput)
     debug_print(_logOutput, PSTR(" %s: "), buffer);
 #endif
 }
+
+#if HASP_TARGET_PC
+/* ===== Asynchronous Log Writer ===== */
+
+/* Bounded lock-free queue of log records, any thread can log and only the writer thread prints
+ * A record holds either a formatted line or, in deferred mode, the format string and its packed arguments */
+struct debug_log_slot_t
+{
+    std::atomic<uint32_t> sequence;
+    const char* format; // NULL for formatted text
+    timeval time;
+    uint8_t tag;
+    int8_t level;
+    uint16_t len;
+    char text[HASP_LOG_LINE_SIZE];
+};
+
+#define DEBUG_LOG_MASK (HASP_LOG_QUEUE_SIZE - 1)
+static_assert((HASP_LOG_QUEUE_SIZE & DEBUG_LOG_MASK) == 0, "HASP_LOG_QUEUE_SIZE must be a power of 2");
+
+static debug_log_slot_t debug_log_queue[HASP_LOG_QUEUE_SIZE];
+static std::atomic<uint32_t> debug_log_head(0);
+static std::atomic<uint32_t> debug_log_tail(0);
+static std::atomic<uint32_t> debug_log_dropped(0);
+
+/* The writer sleeps on debug_log_ready while the queue is empty, fatal messages sleep on debug_log_idle until it is
+ * drained. The flags let the logging threads skip the mutex when nobody waits. */
+static std::mutex debug_log_mutex;
+// never destroyed, destroying a condition variable at exit blocks while the writer thread still waits on it
+static std::condition_variable& debug_log_ready = *new std::condition_variable;
+static std::condition_variable& debug_log_idle  = *new std::condition_variable;
+static std::atomic<bool> debug_log_sleeping(false);
+static std::atomic<uint32_t> debug_log_waiters(0);
+
+#if HASP_LOG_DEFERRED > 0
+/* Deferred mode: the caller only copies the arguments, the writer thread runs the printf formatting */
+enum debug_arg_t : uint8_t {
+    DEBUG_ARG_NONE,
+    DEBUG_ARG_INT,
+    DEBUG_ARG_LONG,
+    DEBUG_ARG_LLONG,
+    DEBUG_ARG_SIZE,
+    DEBUG_ARG_INTMAX,
+    DEBUG_ARG_PTRDIFF,
+    DEBUG_ARG_DOUBLE,
+    DEBUG_ARG_LDOUBLE,
+    DEBUG_ARG_PTR,
+    DEBUG_ARG_STR,
+    DEBUG_ARG_INVALID,
+};
+
+#define DEBUG_SPEC_SIZE 24     // longest conversion specification that can be deferred
+#define DEBUG_PRECISION_STAR -2 // the precision is the last '*' argument
+
+/**
+ * Parse one printf conversion specification
+ * @param p points after the '%' and is moved past the conversion character
+ * @param stars number of '*' width and precision arguments that precede the value
+ * @param precision the precision, -1 if there is none or DEBUG_PRECISION_STAR if it is an argument
+ * @return the type of the value, DEBUG_ARG_INVALID if the conversion can't be deferred
+ */
+static debug_arg_t debug_parse_spec(const char*& p, uint8_t& stars, int& precision)
+{
+    const char* start = p;
+    uint8_t length    = 0; // 0 = none, 'l', 'L' = ll, 'z', 'j', 't' or 'D' = long double
+    stars             = 0;
+    precision         = -1;
+
+    while(*p && strchr("-+ #0", *p)) p++;
+    if(*p == '*') {
+        stars++, p++;
+    } else {
+        while(isdigit(*p)) p++;
+    }
+    if(*p == '.') {
+        p++;
+        if(*p == '*') {
+            stars++, p++;
+            precision = DEBUG_PRECISION_STAR;
+        } else {
+            precision = 0;
+            while(isdigit(*p)) {
+                if(precision < 10000) precision = precision * 10 + (*p - '0');
+                p++;
+            }
+        }
+    }
+
+    switch(*p) {
+        case 'h':
+            p += p[1] == 'h' ? 2 : 1; // promoted to int
+            break;
+        case 'l':
+            length = p[1] == 'l' ? 'L' : 'l';
+            p += p[1] == 'l' ? 2 : 1;
+            break;
+        case 'z':
+        case 'j':
+        case 't':
+            length = *p++;
+            break;
+        case 'L':
+            length = 'D';
+            p++;
+            break;
+    }
+
+    if(*p == '\0' || p - start >= DEBUG_SPEC_SIZE - 1) return DEBUG_ARG_INVALID;
+
+    switch(*p++) {
+        case '%':
+            return stars || length ? DEBUG_ARG_INVALID : DEBUG_ARG_NONE;
+        case 'd':
+        case 'i':
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'o':
+        case 'c':
+            switch(length) {
+                case 0:
+                    return DEBUG_ARG_INT;
+                case 'l':
+                    return *(p - 1) == 'c' ? DEBUG_ARG_INVALID : DEBUG_ARG_LONG;
+                case 'L':
+                    return DEBUG_ARG_LLONG;
+                case 'z':
+                    return DEBUG_ARG_SIZE;
+                case 'j':
+                    return DEBUG_ARG_INTMAX;
+                case 't':
+                    return DEBUG_ARG_PTRDIFF;
+            }
+            return DEBUG_ARG_INVALID;
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            if(length == 'D') return DEBUG_ARG_LDOUBLE;
+            return length == 0 || length == 'l' ? DEBUG_ARG_DOUBLE : DEBUG_ARG_INVALID;
+        case 's':
+            return length == 0 ? DEBUG_ARG_STR : DEBUG_ARG_INVALID;
+        case 'p':
+            return length == 0 ? DEBUG_ARG_PTR : DEBUG_ARG_INVALID;
+        default: // %n and unknown conversions
+            return DEBUG_ARG_INVALID;
+    }
+}
+
+template <typename T> static inline bool debug_pack(char* buffer, size_t size, size_t& pos, T value)
+{
+    if(pos + sizeof(T) > size) return false;
+    memcpy(buffer + pos, &value, sizeof(T));
+    pos += sizeof(T);
+    return true;
+}
+
+template <typename T> static inline T debug_unpack(const char*& data)
+{
+    T value;
+    memcpy(&value, data, sizeof(T));
+    data += sizeof(T);
+    return value;
+}
+
+/* Copy the arguments of format into buffer, strings are copied because they may not outlive the call */
+static bool debug_pack_args(const char* format, va_list args, char* buffer, size_t size, size_t& pos)
+{
+    for(const char* p = format; (p = strchr(p, '%')) != NULL;) {
+        uint8_t stars;
+        int precision;
+        debug_arg_t type = debug_parse_spec(++p, stars, precision);
+        bool packed      = true;
+
+        int star = 0;
+        for(; stars > 0; stars--) {
+            star = va_arg(args, int);
+            packed &= debug_pack(buffer, size, pos, star);
+        }
+        if(precision == DEBUG_PRECISION_STAR) precision = star; // a negative precision is taken as none
+
+        switch(type) {
+            case DEBUG_ARG_NONE:
+                break;
+            case DEBUG_ARG_INT:
+                packed &= debug_pack(buffer, size, pos, va_arg(args, int));
+                break;
+            case DEBUG_ARG_LONG:
+                packed &= debug_pack(buffer, size, pos, va_arg(args, long));
+                break;
+            case DEBUG_ARG_LLONG:
+                packed &= debug_pack(buffer, size, pos, va_arg(args, long long));
+                break;
+            case DEBUG_ARG_SIZE:
+                packed &= debug_pack(buffer, size, pos, va_arg(args, size_t));
+                break;
+            case DEBUG_ARG_INTMAX:
+                packed &= debug_pack(buffer, size, pos, va_arg(args, intmax_t));
+                break;
+            case DEBUG_ARG_PTRDIFF:
+                packed &= debug_pack(buffer, size, pos, va_arg(args, ptrdiff_t));
+                break;
+            case DEBUG_ARG_DOUBLE:
+                packed &= debug_pack(buffer, size, pos, va_arg(args, double));
+                break;
+            case DEBUG_ARG_LDOUBLE:
+                packed &= debug_pack(buffer, size, pos, va_arg(args, long double));
+                break;
+            case DEBUG_ARG_PTR:
+                packed &= debug_pack(buffer, size, pos, va_arg(args, void*));
+                break;
+            case DEBUG_ARG_STR: {
+                const char* str = va_arg(args, const char*);
+                if(!str) str = "(null)";
+                size_t len = precision >= 0 ? strnlen(str, precision) : strlen(str); // %.Ns may not be terminated
+                if(pos + len + 1 > size) return false;
+                memcpy(buffer + pos, str, len);
+                buffer[pos + len] = '\0';
+                pos += len + 1;
+                break;
+            }
+            default:
+                return false;
+        }
+        if(!packed) return false;
+    }
+    return true;
+}
+
+template <typename T> static void debug_append_arg(const char* spec, uint8_t stars, const int* star, T value)
+{
+    switch(stars) {
+        case 0:
+            debug_append(spec, value);
+            break;
+        case 1:
+            debug_append(spec, star[0], value);
+            break;
+        default:
+            debug_append(spec, star[0], star[1], value);
+    }
+}
+
+/* Format the packed arguments of a deferred record into the line buffer of the writer thread */
+static void debug_unpack_args(const char* format, const char* data)
+{
+    char spec[DEBUG_SPEC_SIZE];
+    const char* p = format;
+
+    for(const char* pct; (pct = strchr(p, '%')) != NULL;) {
+        debug_append("%.*s", (int)(pct - p), p);
+
+        uint8_t stars;
+        int precision;
+        p                = pct + 1;
+        debug_arg_t type = debug_parse_spec(p, stars, precision);
+        memcpy(spec, pct, p - pct);
+        spec[p - pct] = '\0';
+
+        int star[2];
+        for(uint8_t i = 0; i < stars; i++) star[i] = debug_unpack<int>(data);
+
+        switch(type) {
+            case DEBUG_ARG_NONE:
+                debug_append("%%");
+                break;
+            case DEBUG_ARG_INT:
+                debug_append_arg(spec, stars, star, debug_unpack<int>(data));
+                break;
+            case DEBUG_ARG_LONG:
+                debug_append_arg(spec, stars, star, debug_unpack<long>(data));
+                break;
+            case DEBUG_ARG_LLONG:
+                debug_append_arg(spec, stars, star, debug_unpack<long long>(data));
+                break;
+            case DEBUG_ARG_SIZE:
+                debug_append_arg(spec, stars, star, debug_unpack<size_t>(data));
+                break;
+            case DEBUG_ARG_INTMAX:
+                debug_append_arg(spec, stars, star, debug_unpack<intmax_t>(data));
+                break;
+            case DEBUG_ARG_PTRDIFF:
+                debug_append_arg(spec, stars, star, debug_unpack<ptrdiff_t>(data));
+                break;
+            case DEBUG_ARG_DOUBLE:
+                debug_append_arg(spec, stars, star, debug_unpack<double>(data));
+                break;
+            case DEBUG_ARG_LDOUBLE:
+                debug_append_arg(spec, stars, star, debug_unpack<long double>(data));
+                break;
+            case DEBUG_ARG_PTR:
+                debug_append_arg(spec, stars, star, debug_unpack<void*>(data));
+                break;
+            case DEBUG_ARG_STR:
+                debug_append_arg(spec, stars, star, data);
+                data += strlen(data) + 1;
+                break;
+            default:
+                return; // not reached, the record was packed with the same parser
+        }
+    }
+    debug_append("%s", p);
+}
+
+#if defined(__linux__)
+extern "C" char __executable_start;
+extern "C" char __data_start;
+
+/* Only formats in the read-only part of the executable outlive the log call, others are formatted immediately */
+static inline bool debug_format_is_static(const char* format)
+{
+    return format >= &__executable_start && format < &__data_start;
+}
+#else
+static inline bool debug_format_is_static(const char* format)
+{
+    return false;
+}
+#endif
+#endif // HASP_LOG_DEFERRED
+
+/* Terminate the line buffer of this thread, keeping room for the newline of truncated lines */
+static void debug_end_line()
+{
+    if(debug_line_len >= sizeof(debug_line) - 1) debug_line_len = sizeof(debug_line) - 2;
+    debug_line[debug_line_len++] = '\n';
+}
+
+/* Block the writer thread until the record at tail is published */
+static void debug_log_sleep(debug_log_slot_t* slot, uint32_t tail)
+{
+    std::unique_lock<std::mutex> lock(debug_log_mutex);
+    debug_log_sleeping.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst); // pairs with the fence in debug_log_publish()
+    debug_log_ready.wait(lock, [slot, tail] { return slot->sequence.load(std::memory_order_acquire) == tail + 1; });
+    debug_log_sleeping.store(false, std::memory_order_relaxed);
+}
+
+/* Wake the threads in debug_log_wait() once the writer has caught up */
+static void debug_log_notify_idle(uint32_t tail)
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst); // pairs with the fence in debug_log_wait()
+    if(debug_log_waiters.load(std::memory_order_relaxed) == 0) return;
+    if(tail != debug_log_head.load(std::memory_order_acquire)) return;
+
+    std::lock_guard<std::mutex> lock(debug_log_mutex);
+    debug_log_idle.notify_all();
+}
+
+/* Prints the queued lines to stdout, so the threads that log never wait for the console */
+static void debug_log_writer(void* arg)
+{
+    uint32_t tail = 0;
+    for(;;) {
+        debug_log_slot_t* slot = &debug_log_queue[tail & DEBUG_LOG_MASK];
+        if(slot->sequence.load(std::memory_order_acquire) != tail + 1) {
+            fflush(stdout);
+            if(uint32_t dropped = debug_log_dropped.exchange(0)) {
+                fprintf(stdout, "(%u log lines dropped)\n", dropped);
+                continue;
+            }
+            debug_log_sleep(slot, tail);
+            continue;
+        }
+
+#if HASP_LOG_DEFERRED > 0
+        if(slot->format) {
+            debug_replay_time = &slot->time;
+            debugPrintPrefix(slot->tag, slot->level, NULL);
+            debug_unpack_args(slot->format, slot->text);
+            debug_replay_time = NULL;
+            debug_end_line();
+            fwrite(debug_line, 1, debug_line_len, stdout);
+            debug_line_len = 0;
+        } else
+#endif
+            fwrite(slot->text, 1, slot->len, stdout);
+
+        slot->sequence.store(tail + HASP_LOG_QUEUE_SIZE, std::memory_order_release); // free the slot
+        debug_log_tail.store(++tail, std::memory_order_release);
+        debug_log_notify_idle(tail);
+    }
+}
+
+static bool debug_log_init()
+{
+    for(uint32_t i = 0; i < HASP_LOG_QUEUE_SIZE; i++) {
+        debug_log_queue[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    haspDevice.run_thread(debug_log_writer, NULL);
+    return true;
+}
+
+/**
+ * Reserve the next free slot of the queue
+ * @param pos receives the position to pass to debug_log_publish()
+ * @return the slot or NULL if the queue is full
+ */
+static debug_log_slot_t* debug_log_claim(uint32_t& pos)
+{
+    static bool started = debug_log_init(); // the first line starts the writer thread
+    (void)started;
+
+    pos = debug_log_head.load(std::memory_order_relaxed);
+    for(;;) {
+        debug_log_slot_t* slot = &debug_log_queue[pos & DEBUG_LOG_MASK];
+        int32_t diff           = (int32_t)(slot->sequence.load(std::memory_order_acquire) - pos);
+
+        if(diff == 0) {
+            if(debug_log_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) return slot;
+        } else if(diff < 0) {
+            debug_log_dropped++; // queue full, never block the caller
+            return NULL;
+        } else {
+            pos = debug_log_head.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+static inline void debug_log_publish(debug_log_slot_t* slot, uint32_t pos)
+{
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_seq_cst); // pairs with the fence in debug_log_sleep()
+    if(!debug_log_sleeping.load(std::memory_order_relaxed)) return;
+
+    std::lock_guard<std::mutex> lock(debug_log_mutex);
+    debug_log_ready.notify_one();
+}
+
+/* Wait until the writer thread has printed everything that is queued */
+static void debug_log_wait()
+{
+    {
+        std::unique_lock<std::mutex> lock(debug_log_mutex);
+        debug_log_waiters++;
+        std::atomic_thread_fence(std::memory_order_seq_cst); // pairs with the fence in debug_log_notify_idle()
+        debug_log_idle.wait(lock, [] {
+            return debug_log_tail.load(std::memory_order_acquire) == debug_log_head.load(std::memory_order_acquire);
+        });
+        debug_log_waiters--;
+    }
+    fflush(stdout);
+}
+
+/* Queue the text formatted by this thread, fatal messages wait until everything is written */
+static void debug_commit(int level)
+{
+    if(debug_line_len > 0) {
+        uint32_t pos;
+        if(debug_log_slot_t* slot = debug_log_claim(pos)) {
+            memcpy(slot->text, debug_line, debug_line_len);
+            slot->format = NULL;
+            slot->len    = debug_line_len;
+            debug_log_publish(slot, pos);
+        }
+        debug_line_len = 0;
+    }
+
+    if(level == LOG_LEVEL_FATAL) debug_log_wait();
+}
+
+#if HASP_LOG_DEFERRED > 0
+/* Queue the format and its arguments without formatting them, returns false if the line must be formatted now */
+static bool debug_defer(uint8_t tag, int level, const char* format, va_list args)
+{
+    if(level == LOG_LEVEL_FATAL || debug_line_len > 0 || !debug_format_is_static(format)) return false;
+
+    char packed[HASP_LOG_LINE_SIZE];
+    size_t len = 0;
+    if(!debug_pack_args(format, args, packed, sizeof(packed), len)) return false;
+
+    uint32_t pos;
+    if(debug_log_slot_t* slot = debug_log_claim(pos)) {
+        memcpy(slot->text, packed, len);
+        slot->format = format;
+        slot->tag    = tag;
+        slot->level  = level;
+        slot->len    = len;
+        gettimeofday(&slot->time, NULL);
+        debug_log_publish(slot, pos);
+    }
+    return true;
+}
+#endif
+
+void debugLog(uint8_t tag, int level, const char* format, ...)
+{
+    va_list args;
+
+#if HASP_LOG_DEFERRED > 0
+    va_start(args, format);
+    bool deferred = debug_defer(tag, level, format, args);
+    va_end(args);
+    if(deferred) return;
+#endif
+
+    debugPrintPrefix(tag, level, NULL);
+
+    va_start(args, format);
+    debug_vappend(format, args);
+    va_end(args);
+
+    debug_end_line();
+    debug_commit(level);
+}
+#endif // HASP_TARGET_PC
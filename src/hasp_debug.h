@@ -48,46 +48,15 @@ void debugStopSyslog(void);
 #define LOG_LEVEL_DEBUG 8
 #define LOG_LEVEL_OUTPUT 9
 
-#define LOG_FATAL(x, ...)                                                                                              \
-    debugPrintPrefix(x, LOG_LEVEL_FATAL, NULL);                                                                        \
-    printf(__VA_ARGS__);                                                                                               \
-    std::cout << std::endl;                                                                                            \
-    fflush(stdout)
-#define LOG_ERROR(x, ...)                                                                                              \
-    debugPrintPrefix(x, LOG_LEVEL_ERROR, NULL);                                                                        \
-    printf(__VA_ARGS__);                                                                                               \
-    std::cout << std::endl;                                                                                            \
-    fflush(stdout)
-#define LOG_WARNING(x, ...)                                                                                            \
-    debugPrintPrefix(x, LOG_LEVEL_WARNING, NULL);                                                                      \
-    printf(__VA_ARGS__);                                                                                               \
-    std::cout << std::endl;                                                                                            \
-    fflush(stdout)
-#define LOG_NOTICE(x, ...)                                                                                             \
-    debugPrintPrefix(x, LOG_LEVEL_NOTICE, NULL);                                                                       \
-    printf(__VA_ARGS__);                                                                                               \
-    std::cout << std::endl;                                                                                            \
-    fflush(stdout)
-#define LOG_TRACE(x, ...)                                                                                              \
-    debugPrintPrefix(x, LOG_LEVEL_TRACE, NULL);                                                                        \
-    printf(__VA_ARGS__);                                                                                               \
-    std::cout << std::endl;                                                                                            \
-    fflush(stdout)
-#define LOG_VERBOSE(x, ...)                                                                                            \
-    debugPrintPrefix(x, LOG_LEVEL_VERBOSE, NULL);                                                                      \
-    printf(__VA_ARGS__);                                                                                               \
-    std::cout << std::endl;                                                                                            \
-    fflush(stdout)
-#define LOG_DEBUG(x, ...)                                                                                              \
-    debugPrintPrefix(x, LOG_LEVEL_DEBUG, NULL);                                                                        \
-    printf(__VA_ARGS__);                                                                                               \
-    std::cout << std::endl;                                                                                            \
-    fflush(stdout)
-#define LOG_INFO(x, ...)                                                                                               \
-    debugPrintPrefix(x, LOG_LEVEL_INFO, NULL);                                                                         \
-    printf(__VA_ARGS__);                                                                                               \
-    std::cout << std::endl;                                                                                            \
-    fflush(stdout)
+/* Log lines are formatted by the caller, or by the writer thread in deferred mode, and printed by the writer thread */
+#define LOG_FATAL(x, ...) HASP_LOG_IF(x, LOG_LEVEL_FATAL, debugLog(x, LOG_LEVEL_FATAL, __VA_ARGS__))
+#define LOG_ERROR(x, ...) HASP_LOG_IF(x, LOG_LEVEL_ERROR, debugLog(x, LOG_LEVEL_ERROR, __VA_ARGS__))
+#define LOG_WARNING(x, ...) HASP_LOG_IF(x, LOG_LEVEL_WARNING, debugLog(x, LOG_LEVEL_WARNING, __VA_ARGS__))
+#define LOG_NOTICE(x, ...) HASP_LOG_IF(x, LOG_LEVEL_NOTICE, debugLog(x, LOG_LEVEL_NOTICE, __VA_ARGS__))
+#define LOG_TRACE(x, ...) HASP_LOG_IF(x, LOG_LEVEL_TRACE, debugLog(x, LOG_LEVEL_TRACE, __VA_ARGS__))
+#define LOG_VERBOSE(x, ...) HASP_LOG_IF(x, LOG_LEVEL_VERBOSE, debugLog(x, LOG_LEVEL_VERBOSE, __VA_ARGS__))
+#define LOG_DEBUG(x, ...) HASP_LOG_IF(x, LOG_LEVEL_DEBUG, debugLog(x, LOG_LEVEL_DEBUG, __VA_ARGS__))
+#define LOG_INFO(x, ...) HASP_LOG_IF(x, LOG_LEVEL_INFO, debugLog(x, LOG_LEVEL_INFO, __VA_ARGS__))
 
 /* json keys used in the configfile */
 // const char FP_CONFIG_STARTPAGE[] PROGMEM = "startpage";
@@ -146,6 +115,11 @@ void debugPrintHaspHeader(Print* output);
 void debugPrintTag(uint8_t tag, Print* _logOutput);
 void debugPrintPrefix(uint8_t tag, int level, Print* _logOutput);
 bool debugSyslogPrefix(uint8_t tag, int level, Print* _logOutput, const char* processname);
+void debugSetTagLevel(uint8_t tag, int8_t level);
+int16_t debugGetTagId(const char* name);
+#if HASP_TARGET_PC
+void debugLog(uint8_t tag, int level, const char* format, ...);
+#endif
 
 #ifdef __cplusplus
 }
@@ -195,6 +169,7 @@ enum {
     TAG_TIME     = 69,
     TAG_NETW     = 70,
     TAG_WG       = 71,
+    TAG_VNC      = 72,
 
     TAG_LVGL = 90,
     TAG_LVFS = 91,
@@ -203,6 +178,25 @@ enum {
     TAG_CUSTOM = 99
 };
 
+#define HASP_LOG_TAG_COUNT 100 // TAG_CUSTOM + 1
+#define HASP_LOG_ALL_TAGS 0xFF
+
+/* Compile-time level per tag, messages above it are removed by the compiler, i.e. in user_config_override.h:
+ * #define HASP_LOG_TAG_LEVELS HASP_LOG_TAG_LEVEL(TAG_MQTT, LOG_LEVEL_WARNING) HASP_LOG_TAG_LEVEL(TAG_FONT, LOG_LEVEL_ERROR)
+ */
+#ifndef HASP_LOG_TAG_LEVELS
+#define HASP_LOG_TAG_LEVELS
+#endif
+#define HASP_LOG_TAG_LEVEL(tag, level) log_tag == (tag) ? (level):
+
+constexpr int debug_tag_compile_level(int log_tag)
+{
+    return HASP_LOG_TAG_LEVELS HASP_LOG_LEVEL;
+}
+
+/* Runtime level mask per tag, bit n is set when level n is muted, see debugSetTagLevel() */
+extern uint16_t debugTagMask[HASP_LOG_TAG_COUNT];
+
 #define HASP_SERIAL Serial
 
 //#define TERM_COLOR_Black "\u001b[30m"
@@ -17,6 +17,8 @@
 
 // #include "tpcal.h"
 
+#include <atomic>
+
 #define BACKLIGHT_CHANNEL 0 // pwm channel 0-15
 
 #if HASP_USE_SPIFFS > 0 || HASP_USE_LITTLEFS > 0
@@ -28,6 +30,11 @@ static SemaphoreHandle_t xGuiSemaphore = NULL;
 static TaskHandle_t g_lvgl_task_handle;
 #endif
 
+#if HASP_USE_DOUBLE_VDB > 0 && USE_FBDEV && HASP_TARGET_PC && !defined(HASP_TFT_ASYNC_FLUSH)
+#include <pthread.h>
+#define HASP_GUI_FLUSH_THREAD 1 // flush the second buffer on a worker thread
+#endif
+
 #define LVGL_TICK_PERIOD 20
 
 #ifndef TFT_BCKL
@@ -46,7 +53,9 @@ gui_conf_t gui_settings = {.show_pointer   = false,
                            .backlight_pin  = TFT_BCKL,
                            .rotation       = TFT_ROTATION,
                            .invert_display = INVERT_COLORS,
-                           .cal_data       = {0, 65535, 0, 65535, 0}};
+                           .cal_data       = {0, 65535, 0, 65535, 0},
+                           .vdb_size       = LV_VDB_SIZE,
+                           .vdb_double     = HASP_USE_DOUBLE_VDB};
 lv_obj_t* cursor;
 
 uint16_t tft_width  = TFT_WIDTH;
@@ -57,6 +66,92 @@ uint32_t screenshotEtag = 0;
 void (*drv_display_flush_cb)(struct _disp_drv_t* disp_drv, const lv_area_t* area, lv_color_t* color_p);
 
 static lv_disp_buf_t disp_buf;
+static lv_color_t* guiVdbBuffer1 = NULL;
+static lv_color_t* guiVdbBuffer2 = NULL;
+static std::atomic<bool> gui_vdb_changed(false); // reallocate the draw buffers between two refreshes
+
+/* Refresh statistics since the last call of gui_get_stats() */
+static struct
+{
+    uint32_t frames;
+    uint32_t frame_time; // ms spent in refreshes
+    uint32_t flush_wait; // ms lvgl was blocked on the flush driver
+} gui_stats;
+
+static lv_color_t* gui_alloc_vdb(size_t size)
+{
+#if defined(ESP32) && defined(HASP_TFT_ASYNC_FLUSH)
+    return (lv_color_t*)heap_caps_malloc(size, MALLOC_CAP_DMA | MALLOC_CAP_8BIT);
+#elif defined(ESP32)
+    return (lv_color_t*)heap_caps_malloc(size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+#else
+    return (lv_color_t*)malloc(size);
+#endif
+}
+
+/**
+ * (Re)allocate the Virtual Device Buffers using the gui settings
+ * The current buffers are kept if the new ones can not be allocated.
+ * @return true if the draw buffers were replaced
+ */
+static bool gui_init_vdb()
+{
+#if USE_FBDEV && HASP_TARGET_PC
+    /* lvgl renders straight into the framebuffer */
+    lv_color_t* fb1;
+    lv_color_t* fb2;
+    uint32_t fb_size;
+    if(haspTft.get_draw_buffers(&fb1, &fb2, &fb_size)) {
+        lv_disp_buf_init(&disp_buf, fb1, fb2, fb_size);
+        LOG_VERBOSE(TAG_LVGL, F("VFB size   : framebuffer"));
+        return true;
+    }
+#endif
+
+    size_t size = gui_settings.vdb_size;
+    size_t line = (tft_width > tft_height ? tft_width : tft_height) * sizeof(lv_color_t);
+    if(size < line) size = line; // lvgl needs at least one full line
+
+    lv_color_t* buffer1 = gui_alloc_vdb(size);
+    lv_color_t* buffer2 = NULL;
+    if(!buffer1 && !guiVdbBuffer1 && size != LV_VDB_SIZE) {
+        size    = LV_VDB_SIZE; // fall back to the default size at boot
+        buffer1 = gui_alloc_vdb(size);
+    }
+    if(!buffer1) {
+        if(guiVdbBuffer1) {
+            LOG_ERROR(TAG_GUI, F("VFB size   : " D_ERROR_OUT_OF_MEMORY));
+        } else {
+            LOG_FATAL(TAG_GUI, F(D_ERROR_OUT_OF_MEMORY));
+        }
+        return false;
+    }
+
+    if(gui_settings.vdb_double) {
+        buffer2 = gui_alloc_vdb(size);
+        if(!buffer2) {
+            LOG_WARNING(TAG_GUI, F("VFB double : " D_ERROR_OUT_OF_MEMORY));
+        }
+    }
+
+    /* Make sure the driver is done with the current buffers */
+    lv_disp_t* disp = lv_disp_get_default();
+    if(disp && disp->driver.wait_cb) {
+        while(disp_buf.flushing) disp->driver.wait_cb(&disp->driver);
+    }
+
+    if(guiVdbBuffer2) free(guiVdbBuffer2);
+    if(guiVdbBuffer1) free(guiVdbBuffer1);
+    guiVdbBuffer1 = buffer1;
+    guiVdbBuffer2 = buffer2;
+
+    /* Initialize VDB */
+    lv_disp_buf_init(&disp_buf, guiVdbBuffer1, guiVdbBuffer2, size / sizeof(lv_color_t));
+    if(disp) lv_obj_invalidate(lv_scr_act());
+
+    LOG_VERBOSE(TAG_LVGL, F("VFB size   : %d x %u"), size, guiVdbBuffer2 ? 2 : 1);
+    return true;
+}
 
 static inline void gui_init_lvgl()
 {
@@ -70,29 +165,11 @@ static inline void gui_init_lvgl()
 #endif
 
     /* Create the Virtual Device Buffers */
-    const size_t guiVDBsize = LV_VDB_SIZE / sizeof(lv_color_t);
-#ifdef ESP32
-    static lv_color_t* guiVdbBuffer1 =
-        (lv_color_t*)heap_caps_malloc(sizeof(lv_color_t) * guiVDBsize, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
-#else
-    static lv_color_t* guiVdbBuffer1 = (lv_color_t*)malloc(sizeof(lv_color_t) * guiVDBsize);
-#endif
-
-    /* Static VDB allocation */
-    // static lv_color_t guiVdbBuffer1[LV_VDB_SIZE * 512u];
-    // const size_t guiVDBsize = sizeof(guiVdbBuffer1) / sizeof(lv_color_t);
-
-    /* Initialize VDB */
-    if(guiVdbBuffer1 && guiVDBsize > 0) {
-        lv_disp_buf_init(&disp_buf, guiVdbBuffer1, NULL, guiVDBsize);
-    } else {
-        LOG_FATAL(TAG_GUI, F(D_ERROR_OUT_OF_MEMORY));
-    }
+    gui_init_vdb();
 
 #ifdef LV_MEM_SIZE
     LOG_VERBOSE(TAG_LVGL, F("MEM size   : %d"), LV_MEM_SIZE);
 #endif
-    LOG_VERBOSE(TAG_LVGL, F("VFB size   : %d"), (size_t)sizeof(lv_color_t) * guiVDBsize);
 }
 
 void gui_hide_pointer(bool hidden)
@@ -100,9 +177,226 @@ void gui_hide_pointer(bool hidden)
     if(cursor) lv_obj_set_hidden(cursor, hidden || !gui_settings.show_pointer);
 }
 
+#if HASP_GUI_FLUSH_THREAD
+/* The area that is being flushed by the worker thread, simulates a DMA transfer
+ * The worker flushes through a copy of the driver with a buffer of its own, so the lv_disp_flush_ready() call of
+ * the tft driver does not touch lvgl. Completion is signalled back to the lvgl thread in gui_flush_wait_cb. */
+static struct
+{
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    lv_disp_drv_t drv;
+    lv_disp_buf_t buf;
+    lv_area_t area;
+    lv_color_t* color_p;
+    bool busy;
+} gui_flush_job = {.mutex = PTHREAD_MUTEX_INITIALIZER, .cond = PTHREAD_COND_INITIALIZER};
+
+static void* gui_flush_thread(void* arg)
+{
+    pthread_mutex_lock(&gui_flush_job.mutex);
+    while(haspDevice.pc_is_running) {
+        if(!gui_flush_job.busy) {
+            pthread_cond_wait(&gui_flush_job.cond, &gui_flush_job.mutex);
+            continue;
+        }
+        pthread_mutex_unlock(&gui_flush_job.mutex);
+
+        /* The driver calls lv_disp_flush_ready() on the copy when the pixels are out */
+        haspTft.flush_pixels(&gui_flush_job.drv, &gui_flush_job.area, gui_flush_job.color_p);
+
+        pthread_mutex_lock(&gui_flush_job.mutex);
+        gui_flush_job.busy = false;
+        pthread_cond_broadcast(&gui_flush_job.cond);
+    }
+    pthread_mutex_unlock(&gui_flush_job.mutex);
+    return NULL;
+}
+
+static void gui_flush_thread_wait()
+{
+    pthread_mutex_lock(&gui_flush_job.mutex);
+    while(gui_flush_job.busy) pthread_cond_wait(&gui_flush_job.cond, &gui_flush_job.mutex);
+    pthread_mutex_unlock(&gui_flush_job.mutex);
+}
+
+static void gui_flush_thread_post(lv_disp_drv_t* disp, const lv_area_t* area, lv_color_t* color_p)
+{
+    if(!gui_flush_job.thread) pthread_create(&gui_flush_job.thread, NULL, gui_flush_thread, NULL);
+
+    gui_flush_thread_wait();
+    pthread_mutex_lock(&gui_flush_job.mutex);
+    gui_flush_job.drv        = *disp;
+    gui_flush_job.drv.buffer = &gui_flush_job.buf;
+    gui_flush_job.area       = *area;
+    gui_flush_job.color_p    = color_p;
+    gui_flush_job.busy       = true;
+    pthread_cond_broadcast(&gui_flush_job.cond);
+    pthread_mutex_unlock(&gui_flush_job.mutex);
+}
+#endif // HASP_GUI_FLUSH_THREAD
+
+/* Called by lvgl while it waits for an asynchronous flush to complete */
+static void gui_flush_wait_cb(lv_disp_drv_t* disp)
+{
+    uint32_t start = millis();
+#if defined(HASP_TFT_ASYNC_FLUSH)
+    haspTft.flush_wait(disp);
+#elif HASP_GUI_FLUSH_THREAD
+    gui_flush_thread_wait();
+    lv_disp_flush_ready(disp); // on the lvgl thread
+#endif
+    gui_stats.flush_wait += millis() - start;
+}
+
+/* Complete the last flush of a refresh, so the display bus is released between refreshes */
+static inline void gui_flush_complete()
+{
+#if defined(HASP_TFT_ASYNC_FLUSH) || HASP_GUI_FLUSH_THREAD
+    lv_disp_t* disp = lv_disp_get_default();
+    if(disp && disp_buf.flushing) gui_flush_wait_cb(&disp->driver);
+#endif
+
+    /* No refresh or flush is using the draw buffers now */
+    if(gui_vdb_changed.exchange(false)) gui_init_vdb();
+}
+
+#if HASP_USE_SCREENSHOT_SHADOW > 0
+/* Copy of the screen kept up to date by gui_flush_cb, screenshots are read from it without redrawing the screen */
+static struct
+{
+    lv_color_t* pixels;
+    lv_coord_t width;
+    lv_coord_t height;
+    uint32_t version;      // incremented for every flushed area, used as the screenshot ETag
+    uint32_t lost_version; // newest version that dropped out of the dirty ring
+    lv_disp_rot_t rotated; // rotation the shadow was laid out for
+    struct
+    {
+        uint32_t version;
+        lv_area_t area;
+    } dirty[HASP_SCREENSHOT_DIRTY_AREAS]; // ring of the most recently flushed areas
+    uint8_t dirty_next;
+} gui_shadow;
+
+/* Also called when the rotation changes, the old contents and dirty areas no longer match the screen */
+static void gui_shadow_init(lv_disp_t* disp)
+{
+    hasp_free(gui_shadow.pixels);
+    gui_shadow.pixels  = NULL;
+    gui_shadow.width   = 0;
+    gui_shadow.height  = 0;
+    gui_shadow.rotated = disp->driver.rotated;
+    memset(gui_shadow.dirty, 0, sizeof(gui_shadow.dirty));
+    gui_shadow.dirty_next   = 0;
+    gui_shadow.lost_version = ++gui_shadow.version; // clients with an older ETag get the whole screen
+
+    if(disp->driver.sw_rotate && disp->driver.rotated != LV_DISP_ROT_NONE) {
+        LOG_WARNING(TAG_GUI, F("Screenshot shadow buffer is not supported with software rotation"));
+        return;
+    }
+
+    lv_coord_t width  = lv_disp_get_hor_res(disp);
+    lv_coord_t height = lv_disp_get_ver_res(disp);
+    gui_shadow.pixels = (lv_color_t*)hasp_calloc((size_t)width * height, sizeof(lv_color_t));
+    if(!gui_shadow.pixels) {
+        LOG_ERROR(TAG_GUI, F(D_ERROR_OUT_OF_MEMORY));
+        return;
+    }
+    gui_shadow.width  = width;
+    gui_shadow.height = height;
+}
+
+static void gui_shadow_update(lv_disp_drv_t* disp, const lv_area_t* area, const lv_color_t* color_p)
+{
+    if(disp->rotated != gui_shadow.rotated) gui_shadow_init(lv_disp_get_default());
+
+    lv_area_t clip;
+    lv_area_t screen = {0, 0, (lv_coord_t)(gui_shadow.width - 1), (lv_coord_t)(gui_shadow.height - 1)};
+    if(!gui_shadow.pixels || !_lv_area_intersect(&clip, area, &screen)) return;
+
+    lv_coord_t stride     = lv_area_get_width(area);
+    size_t len            = lv_area_get_width(&clip) * sizeof(lv_color_t);
+    const lv_color_t* src = color_p + (clip.y1 - area->y1) * stride + (clip.x1 - area->x1);
+    lv_color_t* dst       = gui_shadow.pixels + clip.y1 * gui_shadow.width + clip.x1;
+    for(lv_coord_t y = clip.y1; y <= clip.y2; y++, src += stride, dst += gui_shadow.width) memcpy(dst, src, len);
+
+    /* lvgl flushes large areas in strips, extend the last dirty area when this strip continues it */
+    uint8_t last    = (gui_shadow.dirty_next + HASP_SCREENSHOT_DIRTY_AREAS - 1) % HASP_SCREENSHOT_DIRTY_AREAS;
+    lv_area_t* prev = &gui_shadow.dirty[last].area;
+    if(gui_shadow.dirty[last].version == gui_shadow.version && prev->x1 == clip.x1 && prev->x2 == clip.x2 &&
+       prev->y2 + 1 == clip.y1) {
+        prev->y2 = clip.y2;
+    } else {
+        last = gui_shadow.dirty_next;
+        if(gui_shadow.dirty[last].version) gui_shadow.lost_version = gui_shadow.dirty[last].version;
+        gui_shadow.dirty[last].area = clip;
+        gui_shadow.dirty_next       = (last + 1) % HASP_SCREENSHOT_DIRTY_AREAS;
+    }
+    gui_shadow.dirty[last].version = ++gui_shadow.version;
+}
+/**
+ * Collect the areas flushed after a shadow version, overlapping areas are merged
+ * @param since version the caller already has, 0 for the whole screen
+ * @param areas receives up to HASP_SCREENSHOT_DIRTY_AREAS areas
+ * @return number of areas, 0 if nothing changed or there is no shadow buffer
+ */
+uint8_t gui_shadow_changes(uint32_t since, lv_area_t* areas)
+{
+    uint8_t count = 0;
+    if(!gui_shadow.pixels) return 0;
+
+    if(since == 0 || since > gui_shadow.version || since < gui_shadow.lost_version) {
+        areas[count++] = {0, 0, (lv_coord_t)(gui_shadow.width - 1), (lv_coord_t)(gui_shadow.height - 1)};
+        return count; // unknown or too old ETag, send the whole screen
+    }
+
+    for(uint8_t i = 0; i < HASP_SCREENSHOT_DIRTY_AREAS; i++) {
+        if(gui_shadow.dirty[i].version <= since) continue;
+
+        lv_area_t area = gui_shadow.dirty[i].area;
+        uint8_t j;
+        for(j = 0; j < count; j++) {
+            if(_lv_area_is_on(&areas[j], &area)) {
+                _lv_area_join(&areas[j], &areas[j], &area);
+                break;
+            }
+        }
+        if(j == count) areas[count++] = area;
+    }
+    return count;
+}
+
+/**
+ * Get the shadow buffer, its pixels are stored in rows of width pixels
+ * @param version receives the version of the current contents
+ * @return the pixels or NULL if there is no shadow buffer
+ */
+const lv_color_t* gui_shadow_get_pixels(lv_coord_t& width, lv_coord_t& height, uint32_t& version)
+{
+    width   = gui_shadow.width;
+    height  = gui_shadow.height;
+    version = gui_shadow.version;
+    return gui_shadow.pixels;
+}
+#endif // HASP_USE_SCREENSHOT_SHADOW
+
 IRAM_ATTR void gui_flush_cb(lv_disp_drv_t* disp, const lv_area_t* area, lv_color_t* color_p)
 {
-    haspTft.flush_pixels(disp, area, color_p);
+    uint32_t start = millis();
+#if HASP_USE_SCREENSHOT_SHADOW > 0
+    gui_shadow_update(disp, area, color_p);
+#endif
+#if HASP_GUI_FLUSH_THREAD
+    if(guiVdbBuffer2)
+        gui_flush_thread_post(disp, area, color_p);
+    else
+        haspTft.flush_pixels(disp, area, color_p);
+#else
+    haspTft.flush_pixels(disp, area, color_p); // async drivers complete in gui_flush_wait_cb
+#endif
+    gui_stats.flush_wait += millis() - start;
     screenshotIsDirty = true;
 }
 
@@ -129,11 +423,27 @@ void gui_antiburn_cb(lv_disp_drv_t* disp, const lv_area_t* area, lv_color_t* col
 
 IRAM_ATTR void gui_monitor_cb(lv_disp_drv_t* disp_drv, uint32_t time, uint32_t px)
 {
+    gui_stats.frames++;
+    gui_stats.frame_time += time;
+
     // if(screenshotIsDirty) return;
     LOG_DEBUG(TAG_GUI, F("The Screen is dirty"));
     screenshotIsDirty = true;
 }
 
+/**
+ * Get the average refresh statistics since the previous call
+ * @param frame_time average duration of a screen refresh in ms
+ * @param flush_wait average time per refresh lvgl was waiting on the display driver in ms
+ */
+void gui_get_stats(uint32_t& frame_time, uint32_t& flush_wait)
+{
+    uint32_t frames = gui_stats.frames ? gui_stats.frames : 1;
+    frame_time      = gui_stats.frame_time / frames;
+    flush_wait      = gui_stats.flush_wait / frames;
+    memset(&gui_stats, 0, sizeof(gui_stats));
+}
+
 IRAM_ATTR bool gui_touch_read(lv_indev_drv_t* indev_driver, lv_indev_data_t* data)
 {
     return haspTouch.read(indev_driver, data);
@@ -290,7 +600,13 @@ void guiSetup()
     lv_disp_t* display       = lv_disp_drv_register(&disp_drv);
     lv_disp_set_rotation(display, rotation[(4 + gui_settings.rotation - TFT_ROTATION) % 4]);
 #endif
-    disp_drv.monitor_cb = gui_monitor_cb;
+    display->driver.monitor_cb = gui_monitor_cb; // the driver was copied by lv_disp_drv_register()
+#if HASP_USE_SCREENSHOT_SHADOW > 0
+    gui_shadow_init(display);
+#endif
+#if defined(HASP_TFT_ASYNC_FLUSH) || HASP_GUI_FLUSH_THREAD
+    display->driver.wait_cb = gui_flush_wait_cb;
+#endif
 
     // register a touchscreen/mouse driver - only on real hardware and SDL2
     // Win32 and POSIX handles input drivers in tft_driver
@@ -314,6 +630,15 @@ void guiSetup()
     }
 #endif
 
+#if HASP_USE_VNC > 0
+    /* Pointer of the VNC viewers, next to the local touch or mouse */
+    static lv_indev_drv_t vnc_indev_drv;
+    lv_indev_drv_init(&vnc_indev_drv);
+    vnc_indev_drv.type    = LV_INDEV_TYPE_POINTER;
+    vnc_indev_drv.read_cb = vnc_pointer_read;
+    lv_indev_drv_register(&vnc_indev_drv);
+#endif
+
     /*Set a cursor for the mouse*/
     LOG_TRACE(TAG_GUI, F("Initialize Cursor"));
     lv_obj_t* mouse_layer = lv_disp_get_layer_sys(NULL); // default display
@@ -367,19 +692,26 @@ void guiSetup()
     lv_obj_set_style_local_bg_color(lv_layer_sys(), LV_OBJ_PART_MAIN, LV_STATE_DEFAULT, LV_COLOR_BLACK);
     lv_obj_set_style_local_bg_opa(lv_layer_sys(), LV_OBJ_PART_MAIN, LV_STATE_DEFAULT, LV_OPA_0);
 
-#if defined(ESP32) && defined(HASP_USE_ESP_MQTT)
+#if HASP_USE_GUI_LOCK > 0
     xGuiSemaphore = xSemaphoreCreateMutex();
     if(!xGuiSemaphore) {
         LOG_FATAL(TAG_GUI, "Create mutex for LVGL failed");
     }
-#endif // ESP32 && HASP_USE_ESP_MQTT
+#endif // HASP_USE_GUI_LOCK
 
     LOG_INFO(TAG_LVGL, F(D_SERVICE_STARTED));
 }
 
+static uint32_t gui_next_run; // millis() when lvgl has a task to run again
+
 IRAM_ATTR void guiLoop(void)
 {
-    lv_task_handler(); // process animations
+#if HASP_USE_DISPATCH_QUEUE > 0
+    dispatch_queue_drain(); // commands posted by other threads
+#endif
+    uint32_t idle = lv_task_handler(); // process animations
+    gui_flush_complete();
+    gui_next_run = millis() + (idle < 1000 ? idle : 1000);
 
 #if defined(STM32F4xx)
     //  tick.update();
@@ -395,6 +727,50 @@ void guiEverySecond(void)
     // nothing
 }
 
+/* Time in ms until guiLoop() needs to run again */
+uint32_t gui_idle_time(void)
+{
+    int32_t idle = gui_next_run - millis();
+    return idle > 0 ? idle : 0;
+}
+
+#if HASP_USE_LVGL_TASK == 1 && defined(HASP_USE_EVENT_LOOP)
+#include <unistd.h>
+
+/* Wakes the lvgl task when one of the input devices has events */
+static PosixEvents gui_events;
+
+static void gui_input_ready(int fd, void* arg)
+{
+    char buffer[256];
+    while(read(fd, buffer, sizeof(buffer)) > 0) {
+        // drain the events, lvgl reads the device through its own file descriptor
+    }
+
+    /* Read the input devices now instead of at the next read period */
+    lv_indev_t* indev = NULL;
+    while((indev = lv_indev_get_next(indev))) {
+        if(indev->driver.read_task) lv_task_ready(indev->driver.read_task);
+    }
+}
+
+/* Watch a non-blocking file descriptor of an input device */
+void gui_watch_input(int fd)
+{
+    gui_events.add(fd, gui_input_ready, NULL);
+}
+#endif
+
+/* Let the thread running lvgl do its work now instead of after its idle time */
+void gui_wake(void)
+{
+#if HASP_USE_LVGL_TASK == 1 && defined(HASP_USE_EVENT_LOOP)
+    gui_events.wake();
+#elif defined(HASP_USE_EVENT_LOOP)
+    haspEvents.wake();
+#endif
+}
+
 #if HASP_USE_LVGL_TASK == 1
 void gui_task(void* args)
 {
@@ -405,14 +781,32 @@ void gui_task(void* args)
         /* Try to take the semaphore, call lvgl related function on success */
         if(pdTRUE == xSemaphoreTake(xGuiSemaphore, portMAX_DELAY)) {
             lv_task_handler();
+            gui_flush_complete();
             xSemaphoreGive(xGuiSemaphore);
             vTaskDelay(pdMS_TO_TICKS(5));
         }
 #else
         // optimize lv_task_handler() by actually using the returned delay value
-        auto time_start     = millis();
+        auto time_start = millis();
+#if HASP_USE_GUI_LOCK > 0
+        xSemaphoreTake(xGuiSemaphore, portMAX_DELAY); // the main loop touches lvgl objects too
+#endif
+#if HASP_USE_DISPATCH_QUEUE > 0
+        dispatch_queue_drain(); // commands posted by other threads
+#endif
         uint32_t sleep_time = lv_task_handler();
+        gui_flush_complete();
+#if HASP_USE_VNC > 0
+        vncLoop(); // reads the shadow buffer, so not on the main thread
+#endif
+#if HASP_USE_GUI_LOCK > 0
+        xSemaphoreGive(xGuiSemaphore);
+#endif
+#if defined(HASP_USE_EVENT_LOOP)
+        gui_events.wait(sleep_time); // returns early on input
+#else
         delay(sleep_time);
+#endif
         auto time_end = millis();
         lv_tick_inc(time_end - time_start);
 #endif
@@ -420,7 +814,7 @@ void gui_task(void* args)
 }
 #endif // HASP_USE_LVGL_TASK
 
-#if defined(ESP32) && defined(HASP_USE_ESP_MQTT)
+#if HASP_USE_GUI_LOCK > 0
 
 #if HASP_USE_LVGL_TASK == 1
 esp_err_t gui_setup_lvgl_task()
@@ -458,7 +852,7 @@ IRAM_ATTR void gui_release(void)
 #endif
 }
 
-#endif // ESP32 && HASP_USE_ESP_MQTT
+#endif // HASP_USE_GUI_LOCK
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 #if HASP_USE_CONFIG > 0
@@ -494,6 +888,12 @@ bool guiGetConfig(const JsonObject& settings)
     if(gui_settings.invert_display != settings[FPSTR(FP_GUI_INVERT)].as<bool>()) changed = true;
     settings[FPSTR(FP_GUI_INVERT)] = (uint8_t)gui_settings.invert_display;
 
+    if(gui_settings.vdb_size != settings[FPSTR(FP_GUI_VDB_SIZE)].as<uint32_t>()) changed = true;
+    settings[FPSTR(FP_GUI_VDB_SIZE)] = gui_settings.vdb_size;
+
+    if(gui_settings.vdb_double != settings[FPSTR(FP_GUI_VDB_DOUBLE)].as<bool>()) changed = true;
+    settings[FPSTR(FP_GUI_VDB_DOUBLE)] = (uint8_t)gui_settings.vdb_double;
+
     /* Check CalData array has changed */
     JsonArray array = settings[FPSTR(FP_GUI_CALIBRATION)].as<JsonArray>();
     uint8_t i       = 0;
@@ -567,6 +967,19 @@ bool guiSetConfig(const JsonObject& settings)
     hasp_set_sleep_time(guiSleepTime1, guiSleepTime2);
     haspDevice.set_backlight_invert(backlight_invert); // Update if changed
 
+    /* The draw buffers are allocated in guiSetup(), reallocate them once lvgl is running */
+    int32_t vdb_size = gui_settings.vdb_size;
+    bool vdb_changed = configSet(vdb_size, settings[FPSTR(FP_GUI_VDB_SIZE)], F("guiVdbSize"));
+    vdb_changed |= configSet(gui_settings.vdb_double, settings[FPSTR(FP_GUI_VDB_DOUBLE)], F("guiVdbDouble"));
+    if(vdb_changed) {
+        gui_settings.vdb_size = vdb_size > 0 ? vdb_size : LV_VDB_SIZE;
+        if(guiVdbBuffer1) {
+            gui_vdb_changed = true; // applied by the thread running lvgl, between two refreshes
+            gui_wake();
+        }
+        changed = true;
+    }
+
     if(!settings[FPSTR(FP_GUI_POINTER)].isNull()) {
         if(gui_settings.show_pointer != settings[FPSTR(FP_GUI_POINTER)].as<bool>()) {
             LOG_VERBOSE(TAG_GUI, F("guiShowPointer set"));
@@ -702,14 +1115,22 @@ void guiTakeScreenshot(const char* pFileName)
         if(len == sizeof(buffer)) {
             LOG_VERBOSE(TAG_GUI, F("Bitmap header written"));
 
-            /* Refresh screen to screenshot callback */
-            lv_disp_t* disp       = lv_disp_get_default();
-            drv_display_flush_cb  = disp->driver.flush_cb; /* store callback */
-            disp->driver.flush_cb = gui_screenshot_to_file;
-
-            lv_obj_invalidate(lv_scr_act());
-            lv_refr_now(NULL);                            /* Will call our disp_drv.disp_flush function */
-            disp->driver.flush_cb = drv_display_flush_cb; /* restore callback */
+#if HASP_USE_SCREENSHOT_SHADOW > 0
+            if(gui_shadow.pixels) {
+                size_t size = (size_t)gui_shadow.width * gui_shadow.height * sizeof(lv_color_t);
+                if(pFileOut.write((uint8_t*)gui_shadow.pixels, size) != size) gui_flush_not_complete();
+            } else
+#endif
+            {
+                /* Refresh screen to screenshot callback */
+                lv_disp_t* disp       = lv_disp_get_default();
+                drv_display_flush_cb  = disp->driver.flush_cb; /* store callback */
+                disp->driver.flush_cb = gui_screenshot_to_file;
+
+                lv_obj_invalidate(lv_scr_act());
+                lv_refr_now(NULL);                            /* Will call our disp_drv.disp_flush function */
+                disp->driver.flush_cb = drv_display_flush_cb; /* restore callback */
+            }
 
             LOG_VERBOSE(TAG_GUI, F("Bitmap data flushed to %s"), pFileName);
 
@@ -759,6 +1180,16 @@ void guiTakeScreenshot()
     if(httpClientWrite(buffer, sizeof(buffer)) == sizeof(buffer)) {
         LOG_VERBOSE(TAG_GUI, F("Bitmap header sent"));
 
+#if HASP_USE_SCREENSHOT_SHADOW > 0
+        if(gui_shadow.pixels) {
+            size_t len = (size_t)gui_shadow.width * gui_shadow.height * sizeof(lv_color_t);
+            if(httpClientWrite((uint8_t*)gui_shadow.pixels, len) != len) gui_flush_not_complete();
+            screenshotIsDirty = false;
+            LOG_VERBOSE(TAG_GUI, F("Bitmap data sent from the shadow buffer"));
+            return;
+        }
+#endif
+
         lv_disp_t* disp      = lv_disp_get_default();
         drv_display_flush_cb = disp->driver.flush_cb; /* store callback */
 
@@ -794,8 +1225,122 @@ bool guiScreenshotIsDirty()
 
 uint32_t guiScreenshotEtag()
 {
+#if HASP_USE_SCREENSHOT_SHADOW > 0
+    if(gui_shadow.pixels) return gui_shadow.version;
+#endif
+
     screenshotEtag += screenshotIsDirty;
     LOG_DEBUG(TAG_GUI, F("The ETag is %u"), screenshotEtag);
     return screenshotEtag;
 }
+
+#if HASP_USE_SCREENSHOT_SHADOW > 0
+/* Buffered writer for screenshot data, without a write function it only counts the bytes */
+struct gui_stream_t
+{
+    size_t (*write)(const uint8_t* buf, size_t size);
+    size_t len;
+    size_t used;
+    uint8_t buffer[512];
+};
+
+static void gui_stream_flush(gui_stream_t& stream)
+{
+    if(stream.write && stream.used && stream.write(stream.buffer, stream.used) != stream.used) gui_flush_not_complete();
+    stream.used = 0;
+}
+
+static void gui_stream_put(gui_stream_t& stream, const void* data, size_t size)
+{
+    stream.len += size;
+    if(!stream.write) return;
+
+    if(stream.used + size > sizeof(stream.buffer)) gui_stream_flush(stream);
+    memcpy(stream.buffer + stream.used, data, size);
+    stream.used += size;
+}
+
+/* PackBits on pixels: a control byte n < 128 is followed by n + 1 literal pixels,
+ * n >= 128 by a single pixel that is repeated n - 126 times */
+static void gui_stream_rle(gui_stream_t& stream, const lv_area_t* area)
+{
+    lv_coord_t width = lv_area_get_width(area);
+    uint32_t count   = lv_area_get_size(area);
+    uint32_t i       = 0;
+
+    /* Pixels are read in rows from the shadow buffer */
+    auto pixel = [&](uint32_t n) -> const lv_color_t& {
+        return gui_shadow.pixels[(area->y1 + n / width) * gui_shadow.width + area->x1 + n % width];
+    };
+
+    while(i < count) {
+        uint32_t run = 1;
+        while(i + run < count && run < 129 && pixel(i + run).full == pixel(i).full) run++;
+
+        if(run > 1) {
+            uint8_t ctrl = run + 126;
+            gui_stream_put(stream, &ctrl, 1);
+            gui_stream_put(stream, &pixel(i), sizeof(lv_color_t));
+            i += run;
+            continue;
+        }
+
+        /* Literal pixels up to the next run of 3 equal pixels */
+        uint32_t literal = 1;
+        while(i + literal < count && literal < 128) {
+            uint32_t n = i + literal;
+            if(n + 2 < count && pixel(n).full == pixel(n + 1).full && pixel(n).full == pixel(n + 2).full) break;
+            literal++;
+        }
+        uint8_t ctrl = literal - 1;
+        gui_stream_put(stream, &ctrl, 1);
+        for(uint32_t n = i; n < i + literal; n++) gui_stream_put(stream, &pixel(n), sizeof(lv_color_t));
+        i += literal;
+    }
+}
+
+/**
+ * Send the parts of the screen that changed since an earlier ETag, RLE compressed
+ *
+ * Response, all numbers little endian:
+ *   "HSD1", uint32 ETag, uint16 width, uint16 height, uint16 area count
+ *   per area: uint16 x, y, w, h followed by w * h pixels in the PackBits format of gui_stream_rle()
+ *
+ * @param since ETag of the frame the client already has, 0 for the full screen
+ * @param send false to only calculate the size of the response
+ * @return size of the response in bytes, 0 if nothing changed or there is no shadow buffer
+ **/
+size_t guiScreenshotDelta(uint32_t since, bool send)
+{
+    if(!gui_shadow.pixels) return 0;
+
+    lv_area_t areas[HASP_SCREENSHOT_DIRTY_AREAS];
+    uint8_t count = gui_shadow_changes(since, areas);
+    if(count == 0) return 0;
+
+    gui_stream_t stream;
+    stream.write = send ? httpClientWrite : NULL;
+    stream.len   = 0;
+    stream.used  = 0;
+
+    uint16_t header[5] = {0, 0, (uint16_t)gui_shadow.width, (uint16_t)gui_shadow.height, count};
+    memcpy(header, &gui_shadow.version, sizeof(uint32_t));
+    gui_stream_put(stream, "HSD1", 4);
+    gui_stream_put(stream, header, sizeof(header));
+
+    for(uint8_t i = 0; i < count; i++) {
+        uint16_t rect[4] = {(uint16_t)areas[i].x1, (uint16_t)areas[i].y1, (uint16_t)lv_area_get_width(&areas[i]),
+                            (uint16_t)lv_area_get_height(&areas[i])};
+        gui_stream_put(stream, rect, sizeof(rect));
+        gui_stream_rle(stream, &areas[i]);
+    }
+    gui_stream_flush(stream);
+
+    if(send) {
+        screenshotIsDirty = false;
+        LOG_VERBOSE(TAG_GUI, F("Sent %u changed areas in %u bytes"), count, stream.len);
+    }
+    return stream.len;
+}
+#endif // HASP_USE_SCREENSHOT_SHADOW
 #endif
@@ -38,6 +38,8 @@ struct gui_conf_t
 #else
     uint16_t cal_data[8];
 #endif
+    uint32_t vdb_size; // bytes per draw buffer
+    bool vdb_double;
 };
 
 /* ===== Default Event Processors ===== */
@@ -45,6 +47,8 @@ void guiTftInit(void);
 void guiSetup(void);
 IRAM_ATTR void guiLoop(void);
 void guiEverySecond(void);
+uint32_t gui_idle_time(void);
+void gui_wake(void);
 void guiStart(void);
 void guiStop(void);
 void gui_hide_pointer(bool hidden);
@@ -55,6 +59,12 @@ void guiTakeScreenshot(const char* pFileName); // to file
 void guiTakeScreenshot(void);                  // webclient
 bool guiScreenshotIsDirty();
 uint32_t guiScreenshotEtag();
+size_t guiScreenshotDelta(uint32_t since, bool send); // webclient, changed areas only
+#if HASP_USE_SCREENSHOT_SHADOW > 0
+uint8_t gui_shadow_changes(uint32_t since, lv_area_t* areas);
+const lv_color_t* gui_shadow_get_pixels(lv_coord_t& width, lv_coord_t& height, uint32_t& version);
+#endif
+void gui_get_stats(uint32_t& frame_time, uint32_t& flush_wait);
 
 /* ===== Callbacks ===== */
 void gui_flush_cb(lv_disp_drv_t* disp, const lv_area_t* area, lv_color_t* color_p);
@@ -63,9 +73,16 @@ void gui_antiburn_cb(lv_disp_drv_t* disp, const lv_area_t* area, lv_color_t* col
 /* ===== Main LVGL Task ===== */
 #if HASP_USE_LVGL_TASK == 1
 void gui_task(void* args);
+#if defined(HASP_USE_EVENT_LOOP)
+void gui_watch_input(int fd);
+#endif
 #endif
 
 /* ===== Locks ===== */
+#if defined(ESP32) && (defined(HASP_USE_ESP_MQTT) || HASP_USE_LVGL_TASK == 1)
+#define HASP_USE_GUI_LOCK 1 // the main loop and the lvgl task take turns on xGuiSemaphore
+#endif
+
 #ifdef ESP32
 IRAM_ATTR bool gui_acquire(TickType_t timeout);
 IRAM_ATTR void gui_release(void);
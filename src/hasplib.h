@@ -32,6 +32,7 @@
 #include "hasp/hasp_object.h"
 #include "hasp/hasp_page.h"
 #include "hasp/hasp_parser.h"
+#include "hasp/hasp_json.h"
 #include "hasp/hasp_lvfs.h"
 
 #include "hasp/lv_theme_hasp.h"
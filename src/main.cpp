@@ -128,6 +128,10 @@ void setup()
     telnetSetup();
 #endif
 
+#if HASP_USE_VNC > 0
+    vncSetup();
+#endif
+
 #if HASP_USE_FTP > 0
     ftpSetup();
 #endif
@@ -164,7 +168,7 @@ void setup()
 
 IRAM_ATTR void loop()
 {
-#if defined(ESP32) && defined(HASP_USE_ESP_MQTT)
+#if HASP_USE_GUI_LOCK > 0
     if(!gui_acquire(portMAX_DELAY)) {
         // LOG_ERROR(TAG_MAIN, F("TAKE Mutex"));
         delay(5); // ms
@@ -195,6 +199,10 @@ IRAM_ATTR void loop()
     consoleLoop();
 #endif
 
+#if HASP_USE_VNC > 0 && HASP_USE_LVGL_TASK == 0
+    vncLoop();
+#endif
+
 #if defined(HASP_USE_CUSTOM)
     custom_loop();
 #endif
@@ -264,12 +272,14 @@ IRAM_ATTR void loop()
         }
     }
 
-#if defined(ESP32) && defined(HASP_USE_ESP_MQTT)
+#if HASP_USE_GUI_LOCK > 0
     gui_release();
 #endif
 
 // allow the cpu to switch to other tasks
-#if HASP_USE_LVGL_TASK == 0
+#if defined(HASP_USE_EVENT_LOOP)
+    // main_pc.cpp waits in haspEvents.wait() until loop_idle_time() expires
+#elif HASP_USE_LVGL_TASK == 0
 #ifdef ARDUINO_ARCH_ESP8266
     delay(2); // ms
 #else
@@ -279,3 +289,19 @@ IRAM_ATTR void loop()
     delay(2); // ms
 #endif
 }
+
+#if HASP_TARGET_PC
+/* Time in ms until loop() has work to do, unless it is woken up earlier */
+uint32_t loop_idle_time()
+{
+    uint32_t elapsed = millis() - mainLastLoopTime;
+    uint32_t idle    = elapsed < 1000 ? 1000 - elapsed : 0;
+
+#if HASP_USE_LVGL_TASK == 0
+    uint32_t gui_idle = gui_idle_time();
+    if(gui_idle < idle) idle = gui_idle;
+#endif
+
+    return idle;
+}
+#endif
@@ -34,6 +34,11 @@
 #include "display/monitor.h"
 #endif
 
+#if USE_HEADLESS
+#include "drv/tft/tft_driver.h"
+#include "dev/posix/hasp_bench.h"
+#endif
+
 #include "hasp_debug.h"
 
 // hasp_gui.cpp
@@ -43,6 +48,7 @@ extern uint16_t tft_height;
 // main.cpp
 extern void setup();
 extern void loop();
+extern uint32_t loop_idle_time();
 
 #if defined(WINDOWS)
 // https://gist.github.com/kingseva/a918ec66079a9475f19642ec31276a21
@@ -123,6 +129,11 @@ void usage(const char* progName, const char* version)
               << "                        (default: 'AppData\\hasp\\hasp')" << std::endl
 #elif defined(POSIX)
               << "                        (default: '~/.local/share/hasp/hasp')" << std::endl
+#endif
+#if USE_HEADLESS
+              << "    -b  | --bench       Benchmark loading and rendering a pages.jsonl file" << std::endl
+              << "    -t  | --trace       Commands, touches and waits to replay during the benchmark" << std::endl
+              << "    -o  | --output      File to write the benchmark results to (default: stdout)" << std::endl
 #endif
               << std::endl;
     fflush(stdout);
@@ -133,6 +144,11 @@ int main(int argc, char* argv[])
     bool showhelp         = false;
     bool console          = true;
     char config[PATH_MAX] = {'\0'};
+#if USE_HEADLESS
+    std::string bench_pages;
+    std::string bench_trace;
+    std::string bench_output;
+#endif
 
 #if defined(WINDOWS)
     InitializeConsoleOutput();
@@ -170,6 +186,26 @@ int main(int argc, char* argv[])
                 std::cout << "Missing height value" << std::endl;
                 showhelp = true;
             }
+#endif
+#if USE_HEADLESS
+        } else if(strncmp(argv[arg], "--bench", 7) == 0 || strncmp(argv[arg], "-b", 2) == 0 ||
+                  strncmp(argv[arg], "--trace", 7) == 0 || strncmp(argv[arg], "-t", 2) == 0 ||
+                  strncmp(argv[arg], "--output", 8) == 0 || strncmp(argv[arg], "-o", 2) == 0) {
+            if(arg + 1 < argc) {
+                // the paths are relative to the working directory, before changing to the config directory
+                std::string path = argv[arg + 1];
+                char cwd_path[PATH_MAX];
+                if(path[0] != '/' && cwd(cwd_path, sizeof(cwd_path))) path = std::string(cwd_path) + "/" + path;
+
+                char option = argv[arg][1] == '-' ? argv[arg][2] : argv[arg][1];
+                if(option == 'b') bench_pages = path;
+                if(option == 't') bench_trace = path;
+                if(option == 'o') bench_output = path;
+                arg++;
+            } else {
+                std::cout << "Missing benchmark file" << std::endl;
+                showhelp = true;
+            }
 #endif
         } else if(strncmp(argv[arg], "--config", 8) == 0 || strncmp(argv[arg], "-c", 2) == 0) {
             if(arg + 1 < argc) {
@@ -208,12 +244,27 @@ int main(int argc, char* argv[])
     }
     cd(config);
 
+#if USE_HEADLESS
+    if(!bench_pages.empty()) {
+        haspTft.virtual_tick = true; // every run renders the same frames
+        setup();
+        int result = benchRun(bench_pages.c_str(), bench_trace.empty() ? NULL : bench_trace.c_str(),
+                              bench_output.empty() ? NULL : bench_output.c_str());
+        debugStop();
+        return result;
+    }
+#endif
+
     setup();
     while(haspDevice.pc_is_running) {
         loop();
+#if defined(HASP_USE_EVENT_LOOP)
+        haspEvents.wait(loop_idle_time()); // sleep until a timer, input or another thread needs the loop
+#endif
     }
 
 end:
+    debugStop(); // write the queued log lines
 #if defined(WINDOWS)
     std::cout << std::endl << std::flush;
     fflush(stdout);
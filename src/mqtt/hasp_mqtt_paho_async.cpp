@@ -74,7 +74,6 @@ uint32_t mqttPublishCount;
 uint32_t mqttReceiveCount;
 uint32_t mqttFailedCount;
 
-std::recursive_mutex dispatch_mtx;
 std::recursive_mutex publish_mtx;
 
 std::string mqttServer    = MQTT_HOSTNAME;
@@ -161,9 +160,7 @@ static void mqtt_message_cb(char* topic, char* payload, size_t length)
 
         // Group topic
         topic += mqttGroupTopic.length(); // shorten topic
-        dispatch_mtx.lock();
-        dispatch_topic_payload(topic, (const char*)payload, length > 0, TAG_MQTT);
-        dispatch_mtx.unlock();
+        dispatch_queue_topic_payload(topic, (const char*)payload, TAG_MQTT);
         return;
 
 #ifdef HASP_USE_BROADCAST
@@ -172,18 +169,14 @@ static void mqtt_message_cb(char* topic, char* payload, size_t length)
 
         // /" MQTT_TOPIC_BROADCAST "/ topic
         topic += strlen(MQTT_PREFIX "/" MQTT_TOPIC_BROADCAST "/"); // shorten topic
-        dispatch_mtx.lock();
-        dispatch_topic_payload(topic, (const char*)payload, length > 0, TAG_MQTT);
-        dispatch_mtx.unlock();
+        dispatch_queue_topic_payload(topic, (const char*)payload, TAG_MQTT);
         return;
 #endif
 
 #ifdef HASP_USE_HA
     } else if(topic == strstr_P(topic, PSTR("homeassistant/status"))) { // HA discovery topic
         if(mqttHAautodiscover && !strcasecmp_P((char*)payload, PSTR("online"))) {
-            dispatch_mtx.lock();
-            dispatch_current_state(TAG_MQTT);
-            dispatch_mtx.unlock();
+            dispatch_queue_current_state(TAG_MQTT);
             mqtt_ha_register_auto_discovery();
         }
         return;
@@ -208,9 +201,7 @@ static void mqtt_message_cb(char* topic, char* payload, size_t length)
             // LOG_TRACE(TAG_MQTT, F("ignoring LWT = online"));
         }
     } else {
-        dispatch_mtx.lock();
-        dispatch_topic_payload(topic, (const char*)payload, length > 0, TAG_MQTT);
-        dispatch_mtx.unlock();
+        dispatch_queue_topic_payload(topic, (const char*)payload, TAG_MQTT);
     }
 }
 
@@ -263,16 +254,13 @@ int mqttPublish(const char* topic, const char* payload, size_t len, bool retain)
     pubmsg.qos        = QOS;
     pubmsg.retained   = 0;
 
-    dispatch_mtx.lock();
     int rc = MQTTAsync_sendMessage(mqtt_client, topic, &pubmsg, &opts);
 
     if(rc != MQTTASYNC_SUCCESS) {
-        dispatch_mtx.unlock();
         mqttFailedCount++;
         LOG_ERROR(TAG_MQTT_PUB, F(D_MQTT_FAILED " '%s' => %s"), topic, payload);
         return MQTT_ERR_PUB_FAIL;
     } else {
-        dispatch_mtx.unlock();
         mqttPublishCount++;
         // LOG_TRACE(TAG_MQTT_PUB, F("'%s' => %s OK"), topic, payload);
         return MQTT_ERR_OK;
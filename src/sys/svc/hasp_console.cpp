@@ -15,6 +15,10 @@
 
 #include "../../hasp/hasp_dispatch.h"
 
+#if HASP_TARGET_PC && defined(HASP_USE_EVENT_LOOP)
+#include <unistd.h>
+#endif
+
 #if HASP_USE_HTTP > 0 || HASP_USE_HTTP_ASYNC > 0
 extern hasp_http_config_t http_config;
 #endif
@@ -106,6 +110,41 @@ static void console_process_line(const char* input)
             }
     }
 }
+#endif
+
+#if HASP_TARGET_PC
+/* Console input is read outside of the thread running lvgl */
+static inline void console_dispatch(const char* line)
+{
+#if HASP_USE_DISPATCH_QUEUE > 0
+    dispatch_queue_text_line(line, TAG_CONS);
+#else
+    dispatch_text_line(line, TAG_CONS);
+#endif
+}
+#endif
+
+#if HASP_TARGET_PC && defined(HASP_USE_EVENT_LOOP)
+static std::string console_input;
+
+/* Called by the main loop when stdin is readable, dispatches every complete line */
+static void console_read_cb(int fd, void* arg)
+{
+    char buffer[256];
+    ssize_t len = read(fd, buffer, sizeof(buffer));
+    if(len <= 0) {
+        haspEvents.remove(fd); // end-of-file, i.e. stdin is not a terminal
+        return;
+    }
+
+    console_input.append(buffer, len);
+    size_t pos;
+    while((pos = console_input.find('\n')) != std::string::npos) {
+        console_input[pos] = '\0';
+        console_dispatch(console_input.c_str());
+        console_input.erase(0, pos + 1);
+    }
+}
 #elif HASP_TARGET_PC
 static bool console_running = true;
 static void console_thread(void* arg)
@@ -113,7 +152,7 @@ static void console_thread(void* arg)
     while(console_running) {
         std::string input;
         std::getline(std::cin, input);
-        dispatch_text_line(input.c_str(), TAG_CONS);
+        console_dispatch(input.c_str());
     }
 }
 #endif
@@ -143,6 +182,9 @@ void consoleStart()
         console_logoff();
         LOG_ERROR(TAG_CONS, F(D_SERVICE_START_FAILED));
     }
+#elif HASP_TARGET_PC && defined(HASP_USE_EVENT_LOOP)
+    LOG_TRACE(TAG_MSGR, F(D_SERVICE_STARTING));
+    haspEvents.add(STDIN_FILENO, console_read_cb, NULL);
 #elif HASP_TARGET_PC
     LOG_TRACE(TAG_MSGR, F(D_SERVICE_STARTING));
     haspDevice.run_thread(console_thread, NULL);
@@ -509,6 +509,26 @@ static void http_handle_screenshot()
             }
         }
 
+#if HASP_USE_SCREENSHOT_SHADOW > 0
+        // Send the areas that changed since the ETag the client already has
+        // With HASP_USE_GUI_LOCK the main loop holds the GUI lock, so both passes see the same shadow buffer
+        if(webServer.hasArg("delta")) {
+            uint32_t since = atol(webServer.arg("delta").c_str());
+            size_t len     = guiScreenshotDelta(since, false);
+            if(len == 0) {
+                webServer.send(304, "application/octet-stream", "");
+                return;
+            }
+            etag = (String)(modified);
+            http_send_etag(etag);
+            webServer.setContentLength(len);
+            webServer.send(200, "application/octet-stream", "");
+            guiScreenshotDelta(since, true);
+            webServer.client().stop();
+            return;
+        }
+#endif
+
         // Send actual bitmap
         if(webServer.hasArg("q")) {
             lv_disp_t* disp = lv_disp_get_default();
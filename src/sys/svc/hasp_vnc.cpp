@@ -0,0 +1,628 @@
+/* MIT License - Copyright (c) 2019-2024 Francis Van Roie
+   For full license information read the LICENSE file in the project folder */
+
+/* ===========================================================================
+
+  Remote framebuffer (RFB 3.3 - 3.8) server to mirror the screen to VNC viewers
+
+  - Updates are read from the screenshot shadow buffer, only the areas flushed
+    since the last update of a client are sent
+  - Rectangles are sent with the Hextile encoding, tiles of 16x16 pixels that are
+    solid or made of a few subrectangles, others are sent raw
+  - Pointer events of the viewers are fed to lvgl by vnc_pointer_read()
+  - Sockets never block: output that doesn't fit is kept and sent when the socket is
+    writable again, and no new updates are encoded for a viewer until it is sent.
+    The next update then contains all the areas that changed in the meantime
+  - Viewers are refused when there is no shadow buffer, i.e. with software rotation
+  - vncLoop() runs on the thread that runs lvgl, so the shadow buffer is never read
+    while it is being flushed. The sockets are polled there when lvgl has its own task
+
+=========================================================================== */
+
+#include "hasplib.h"
+
+#if HASP_USE_VNC > 0 && defined(POSIX)
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+#include "hasp_debug.h"
+#include "hasp_gui.h"
+#include "hasp_vnc.h"
+
+#define VNC_MAX_CLIENTS 4
+#define VNC_SEND_TIMEOUT 2000   // ms before a viewer that doesn't read is dropped
+#define VNC_MAX_INPUT_SIZE 4096 // longest message accepted from a viewer, ClientCutText is skipped
+#define VNC_TILE_SIZE 16
+
+#define VNC_ENCODING_RAW 0
+#define VNC_ENCODING_HEXTILE 5
+
+#define VNC_HEXTILE_RAW 1
+#define VNC_HEXTILE_BACKGROUND 2
+#define VNC_HEXTILE_ANY_SUBRECTS 8
+#define VNC_HEXTILE_SUBRECTS_COLOURED 16
+
+enum vnc_state_t : uint8_t {
+    VNC_STATE_VERSION,  // waiting for the protocol version of the viewer
+    VNC_STATE_SECURITY, // waiting for the selected security type
+    VNC_STATE_INIT,     // waiting for ClientInit
+    VNC_STATE_NORMAL,
+};
+
+struct vnc_pixel_format_t
+{
+    uint8_t bpp;
+    uint8_t depth;
+    uint8_t big_endian;
+    uint8_t true_colour;
+    uint16_t red_max;
+    uint16_t green_max;
+    uint16_t blue_max;
+    uint8_t red_shift;
+    uint8_t green_shift;
+    uint8_t blue_shift;
+};
+
+struct vnc_client_t
+{
+    int fd;
+    vnc_state_t state;
+    uint8_t minor;        // protocol version 3.minor
+    bool hextile;         // the viewer supports the Hextile encoding
+    bool update_pending;  // the viewer waits for a FramebufferUpdate
+    bool backlog;         // out holds data the socket didn't take yet
+    bool full_update;     // the viewer asked for an area regardless of changes
+    lv_area_t full_area;  // area of a non-incremental update request
+    uint32_t version;     // shadow buffer version the viewer has
+    uint32_t sent_time;   // millis() of the last progress while there is a backlog
+    size_t skip;          // bytes of ClientCutText that are still to be discarded
+    lv_coord_t width;     // framebuffer size announced in ServerInit
+    lv_coord_t height;
+    vnc_pixel_format_t pf;
+    std::vector<uint8_t> in;
+    std::vector<uint8_t> out;
+};
+
+static int vnc_listen_fd = -1;
+static bool vnc_use_events; // the sockets are watched by haspEvents instead of polled
+static std::vector<vnc_client_t*> vnc_clients;
+
+/* Pointer state of the last viewer that sent a PointerEvent, read by the lvgl indev */
+static std::atomic<uint32_t> vnc_pointer_xy(0);
+static std::atomic<bool> vnc_pointer_pressed(false);
+
+/* ===== Output ===== */
+
+static inline void vnc_put_u8(vnc_client_t* client, uint8_t value)
+{
+    client->out.push_back(value);
+}
+
+static inline void vnc_put_u16(vnc_client_t* client, uint16_t value)
+{
+    client->out.push_back(value >> 8);
+    client->out.push_back(value & 0xFF);
+}
+
+static inline void vnc_put_u32(vnc_client_t* client, uint32_t value)
+{
+    vnc_put_u16(client, value >> 16);
+    vnc_put_u16(client, value & 0xFFFF);
+}
+
+/* Convert a pixel to the pixel format requested by the viewer */
+static void vnc_put_pixel(vnc_client_t* client, lv_color_t color)
+{
+    const vnc_pixel_format_t& pf = client->pf;
+    lv_color32_t c32;
+    c32.full = lv_color_to32(color);
+
+    uint32_t value = ((c32.ch.red * pf.red_max + 127) / 255) << pf.red_shift |
+                     ((c32.ch.green * pf.green_max + 127) / 255) << pf.green_shift |
+                     ((c32.ch.blue * pf.blue_max + 127) / 255) << pf.blue_shift;
+
+    uint8_t bytes = pf.bpp / 8;
+    for(uint8_t i = 0; i < bytes; i++) {
+        uint8_t shift = pf.big_endian ? (bytes - 1 - i) * 8 : i * 8;
+        client->out.push_back(value >> shift);
+    }
+}
+
+/**
+ * Send as much of the output buffer as the socket takes, the rest stays in the buffer until it is writable again
+ * @return false if the connection failed or the viewer didn't read anything for VNC_SEND_TIMEOUT
+ */
+static bool vnc_flush(vnc_client_t* client)
+{
+    size_t sent = 0;
+    while(sent < client->out.size()) {
+        ssize_t len = send(client->fd, client->out.data() + sent, client->out.size() - sent, MSG_NOSIGNAL);
+        if(len > 0) {
+            sent += len;
+        } else if(len < 0 && errno == EINTR) {
+            continue;
+        } else if(len < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        } else {
+            return false;
+        }
+    }
+    client->out.erase(client->out.begin(), client->out.begin() + sent);
+
+    bool backlog = !client->out.empty();
+    if(sent > 0 || !client->backlog) {
+        client->sent_time = millis();
+    } else if(backlog && millis() - client->sent_time > VNC_SEND_TIMEOUT) {
+        LOG_WARNING(TAG_VNC, F("Viewer stopped reading"));
+        return false;
+    }
+
+    if(backlog != client->backlog) {
+        client->backlog = backlog;
+#if defined(HASP_USE_EVENT_LOOP) && HASP_USE_LVGL_TASK == 0
+        if(vnc_use_events) haspEvents.watch_write(client->fd, backlog);
+#endif
+    }
+    return true;
+}
+
+/* ===== Encodings ===== */
+
+static void vnc_encode_raw(vnc_client_t* client, const lv_color_t* pixels, lv_coord_t stride, const lv_area_t* area)
+{
+    for(lv_coord_t y = area->y1; y <= area->y2; y++) {
+        const lv_color_t* row = pixels + y * stride;
+        for(lv_coord_t x = area->x1; x <= area->x2; x++) vnc_put_pixel(client, row[x]);
+    }
+}
+
+/**
+ * Encode one tile as Hextile: solid tiles take 1 byte, tiles with a few colours are sent as subrectangles
+ * @param background the background of the previous tile, updated for the next tile
+ * @param bg_valid false at the start of a rectangle and after raw tiles
+ */
+static void vnc_encode_tile(vnc_client_t* client, const lv_color_t* pixels, lv_coord_t stride, const lv_area_t* tile,
+                            lv_color_t& background, bool& bg_valid)
+{
+    struct subrect_t
+    {
+        lv_color_t color;
+        uint8_t x, y, w, h;
+    };
+    subrect_t subrects[VNC_TILE_SIZE * VNC_TILE_SIZE];
+    uint16_t count = 0;
+
+    lv_coord_t w = lv_area_get_width(tile);
+    lv_coord_t h = lv_area_get_height(tile);
+    lv_color_t bg = pixels[tile->y1 * stride + tile->x1];
+
+    /* Horizontal runs of non-background pixels, merged with an identical run on the row above */
+    for(uint8_t y = 0; y < h; y++) {
+        const lv_color_t* row = pixels + (tile->y1 + y) * stride + tile->x1;
+        for(uint8_t x = 0; x < w;) {
+            lv_color_t color = row[x];
+            uint8_t len      = 1;
+            while(x + len < w && row[x + len].full == color.full) len++;
+
+            if(color.full != bg.full) {
+                uint16_t i;
+                for(i = 0; i < count; i++) {
+                    subrect_t& r = subrects[i];
+                    if(r.x == x && r.w == len && r.y + r.h == y && r.color.full == color.full) {
+                        r.h++;
+                        break;
+                    }
+                }
+                if(i == count) subrects[count++] = {color, x, y, len, 1};
+            }
+            x += len;
+        }
+    }
+
+    size_t bytes_pp = client->pf.bpp / 8;
+    bool new_bg     = !bg_valid || bg.full != background.full;
+    size_t raw_size = w * h * bytes_pp;
+    size_t enc_size = (new_bg ? bytes_pp : 0) + (count ? 1 + count * (bytes_pp + 2) : 0);
+
+    if(count > 255 || enc_size >= raw_size) {
+        vnc_put_u8(client, VNC_HEXTILE_RAW);
+        vnc_encode_raw(client, pixels, stride, tile);
+        bg_valid = false;
+        return;
+    }
+
+    uint8_t subencoding = new_bg ? VNC_HEXTILE_BACKGROUND : 0;
+    if(count) subencoding |= VNC_HEXTILE_ANY_SUBRECTS | VNC_HEXTILE_SUBRECTS_COLOURED;
+    vnc_put_u8(client, subencoding);
+    if(new_bg) vnc_put_pixel(client, bg);
+
+    if(count) {
+        vnc_put_u8(client, count);
+        for(uint16_t i = 0; i < count; i++) {
+            vnc_put_pixel(client, subrects[i].color);
+            vnc_put_u8(client, subrects[i].x << 4 | subrects[i].y);
+            vnc_put_u8(client, (subrects[i].w - 1) << 4 | (subrects[i].h - 1));
+        }
+    }
+
+    background = bg;
+    bg_valid   = true;
+}
+
+static void vnc_encode_hextile(vnc_client_t* client, const lv_color_t* pixels, lv_coord_t stride,
+                               const lv_area_t* area)
+{
+    lv_color_t background;
+    bool bg_valid = false;
+
+    for(lv_coord_t y = area->y1; y <= area->y2; y += VNC_TILE_SIZE) {
+        for(lv_coord_t x = area->x1; x <= area->x2; x += VNC_TILE_SIZE) {
+            lv_area_t tile = {x, y, LV_MATH_MIN((lv_coord_t)(x + VNC_TILE_SIZE - 1), area->x2),
+                              LV_MATH_MIN((lv_coord_t)(y + VNC_TILE_SIZE - 1), area->y2)};
+            vnc_encode_tile(client, pixels, stride, &tile, background, bg_valid);
+        }
+    }
+}
+
+/* Send the areas that changed since the last update of the viewer, if it asked for one */
+static bool vnc_send_update(vnc_client_t* client)
+{
+    lv_coord_t width, height;
+    uint32_t version;
+    const lv_color_t* pixels = gui_shadow_get_pixels(width, height, version);
+    if(!pixels || width != client->width || height != client->height) {
+        LOG_WARNING(TAG_VNC, F("The screen size changed"));
+        return false; // the viewer can't follow without the DesktopSize pseudo-encoding
+    }
+
+    lv_area_t areas[HASP_SCREENSHOT_DIRTY_AREAS];
+    uint8_t count;
+    if(client->full_update) {
+        lv_area_t screen = {0, 0, (lv_coord_t)(width - 1), (lv_coord_t)(height - 1)};
+        count            = _lv_area_intersect(&areas[0], &client->full_area, &screen) ? 1 : 0;
+    } else {
+        count = gui_shadow_changes(client->version, areas);
+        if(count == 0) return true; // nothing changed, the request stays pending
+    }
+
+    vnc_put_u8(client, 0); // FramebufferUpdate
+    vnc_put_u8(client, 0);
+    vnc_put_u16(client, count);
+    for(uint8_t i = 0; i < count; i++) {
+        vnc_put_u16(client, areas[i].x1);
+        vnc_put_u16(client, areas[i].y1);
+        vnc_put_u16(client, lv_area_get_width(&areas[i]));
+        vnc_put_u16(client, lv_area_get_height(&areas[i]));
+        if(client->hextile) {
+            vnc_put_u32(client, VNC_ENCODING_HEXTILE);
+            vnc_encode_hextile(client, pixels, width, &areas[i]);
+        } else {
+            vnc_put_u32(client, VNC_ENCODING_RAW);
+            vnc_encode_raw(client, pixels, width, &areas[i]);
+        }
+    }
+
+    client->version        = version;
+    client->update_pending = false;
+    client->full_update    = false;
+    return vnc_flush(client);
+}
+
+/* ===== Input ===== */
+
+static inline uint16_t vnc_get_u16(const uint8_t* data)
+{
+    return data[0] << 8 | data[1];
+}
+
+static inline uint32_t vnc_get_u32(const uint8_t* data)
+{
+    return (uint32_t)vnc_get_u16(data) << 16 | vnc_get_u16(data + 2);
+}
+
+static void vnc_send_server_init(vnc_client_t* client)
+{
+    const char* name = haspDevice.get_hostname();
+    uint32_t version;
+
+    gui_shadow_get_pixels(client->width, client->height, version);
+    vnc_put_u16(client, client->width);
+    vnc_put_u16(client, client->height);
+
+    /* Default pixel format is RGB565 little endian, viewers can request their own format */
+    client->pf = {16, 16, 0, 1, 31, 63, 31, 11, 5, 0};
+    vnc_put_u8(client, client->pf.bpp);
+    vnc_put_u8(client, client->pf.depth);
+    vnc_put_u8(client, client->pf.big_endian);
+    vnc_put_u8(client, client->pf.true_colour);
+    vnc_put_u16(client, client->pf.red_max);
+    vnc_put_u16(client, client->pf.green_max);
+    vnc_put_u16(client, client->pf.blue_max);
+    vnc_put_u8(client, client->pf.red_shift);
+    vnc_put_u8(client, client->pf.green_shift);
+    vnc_put_u8(client, client->pf.blue_shift);
+    vnc_put_u8(client, 0); // padding
+    vnc_put_u16(client, 0);
+
+    vnc_put_u32(client, strlen(name));
+    client->out.insert(client->out.end(), name, name + strlen(name));
+}
+
+/**
+ * Handle one message of the viewer
+ * @return number of bytes used, 0 if the message is incomplete or -1 to disconnect the viewer
+ */
+static int vnc_handle_message(vnc_client_t* client, const uint8_t* data, size_t len)
+{
+    switch(client->state) {
+        case VNC_STATE_VERSION: {
+            if(len < 12) return 0;
+            if(memcmp(data, "RFB 003.", 8)) return -1;
+            client->minor = atoi((const char*)data + 8) >= 8 ? 8 : (atoi((const char*)data + 8) >= 7 ? 7 : 3);
+
+            if(client->minor == 3) {
+                vnc_put_u32(client, 1); // security type None
+                client->state = VNC_STATE_INIT;
+            } else {
+                vnc_put_u8(client, 1); // one security type: None
+                vnc_put_u8(client, 1);
+                client->state = VNC_STATE_SECURITY;
+            }
+            return 12;
+        }
+
+        case VNC_STATE_SECURITY:
+            if(len < 1) return 0;
+            if(data[0] != 1) return -1;
+            if(client->minor == 8) vnc_put_u32(client, 0); // SecurityResult OK
+            client->state = VNC_STATE_INIT;
+            return 1;
+
+        case VNC_STATE_INIT:
+            if(len < 1) return 0;
+            vnc_send_server_init(client);
+            client->state = VNC_STATE_NORMAL;
+            LOG_INFO(TAG_VNC, F("Viewer connected, RFB 3.%u"), client->minor);
+            return 1;
+
+        case VNC_STATE_NORMAL:
+            break;
+    }
+
+    if(len < 1) return 0;
+    switch(data[0]) {
+        case 0: { // SetPixelFormat
+            if(len < 20) return 0;
+            const uint8_t* pf = data + 4;
+            if(!pf[3] || (pf[0] != 8 && pf[0] != 16 && pf[0] != 32)) {
+                LOG_WARNING(TAG_VNC, F("Unsupported pixel format, %u bpp"), pf[0]);
+                return -1; // colour maps are not supported
+            }
+            client->pf = {pf[0],
+                          pf[1],
+                          pf[2],
+                          pf[3],
+                          vnc_get_u16(pf + 4),
+                          vnc_get_u16(pf + 6),
+                          vnc_get_u16(pf + 8),
+                          pf[10],
+                          pf[11],
+                          pf[12]};
+            return 20;
+        }
+
+        case 2: { // SetEncodings
+            if(len < 4) return 0;
+            size_t size = 4 + 4 * vnc_get_u16(data + 2);
+            if(len < size) return 0;
+            client->hextile = false;
+            for(size_t i = 4; i < size; i += 4) {
+                if((int32_t)vnc_get_u32(data + i) == VNC_ENCODING_HEXTILE) client->hextile = true;
+            }
+            return size;
+        }
+
+        case 3: // FramebufferUpdateRequest
+            if(len < 10) return 0;
+            client->update_pending = true;
+            if(!data[1]) {
+                lv_coord_t x = vnc_get_u16(data + 2);
+                lv_coord_t y = vnc_get_u16(data + 4);
+                client->full_update = true;
+                client->full_area = {x, y, (lv_coord_t)(x + vnc_get_u16(data + 6) - 1),
+                                     (lv_coord_t)(y + vnc_get_u16(data + 8) - 1)};
+            }
+            return 10;
+
+        case 4: // KeyEvent
+            return len < 8 ? 0 : 8;
+
+        case 5: // PointerEvent
+            if(len < 6) return 0;
+            vnc_pointer_xy.store((uint32_t)vnc_get_u16(data + 2) << 16 | vnc_get_u16(data + 4));
+            vnc_pointer_pressed.store(data[1] & 0x01); // left button
+            return 6;
+
+        case 6: { // ClientCutText, the text is discarded as it arrives instead of buffered
+            if(len < 8) return 0;
+            size_t size  = vnc_get_u32(data + 4);
+            size_t avail = LV_MATH_MIN(len - 8, size);
+            client->skip = size - avail;
+            return 8 + avail;
+        }
+
+        default:
+            LOG_WARNING(TAG_VNC, F("Unknown message type %u"), data[0]);
+            return -1;
+    }
+}
+
+static void vnc_disconnect(vnc_client_t* client)
+{
+#if defined(HASP_USE_EVENT_LOOP) && HASP_USE_LVGL_TASK == 0
+    if(vnc_use_events) haspEvents.remove(client->fd);
+#endif
+    close(client->fd);
+    vnc_clients.erase(std::find(vnc_clients.begin(), vnc_clients.end(), client));
+    delete client;
+    LOG_INFO(TAG_VNC, F("Viewer disconnected"));
+}
+
+static void vnc_read_cb(int fd, void* arg)
+{
+    vnc_client_t* client = (vnc_client_t*)arg;
+    uint8_t buffer[1024];
+
+    ssize_t len = recv(fd, buffer, sizeof(buffer), 0);
+    if(len == 0 || (len < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+        vnc_disconnect(client);
+        return;
+    }
+
+    const uint8_t* data = buffer;
+    if(len > 0 && client->skip > 0) {
+        size_t skip = LV_MATH_MIN((size_t)len, client->skip);
+        client->skip -= skip;
+        data += skip;
+        len -= skip;
+    }
+    if(len > 0) client->in.insert(client->in.end(), data, data + len);
+
+    size_t pos = 0;
+    int used;
+    while((used = vnc_handle_message(client, client->in.data() + pos, client->in.size() - pos)) > 0) pos += used;
+    client->in.erase(client->in.begin(), client->in.begin() + pos);
+
+    if(used == 0 && client->in.size() > VNC_MAX_INPUT_SIZE) {
+        LOG_WARNING(TAG_VNC, F("Message of the viewer is too long"));
+        used = -1;
+    }
+    if(used < 0 || !vnc_flush(client)) vnc_disconnect(client);
+}
+
+static void vnc_accept_cb(int fd, void* arg)
+{
+    int client_fd = accept(fd, NULL, NULL);
+    if(client_fd < 0) return;
+
+    if(vnc_clients.size() >= VNC_MAX_CLIENTS) {
+        LOG_WARNING(TAG_VNC, F("Too many viewers"));
+        close(client_fd);
+        return;
+    }
+
+    lv_coord_t width, height;
+    uint32_t shadow_version;
+    if(!gui_shadow_get_pixels(width, height, shadow_version)) {
+        LOG_WARNING(TAG_VNC, F("No screenshot shadow buffer to mirror, viewer refused"));
+        close(client_fd);
+        return;
+    }
+
+    int one = 1;
+    setsockopt(client_fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    fcntl(client_fd, F_SETFL, fcntl(client_fd, F_GETFL) | O_NONBLOCK);
+
+    vnc_client_t* client = new vnc_client_t();
+    client->fd           = client_fd;
+    client->state        = VNC_STATE_VERSION;
+    vnc_clients.push_back(client);
+#if defined(HASP_USE_EVENT_LOOP) && HASP_USE_LVGL_TASK == 0
+    if(vnc_use_events) haspEvents.add(client_fd, vnc_read_cb, client);
+#endif
+
+    const char* version = "RFB 003.008\n";
+    client->out.insert(client->out.end(), version, version + 12);
+    if(!vnc_flush(client)) vnc_disconnect(client);
+}
+
+/* Called by lvgl to read the pointer of the viewers */
+bool vnc_pointer_read(lv_indev_drv_t* indev_driver, lv_indev_data_t* data)
+{
+    uint32_t xy   = vnc_pointer_xy.load();
+    data->point.x = xy >> 16;
+    data->point.y = xy & 0xFFFF;
+    data->state   = vnc_pointer_pressed.load() ? LV_INDEV_STATE_PR : LV_INDEV_STATE_REL;
+    return false;
+}
+
+/* ===== Default Event Processors ===== */
+
+IRAM_ATTR void vncLoop(void)
+{
+    if(vnc_listen_fd < 0) return;
+
+    /* Without an event loop the sockets are polled */
+    if(!vnc_use_events) {
+        vnc_accept_cb(vnc_listen_fd, NULL);
+        for(size_t i = vnc_clients.size(); i > 0; i--) vnc_read_cb(vnc_clients[i - 1]->fd, vnc_clients[i - 1]);
+    }
+
+    for(size_t i = vnc_clients.size(); i > 0; i--) {
+        vnc_client_t* client = vnc_clients[i - 1];
+        if(client->backlog) {
+            if(!vnc_flush(client)) vnc_disconnect(client); // also drops viewers that stopped reading
+            continue;                                      // skip updates until the backlog is sent
+        }
+        if(client->state == VNC_STATE_NORMAL && client->update_pending && !vnc_send_update(client)) {
+            vnc_disconnect(client);
+        }
+    }
+}
+
+void vncStart(void)
+{
+    if(vnc_listen_fd >= 0) return;
+
+    struct sockaddr_in addr = {};
+    addr.sin_family         = AF_INET;
+    addr.sin_port           = htons(HASP_VNC_PORT);
+    inet_pton(AF_INET, HASP_VNC_ADDRESS, &addr.sin_addr);
+
+    int one       = 1;
+    vnc_listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    setsockopt(vnc_listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    fcntl(vnc_listen_fd, F_SETFL, fcntl(vnc_listen_fd, F_GETFL) | O_NONBLOCK);
+
+    if(bind(vnc_listen_fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(vnc_listen_fd, 2) < 0) {
+        LOG_ERROR(TAG_VNC, F(D_SERVICE_START_FAILED ": %s"), strerror(errno));
+        close(vnc_listen_fd);
+        vnc_listen_fd = -1;
+        return;
+    }
+
+#if defined(HASP_USE_EVENT_LOOP) && HASP_USE_LVGL_TASK == 0
+    vnc_use_events = haspEvents.add(vnc_listen_fd, vnc_accept_cb, NULL);
+#endif
+    LOG_INFO(TAG_VNC, F(D_SERVICE_STARTED " on %s:%u"), HASP_VNC_ADDRESS, HASP_VNC_PORT);
+}
+
+void vncStop(void)
+{
+    while(!vnc_clients.empty()) vnc_disconnect(vnc_clients.back());
+
+    if(vnc_listen_fd >= 0) {
+#if defined(HASP_USE_EVENT_LOOP) && HASP_USE_LVGL_TASK == 0
+        if(vnc_use_events) haspEvents.remove(vnc_listen_fd);
+#endif
+        close(vnc_listen_fd);
+        vnc_listen_fd = -1;
+        LOG_INFO(TAG_VNC, F(D_SERVICE_STOPPED));
+    }
+}
+
+void vncSetup(void)
+{
+    vncStart();
+}
+
+#endif // HASP_USE_VNC
@@ -0,0 +1,21 @@
+/* MIT License - Copyright (c) 2019-2024 Francis Van Roie
+   For full license information read the LICENSE file in the project folder */
+
+#ifndef HASP_VNC_H
+#define HASP_VNC_H
+
+#if HASP_USE_VNC > 0 && defined(POSIX)
+
+#include "hasplib.h"
+
+/* ===== Default Event Processors ===== */
+void vncSetup(void);
+IRAM_ATTR void vncLoop(void);
+void vncStart(void);
+void vncStop(void);
+
+/* ===== Special Event Processors ===== */
+bool vnc_pointer_read(lv_indev_drv_t* indev_driver, lv_indev_data_t* data);
+
+#endif
+#endif
@@ -0,0 +1,94 @@
+#!/usr/bin/env python3
+# MIT License - Copyright (c) 2019-2024 Francis Van Roie
+# For full license information read the LICENSE file in the project folder
+#
+# Verifies that the sdbm hashes used as switch labels by the attribute and object
+# dispatchers are consistent and collision-free:
+#   - every ATTR_* / HASP_OBJ_* define must equal sdbm(name), otherwise it can never match
+#   - two different names must never share the same hash within one namespace
+# Either problem fails the build.
+#
+# Can be run standalone from the project root or as a PlatformIO pre: extra_script.
+
+import os
+import re
+import sys
+
+SOURCES = {
+    "attribute": ("src/hasp/hasp_attribute.h", "ATTR_"),
+    "object": ("src/hasp/hasp_object.h", "HASP_OBJ_"),
+}
+
+# Defines that are known to be unreachable, because get_sdbm skips their digits
+UNREACHABLE = {
+    "ATTR_START_ANGLE1",
+    "ATTR_END_ANGLE1",
+    "ATTR_TRANSITION_PROP_1",
+    "ATTR_TRANSITION_PROP_2",
+    "ATTR_TRANSITION_PROP_3",
+    "ATTR_TRANSITION_PROP_4",
+    "ATTR_TRANSITION_PROP_5",
+    "ATTR_TRANSITION_PROP_6",
+}
+
+DEFINE_RE = re.compile(r"^\s*#define\s+(\w+)\s+(\d+)\b")
+
+
+# Must match Parser::get_sdbm() in src/hasp/hasp_parser.cpp
+def sdbm(name):
+    h = 0
+    for c in name.lower():
+        if "0" <= c <= "9":
+            continue
+        h = (ord(c) + (h << 6) - h) & 0xFFFF
+    return h
+
+
+def parse_defines(path, prefix):
+    defines = []
+    with open(path) as f:
+        for lineno, line in enumerate(f, 1):
+            m = DEFINE_RE.match(line)
+            if m and m.group(1).startswith(prefix):
+                defines.append((m.group(1)[len(prefix):].lower(), int(m.group(2)), lineno))
+    return defines
+
+
+def check(root):
+    errors = 0
+    for namespace, (filename, prefix) in SOURCES.items():
+        path = os.path.join(root, filename)
+        if not os.path.isfile(path):
+            continue
+
+        names = {}
+        for name, value, lineno in parse_defines(path, prefix):
+            key = re.sub(r"\d", "", name)  # digits are ignored by get_sdbm
+            hash = sdbm(name)
+
+            if name.startswith("text_") and value == sdbm("%" + name[5:] + "%"):
+                hash = value  # label placeholders like %ip% are hashed with the percent signs
+
+            if hash != value and prefix + name.upper() not in UNREACHABLE:
+                print("{}:{}: error: {}{} = {} is unreachable, sdbm is {}".format(
+                    filename, lineno, prefix, name.upper(), value, hash))
+                errors += 1
+
+            other = names.get(hash)
+            if other is not None and other[0] != key:
+                print("{}:{}: error: {} '{}' collides with '{}' (line {}), hash {}".format(
+                    filename, lineno, namespace, name, other[0], other[1], hash))
+                errors += 1
+            names.setdefault(hash, (key, lineno))
+
+    return errors
+
+
+try:
+    Import("env")
+    if check(env.subst("$PROJECT_DIR")) > 0:
+        print("Attribute hash check failed")
+        env.Exit(1)
+except NameError:
+    if __name__ == "__main__":
+        sys.exit(1 if check(os.getcwd()) > 0 else 0)
@@ -0,0 +1,175 @@
+#!/usr/bin/env python3
+# MIT License - Copyright (c) 2019-2024 Francis Van Roie
+# For full license information read the LICENSE file in the project folder
+#
+# Compiles a pages.jsonl file into pages.bin, which openHASP loads at boot without
+# json parsing or hashing of the object types and attribute names.
+#
+# pages.bin layout, all integers are little endian:
+#
+#   header    char[4]  "HASP"
+#             uint8    version (1)
+#             uint8    reserved
+#             uint16   number of strings
+#             uint32   size of the string table in bytes
+#   strings   interned attribute names and values, each terminated by a '\0'
+#   objects   until the end of the file:
+#             uint8    flags: 0x01 page set, 0x02 parentid set, 0x04 obj set
+#             uint8    page
+#             uint8    parentid
+#             uint8    id
+#             uint16   sdbm hash of the obj type
+#             uint8    number of attributes
+#             per attribute: uint16 sdbm hash, uint16 name string index, uint16 value string index
+#
+# Attribute values are stored as the text the device would receive from pages.jsonl.
+# Geometry is stored first and hidden/vis last, the same order as a json batch update.
+#
+# Usage: hasp_pages_compile.py data/pages.jsonl [-o data/pages.bin]
+
+import argparse
+import json
+import os
+import struct
+import sys
+
+VERSION = 1
+FLAG_PAGE = 0x01
+FLAG_PARENTID = 0x02
+FLAG_OBJ = 0x04
+
+GEOMETRY = ("x", "y", "w", "h")
+VISIBILITY = ("hidden", "vis")
+
+
+# Must match Parser::get_sdbm() in src/hasp/hasp_parser.cpp
+def sdbm(name):
+    h = 0
+    for c in name.lower():
+        if "0" <= c <= "9":
+            continue
+        h = (ord(c) + (h << 6) - h) & 0xFFFF
+    return h
+
+
+# The text representation of a value, same as JsonVariant::as<std::string>()
+def value_to_text(value):
+    if isinstance(value, str):
+        return value
+    if isinstance(value, bool):
+        return "true" if value else "false"
+    if value is None:
+        return "null"
+    if isinstance(value, (int, float)):
+        return repr(value)
+    return json.dumps(value, separators=(",", ":"), ensure_ascii=False)
+
+
+# Same conversion as JsonVariant::as<uint8_t>()
+def value_to_uint8(value):
+    if isinstance(value, bool):
+        return int(value)
+    if isinstance(value, (int, float)) and 0 <= value <= 255:
+        return int(value)
+    return 0
+
+
+def sort_key(name):
+    if sdbm(name) in GEOMETRY_HASHES:
+        return 0
+    if sdbm(name) in VISIBILITY_HASHES:
+        return 2
+    return 1
+
+
+GEOMETRY_HASHES = [sdbm(n) for n in GEOMETRY]
+VISIBILITY_HASHES = [sdbm(n) for n in VISIBILITY]
+
+
+class Strings:
+    def __init__(self):
+        self.index = {}
+        self.table = bytearray()
+
+    def add(self, text):
+        if text not in self.index:
+            if len(self.index) >= 0xFFFF:
+                raise ValueError("too many unique strings")
+            self.index[text] = len(self.index)
+            self.table += text.encode("utf-8") + b"\0"
+        return self.index[text]
+
+
+def read_objects(filename):
+    with open(filename, encoding="utf-8") as f:
+        text = f.read()
+
+    decoder = json.JSONDecoder()
+    pos = 0
+    while True:
+        while pos < len(text) and text[pos].isspace():
+            pos += 1
+        if pos >= len(text):
+            return
+        try:
+            obj, end = decoder.raw_decode(text, pos)
+        except json.JSONDecodeError as e:
+            raise SystemExit("{}:{}: {}".format(filename, e.lineno, e.msg))
+        yield obj
+        pos = end
+
+
+def compile_pages(filename):
+    strings = Strings()
+    records = bytearray()
+    count = 0
+
+    for config in read_objects(filename):
+        if not isinstance(config, dict):
+            continue
+        config = dict(config)
+        if config.pop("skip", False) is True:
+            continue
+
+        flags = 0
+        page = parentid = typehash = 0
+        if "page" in config:
+            flags |= FLAG_PAGE
+            page = value_to_uint8(config.pop("page"))
+        if "parentid" in config:
+            flags |= FLAG_PARENTID
+            parentid = value_to_uint8(config.pop("parentid"))
+        id = value_to_uint8(config.pop("id", 0))
+        if "obj" in config:
+            flags |= FLAG_OBJ
+            typehash = sdbm(value_to_text(config.pop("obj")))
+
+        attributes = sorted(config.items(), key=lambda item: sort_key(item[0]))
+        if len(attributes) > 255:
+            raise SystemExit("{}: object p{}b{} has too many attributes".format(filename, page, id))
+
+        records += struct.pack("<BBBBHB", flags, page, parentid, id, typehash, len(attributes))
+        for name, value in attributes:
+            records += struct.pack("<HHH", sdbm(name), strings.add(name), strings.add(value_to_text(value)))
+        count += 1
+
+    header = b"HASP" + struct.pack("<BBHI", VERSION, 0, len(strings.index), len(strings.table))
+    return header + bytes(strings.table) + bytes(records), count, len(strings.index)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compile an openHASP pages.jsonl file into pages.bin")
+    parser.add_argument("jsonl", help="the pages.jsonl file")
+    parser.add_argument("-o", "--output", help="the pages.bin file, defaults to the jsonl name with a .bin extension")
+    args = parser.parse_args()
+
+    output = args.output or os.path.splitext(args.jsonl)[0] + ".bin"
+    data, objects, strings = compile_pages(args.jsonl)
+    with open(output, "wb") as f:
+        f.write(data)
+
+    print("{}: {} objects, {} strings, {} bytes".format(output, objects, strings, len(data)))
+
+
+if __name__ == "__main__":
+    main()